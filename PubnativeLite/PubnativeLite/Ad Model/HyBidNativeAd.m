@@ -24,9 +24,10 @@
 #import "PNLiteAsset.h"
 #import "HyBidDataModel.h"
 #import "PNLiteTrackingManager.h"
+#import "PNLiteBeaconDeduplicator.h"
 #import "PNLiteImpressionTracker.h"
+#import "PNLiteJSBeaconEngine.h"
 #import "HyBidLogger.h"
-#import <WebKit/WebKit.h>
 
 NSString * const PNLiteNativeAdBeaconImpression = @"impression";
 NSString * const PNLiteNativeAdBeaconClick = @"click";
@@ -204,7 +205,7 @@ NSString * const PNLiteNativeAdBeaconClick = @"click";
             self.impressionTracker = [[PNLiteImpressionTracker alloc] init];
             self.impressionTracker.delegate = self;
         }
-        [self.impressionTracker addView:view];
+        [self.impressionTracker addViewWithRuleForAdSize:view];
     }
 }
 
@@ -261,26 +262,20 @@ NSString * const PNLiteNativeAdBeaconClick = @"click";
         for (HyBidDataModel *beacon in self.ad.beacons) {
             if ([beacon.type isEqualToString:type]) {
                 NSString *beaconJs = [beacon stringFieldWithKey:@"js"];
+                NSString *beaconKey = beacon.url.length > 0 ? beacon.url : beaconJs;
+                if (![[PNLiteBeaconDeduplicator sharedInstance] registerBeaconWithURL:beaconKey forAdIdentifier:self.ad.impressionID]) {
+                    continue;
+                }
                 if (beacon.url && beacon.url.length > 0) {
                     NSURL *beaconUrl = [NSURL URLWithString:beacon.url];
                     NSURL *injectedUrl = [self injectExtrasWithUrl:beaconUrl];
                     [PNLiteTrackingManager trackWithURL:injectedUrl];
                 } else if (beaconJs && beaconJs.length > 0) {
-                    __block NSString *beaconJsBlock = [beacon stringFieldWithKey:@"js"];
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        NSString *jScript = @"var meta = document.createElement('meta'); meta.setAttribute('name', 'viewport'); meta.setAttribute('content', 'width=device-width'); document.getElementsByTagName('head')[0].appendChild(meta);";
-                        WKUserScript *wkUScript = [[WKUserScript alloc] initWithSource:jScript injectionTime:WKUserScriptInjectionTimeAtDocumentEnd forMainFrameOnly:YES];
-                        WKUserContentController *wkUController = [[WKUserContentController alloc] init];
-                        [wkUController addUserScript:wkUScript];
-                        WKWebViewConfiguration *wkWebConfig = [[WKWebViewConfiguration alloc] init];
-                        wkWebConfig.userContentController = wkUController;
-
-                        WKWebView *webView = [[WKWebView alloc] initWithFrame:CGRectZero configuration:wkWebConfig];
-                        webView.autoresizingMask = (UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight);
-//                        [webView evaluateJavaScript:beaconJsBlock completionHandler:nil];
-                        [webView evaluateJavaScript:beaconJsBlock completionHandler:^(id result, NSError *error) {}];
-
-                    });
+                    [[PNLiteJSBeaconEngine sharedInstance] evaluateBeaconScript:beaconJs completion:^(NSError *error) {
+                        if (!error) {
+                            [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"JS beacon for type %@ evaluated.", type]];
+                        }
+                    }];
                 }
             }
         }
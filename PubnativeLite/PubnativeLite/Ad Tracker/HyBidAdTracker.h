@@ -26,10 +26,20 @@
 extern NSString *const PNLiteAdTrackerClick;
 extern NSString *const PNLiteAdTrackerImpression;
 
+typedef void (^HyBidAdTrackerCompletionBlock)(NSString *trackType, NSArray<NSString *> *failedURLs, NSTimeInterval duration);
+
 @interface HyBidAdTracker : NSObject
 
+/**
+ Called once every URL of a track type has completed, with the URLs that failed and the time it took.
+ */
+@property (nonatomic, copy) HyBidAdTrackerCompletionBlock completion;
+
 - (instancetype)initWithImpressionURLs:(NSArray *)impressionURLs
                          withClickURLs:(NSArray *)clickURLs;
+- (instancetype)initWithImpressionURLs:(NSArray *)impressionURLs
+                         withClickURLs:(NSArray *)clickURLs
+                      withAdIdentifier:(NSString *)adIdentifier;
 - (void)trackClick;
 - (void)trackImpression;
 
@@ -22,6 +22,7 @@
 
 #import "HyBidAdTracker.h"
 #import "HyBidDataModel.h"
+#import "PNLiteBeaconDeduplicator.h"
 #import "HyBidLogger.h"
 
 NSString *const PNLiteAdTrackerClick = @"click";
@@ -29,9 +30,12 @@ NSString *const PNLiteAdTrackerImpression = @"impression";
 
 @interface HyBidAdTracker() <HyBidAdTrackerRequestDelegate>
 
-@property (nonatomic, strong) HyBidAdTrackerRequest *adTrackerRequest;
+// One request per track type, so a URL shared by both sets is still reported with the right type
+@property (nonatomic, strong) HyBidAdTrackerRequest *impressionTrackerRequest;
+@property (nonatomic, strong) HyBidAdTrackerRequest *clickTrackerRequest;
 @property (nonatomic, strong) NSArray *impressionURLs;
 @property (nonatomic, strong) NSArray *clickURLs;
+@property (nonatomic, strong) NSString *adIdentifier;
 @property (nonatomic, assign) BOOL impressionTracked;
 @property (nonatomic, assign) BOOL clickTracked;
 
@@ -40,25 +44,29 @@ NSString *const PNLiteAdTrackerImpression = @"impression";
 @implementation HyBidAdTracker
 
 - (void)dealloc {
-    self.adTrackerRequest = nil;
+    self.impressionTrackerRequest = nil;
+    self.clickTrackerRequest = nil;
     self.impressionURLs = nil;
     self.clickURLs = nil;
+    self.adIdentifier = nil;
+    self.completion = nil;
 }
 
 - (instancetype)initWithImpressionURLs:(NSArray *)impressionURLs
                          withClickURLs:(NSArray *)clickURLs {
-    HyBidAdTrackerRequest *adTrackerRequest = [[HyBidAdTrackerRequest alloc] init];
-    return [self initWithAdTrackerRequest:adTrackerRequest withImpressionURLs:impressionURLs withClickURLs:clickURLs];
+    return [self initWithImpressionURLs:impressionURLs withClickURLs:clickURLs withAdIdentifier:nil];
 }
 
-- (instancetype)initWithAdTrackerRequest:(HyBidAdTrackerRequest *)adTrackerRequest
-                      withImpressionURLs:(NSArray *)impressionURLs
-                           withClickURLs:(NSArray *)clickURLs {
+- (instancetype)initWithImpressionURLs:(NSArray *)impressionURLs
+                         withClickURLs:(NSArray *)clickURLs
+                      withAdIdentifier:(NSString *)adIdentifier {
     self = [super init];
     if (self) {
-        self.adTrackerRequest = adTrackerRequest;
+        self.impressionTrackerRequest = [[HyBidAdTrackerRequest alloc] init];
+        self.clickTrackerRequest = [[HyBidAdTrackerRequest alloc] init];
         self.impressionURLs = impressionURLs;
         self.clickURLs = clickURLs;
+        self.adIdentifier = adIdentifier;
     }
     return self;
 }
@@ -68,7 +76,7 @@ NSString *const PNLiteAdTrackerImpression = @"impression";
         return;
     }
     
-    [self trackURLs:self.clickURLs withTrackType:PNLiteAdTrackerClick];
+    [self trackURLs:self.clickURLs withAdTrackerRequest:self.clickTrackerRequest];
     self.clickTracked = YES;
 }
 
@@ -77,15 +85,29 @@ NSString *const PNLiteAdTrackerImpression = @"impression";
         return;
     }
     
-    [self trackURLs:self.impressionURLs withTrackType:PNLiteAdTrackerImpression];
+    [self trackURLs:self.impressionURLs withAdTrackerRequest:self.impressionTrackerRequest];
     self.impressionTracked = YES;
 }
 
-- (void)trackURLs:(NSArray *)URLs withTrackType:(NSString *)trackType {
+- (NSString *)trackTypeForRequest:(HyBidAdTrackerRequest *)request {
+    return request == self.clickTrackerRequest ? PNLiteAdTrackerClick : PNLiteAdTrackerImpression;
+}
+
+- (void)trackURLs:(NSArray *)URLs withAdTrackerRequest:(HyBidAdTrackerRequest *)adTrackerRequest {
     if (URLs != nil) {
+        NSString *trackType = [self trackTypeForRequest:adTrackerRequest];
+        NSMutableArray<NSString *> *urlStrings = [NSMutableArray arrayWithCapacity:URLs.count];
         for (HyBidDataModel *dataModel in URLs) {
+            if (![[PNLiteBeaconDeduplicator sharedInstance] registerBeaconWithURL:dataModel.url forAdIdentifier:self.adIdentifier]) {
+                continue;
+            }
             [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Tracking %@ with URL: %@",trackType, dataModel.url]];
-            [self.adTrackerRequest trackAdWithDelegate:self withURL:dataModel.url];
+            if (dataModel.url) {
+                [urlStrings addObject:dataModel.url];
+            }
+        }
+        if (urlStrings.count > 0) {
+            [adTrackerRequest trackAdWithDelegate:self withURLs:urlStrings];
         }
     }
 }
@@ -104,4 +126,20 @@ NSString *const PNLiteAdTrackerImpression = @"impression";
     [HyBidLogger errorLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Ad Tracker Request %@ failed with error: %@",request,error.localizedDescription]];
 }
 
+- (void)request:(HyBidAdTrackerRequest *)request didTrackURL:(NSString *)url withError:(NSError *)error {
+    if (error) {
+        [HyBidLogger errorLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Tracking %@ with URL: %@ failed with error: %@", [self trackTypeForRequest:request], url, error.localizedDescription]];
+    } else {
+        [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Tracked %@ with URL: %@", [self trackTypeForRequest:request], url]];
+    }
+}
+
+- (void)request:(HyBidAdTrackerRequest *)request didFinishTrackingURLs:(NSArray<NSString *> *)urls withFailedURLs:(NSArray<NSString *> *)failedURLs duration:(NSTimeInterval)duration {
+    NSString *trackType = [self trackTypeForRequest:request];
+    [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Finished tracking %lu %@ URLs in %.3fs, %lu failed.", (unsigned long)urls.count, trackType, duration, (unsigned long)failedURLs.count]];
+    if (self.completion) {
+        self.completion(trackType, failedURLs, duration);
+    }
+}
+
 @end
@@ -30,10 +30,20 @@
 - (void)requestDidFinish:(HyBidAdTrackerRequest *)request;
 - (void)request:(HyBidAdTrackerRequest *)request didFailWithError:(NSError *)error;
 
+@optional
+- (void)request:(HyBidAdTrackerRequest *)request didTrackURL:(NSString *)url withError:(NSError *)error;
+- (void)request:(HyBidAdTrackerRequest *)request didFinishTrackingURLs:(NSArray<NSString *> *)urls withFailedURLs:(NSArray<NSString *> *)failedURLs duration:(NSTimeInterval)duration;
+
 @end
 
 @interface HyBidAdTrackerRequest : NSObject
 
 - (void)trackAdWithDelegate:(NSObject<HyBidAdTrackerRequestDelegate> *)delegate withURL:(NSString *)url;
 
+/**
+ Fires all URLs through the tracking manager queue. The delegate is told about every URL as its first attempt
+ completes, then once more when the whole set is done, along with how long that took.
+ */
+- (void)trackAdWithDelegate:(NSObject<HyBidAdTrackerRequestDelegate> *)delegate withURLs:(NSArray<NSString *> *)urls;
+
 @end
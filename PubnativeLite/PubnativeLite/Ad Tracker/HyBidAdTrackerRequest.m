@@ -22,10 +22,32 @@
 
 #import "HyBidAdTrackerRequest.h"
 #import "PNLiteHttpRequest.h"
+#import "PNLiteTrackingManager.h"
+#import "PNLiteMonotonicClock.h"
 #import "HyBidLogger.h"
 
 NSInteger const PNLiteResponseStatusRequestNotFound = 404;
 
+@interface HyBidAdTrackerRequestBatch : NSObject
+
+@property (nonatomic, weak) NSObject <HyBidAdTrackerRequestDelegate> *delegate;
+@property (nonatomic, strong) NSArray<NSString *> *urls;
+@property (nonatomic, strong) NSMutableArray<NSString *> *failedURLs;
+@property (nonatomic, assign) NSUInteger pendingCount;
+@property (nonatomic, assign) NSTimeInterval startUptime;
+
+@end
+
+@implementation HyBidAdTrackerRequestBatch
+
+- (void)dealloc {
+    self.delegate = nil;
+    self.urls = nil;
+    self.failedURLs = nil;
+}
+
+@end
+
 @interface HyBidAdTrackerRequest() <PNLiteHttpRequestDelegate>
 
 @property (nonatomic, weak) NSObject <HyBidAdTrackerRequestDelegate> *delegate;
@@ -50,6 +72,76 @@ NSInteger const PNLiteResponseStatusRequestNotFound = 404;
     }
 }
 
+- (void)trackAdWithDelegate:(NSObject<HyBidAdTrackerRequestDelegate> *)delegate withURLs:(NSArray<NSString *> *)urls {
+    NSMutableArray<NSString *> *validURLs = [NSMutableArray arrayWithCapacity:urls.count];
+    for (NSString *url in urls) {
+        if ([url isKindOfClass:[NSString class]] && url.length > 0) {
+            [validURLs addObject:url];
+        }
+    }
+    if(!delegate) {
+        [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:@"Given delegate is nil and required, droping this call."];
+    } else if(validURLs.count == 0) {
+        [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:@"URLs nil or empty, droping this call."];
+    } else {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            HyBidAdTrackerRequestBatch *batch = [[HyBidAdTrackerRequestBatch alloc] init];
+            batch.delegate = delegate;
+            batch.urls = validURLs;
+            batch.failedURLs = [NSMutableArray array];
+            batch.pendingCount = validURLs.count;
+            batch.startUptime = [PNLiteMonotonicClock uptime];
+            if ([delegate respondsToSelector:@selector(requestDidStart:)]) {
+                [delegate requestDidStart:self];
+            }
+            // The tracking manager bounds how many beacons are on the wire and retries the failed ones
+            for (NSString *url in validURLs) {
+                NSURL *trackURL = [NSURL URLWithString:url];
+                if (!trackURL) {
+                    [self batch:batch didTrackURL:url withError:[NSError errorWithDomain:@"Invalid tracking URL." code:0 userInfo:nil]];
+                    continue;
+                }
+                [self trackURL:trackURL completion:^(NSInteger statusCode, NSError *error) {
+                    NSError *statusError = error;
+                    if (!statusError && PNLiteResponseStatusRequestNotFound == statusCode) {
+                        statusError = [NSError errorWithDomain:@"Server error with the status code" code:statusCode userInfo:nil];
+                    }
+                    [self batch:batch didTrackURL:url withError:statusError];
+                }];
+            }
+        });
+    }
+}
+
+- (void)trackURL:(NSURL *)url completion:(PNLiteTrackingManagerCompletionBlock)completion {
+    [PNLiteTrackingManager trackWithURL:url completion:completion];
+}
+
+- (void)batch:(HyBidAdTrackerRequestBatch *)batch didTrackURL:(NSString *)url withError:(NSError *)error {
+    if (error) {
+        [batch.failedURLs addObject:url];
+    }
+    NSObject<HyBidAdTrackerRequestDelegate> *delegate = batch.delegate;
+    if ([delegate respondsToSelector:@selector(request:didTrackURL:withError:)]) {
+        [delegate request:self didTrackURL:url withError:error];
+    }
+    batch.pendingCount--;
+    if (batch.pendingCount == 0) {
+        NSTimeInterval duration = [PNLiteMonotonicClock uptime] - batch.startUptime;
+        if ([delegate respondsToSelector:@selector(request:didFinishTrackingURLs:withFailedURLs:duration:)]) {
+            [delegate request:self didFinishTrackingURLs:batch.urls withFailedURLs:batch.failedURLs duration:duration];
+        }
+        if (batch.failedURLs.count == 0) {
+            if ([delegate respondsToSelector:@selector(requestDidFinish:)]) {
+                [delegate requestDidFinish:self];
+            }
+        } else if ([delegate respondsToSelector:@selector(request:didFailWithError:)]) {
+            NSString *message = [NSString stringWithFormat:@"%lu of %lu tracking URLs failed.", (unsigned long)batch.failedURLs.count, (unsigned long)batch.urls.count];
+            [delegate request:self didFailWithError:[NSError errorWithDomain:message code:0 userInfo:nil]];
+        }
+    }
+}
+
 - (void)invokeDidStart {
     dispatch_async(dispatch_get_main_queue(), ^{
         if (self.delegate && [self.delegate respondsToSelector:@selector(requestDidStart:)]) {
@@ -76,6 +76,9 @@ typedef void (^HyBidCompletionBlock)(BOOL);
 + (void)setCoppa:(BOOL)enabled;
 + (void)setTargeting:(HyBidTargetingModel *)targeting;
 + (void)setTestMode:(BOOL)enabled;
++ (void)setBeaconBatching:(BOOL)enabled;
++ (void)setVASTSchemaValidationSampleRate:(double)sampleRate;
++ (void)setVASTSchemaValidationStrict:(BOOL)enabled;
 + (void)initWithAppToken:(NSString *)appToken completion:(HyBidCompletionBlock)completion;
 
 @end
@@ -41,6 +41,18 @@ NSString *const HyBidBaseURL = @"https://api.pubnative.net";
     [HyBidSettings sharedInstance].test = enabled;
 }
 
++ (void)setBeaconBatching:(BOOL)enabled {
+    [HyBidSettings sharedInstance].beaconBatching = enabled;
+}
+
++ (void)setVASTSchemaValidationSampleRate:(double)sampleRate {
+    [HyBidSettings sharedInstance].vastSchemaValidationSampleRate = MAX(0, MIN(sampleRate, 1));
+}
+
++ (void)setVASTSchemaValidationStrict:(BOOL)enabled {
+    [HyBidSettings sharedInstance].vastSchemaValidationStrict = enabled;
+}
+
 + (void)initWithAppToken:(NSString *)appToken completion:(HyBidCompletionBlock)completion {
     if (!appToken || appToken.length == 0) {
         [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:@"App Token is nil or empty and required."];
@@ -23,6 +23,7 @@
 #import "HyBidAdView.h"
 #import "HyBidLogger.h"
 #import "HyBidIntegrationType.h"
+#import "PNLiteMRAIDWebViewPool.h"
 
 @interface HyBidAdView()
 
@@ -58,6 +59,8 @@
             [self.delegate adView:self didFailWithError:[NSError errorWithDomain:@"Invalid Zone ID provided." code:0 userInfo:nil]];
         }
     } else {
+        // Warm the web view while the request is in flight, in case the ad turns out to be MRAID
+        [[PNLiteMRAIDWebViewPool sharedInstance] prewarmForFormat:[PNLiteMRAIDWebViewPool formatForSize:self.frame.size isInterstitial:NO]];
         [self.adRequest setIntegrationType: self.isMediation ? MEDIATION : STANDALONE withZoneID:zoneID];
         [self.adRequest requestAdWithDelegate:self withZoneID:zoneID];
     }
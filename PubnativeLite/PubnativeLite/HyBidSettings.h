@@ -33,6 +33,11 @@
 @property (nonatomic, strong) HyBidTargetingModel *targeting;
 @property (nonatomic, strong) NSString *appToken;
 @property (nonatomic, strong) NSString *apiURL;
+@property (nonatomic, assign) BOOL beaconBatching;
+// Share of VAST documents (0 to 1) validated against the VAST XSD, 0 turns validation off
+@property (nonatomic, assign) double vastSchemaValidationSampleRate;
+// Sampled documents that fail validation are only logged, unless strict validation rejects them
+@property (nonatomic, assign) BOOL vastSchemaValidationStrict;
 
 // COMMON PARAMETERS
 @property (readonly) NSString *advertisingId;
@@ -49,6 +49,9 @@
 @property (nonatomic, strong) id<HyBidMRAIDServiceDelegate> serviceDelegate;
 @property (nonatomic, weak, setter = setRootViewController:) UIViewController *rootViewController;
 @property (nonatomic, assign, getter = isViewable, setter = setIsViewable:) BOOL isViewable;
+/// Percentage (0-100) of the ad currently on screen, after clipping by its ancestors and opaque views above it. Main thread only.
+/// Changes are sent to the creative as MRAID exposureChange events, and drive the viewable state of inline ads.
+@property (nonatomic, readonly) CGFloat exposurePercentage;
 
 // IMPORTANT: This is the only valid initializer for an MRAIDView; -init and -initWithFrame: will throw exceptions
 - (id)initWithFrame:(CGRect)frame
@@ -29,10 +29,13 @@
 #import "PNLiteMRAIDUtil.h"
 #import "PNLiteMRAIDSettings.h"
 #import "HyBidViewabilityManager.h"
+#import "PNLiteVisibilityGeometry.h"
+#import "PNLiteVisibilityScheduler.h"
+#import "PNLiteMRAIDScripts.h"
+#import "PNLiteMRAIDWebViewPool.h"
 
 #import "HyBidLogger.h"
 
-#import "PNLitemraidjs.h"
 #import "PNLiteCloseButton.h"
 
 #import <WebKit/WebKit.h>
@@ -52,7 +55,7 @@ typedef enum {
     PNLiteMRAIDStateHidden
 } PNLiteMRAIDState;
 
-@interface HyBidMRAIDView () <WKNavigationDelegate, WKUIDelegate, PNLiteMRAIDModalViewControllerDelegate, UIGestureRecognizerDelegate, HyBidContentInfoViewDelegate>
+@interface HyBidMRAIDView () <WKNavigationDelegate, WKUIDelegate, PNLiteMRAIDModalViewControllerDelegate, UIGestureRecognizerDelegate, HyBidContentInfoViewDelegate, PNLiteVisibilitySchedulerObserver>
 {
     PNLiteMRAIDState state;
     // This corresponds to the MRAID placement type.
@@ -72,9 +75,6 @@ typedef enum {
     PNLiteMRAIDParser *mraidParser;
     PNLiteMRAIDModalViewController *modalVC;
     
-    NSString *mraidjs;
-    NSString *omSDKjs;
-    
     NSURL *baseURL;
     
     NSArray *mraidFeatures;
@@ -83,6 +83,7 @@ typedef enum {
     WKWebView *webView;
     WKWebView *webViewPart2;
     WKWebView *currentWebView;
+    PNLiteMRAIDWebViewPoolFormat webViewPoolFormat;
     
     UIButton *closeEventRegion;
     
@@ -97,6 +98,9 @@ typedef enum {
     
     UITapGestureRecognizer *tapGestureRecognizer;
     BOOL bonafideTapObserved;
+    
+    // Last exposure sent to the creative, -1 before the first one
+    CGFloat lastExposurePercentage;
 }
 
 - (void)deviceOrientationDidChange:(NSNotification *)notification;
@@ -116,6 +120,7 @@ typedef enum {
 - (void)fireSizeChangeEvent;
 - (void)fireStateChangeEvent;
 - (void)fireViewableChangeEvent;
+- (void)fireExposureChangeEventWithSnapshot:(PNLiteVisibilitySnapshot)snapshot exposurePercentage:(CGFloat)exposurePercentage;
 // setters
 - (void)setDefaultPosition;
 - (void)setMaxSize;
@@ -193,6 +198,7 @@ typedef enum {
         
         state = PNLiteMRAIDStateLoading;
         _isViewable = NO;
+        lastExposurePercentage = -1;
         useCustomClose = NO;
         
         
@@ -215,7 +221,8 @@ typedef enum {
             supportedFeatures=currentFeatures;
         }
         
-        webView = [[WKWebView alloc] initWithFrame:CGRectMake(0, 0, self.bounds.size.width, self.bounds.size.height) configuration:[self createConfiguration]];
+        webViewPoolFormat = [PNLiteMRAIDWebViewPool formatForSize:frame.size isInterstitial:isInter];
+        webView = [self createWebViewWithFrame:CGRectMake(0, 0, self.bounds.size.width, self.bounds.size.height)];
         [self initWebView:webView];
         currentWebView = webView;
         [self addSubview:webView];
@@ -225,25 +232,10 @@ typedef enum {
         
         [self addObserver:self forKeyPath:@"self.frame" options:NSKeyValueObservingOptionOld context:NULL];
         
-        // Get mraid.js as binary data
-        NSData* mraidJSData = [NSData dataWithBytesNoCopy:__PNLite_MRAID_mraid_js
-                                                   length:__PNLite_MRAID_mraid_js_len
-                                             freeWhenDone:NO];
-        mraidjs = [[NSString alloc] initWithData:mraidJSData encoding:NSUTF8StringEncoding];
-        mraidJSData = nil;
-        
+        // mraid.js comes with the configuration as a shared document start user script
         baseURL = bsURL;
         state = PNLiteMRAIDStateLoading;
         
-        if (mraidjs) {
-            [self injectJavaScript:mraidjs];
-        }
-        /*
-        omSDKjs = [[HyBidViewabilityManager sharedInstance] getOMIDJS];
-        if (omSDKjs) {
-            [self injectJavaScript:omSDKjs];
-        }
-        */
         if (baseURL != nil && [[baseURL absoluteString] length]!= 0) {
             __block NSString *htmlData = htmlData;
             [self htmlFromUrl:baseURL handler:^(NSString *html, NSError *error) {
@@ -296,9 +288,13 @@ typedef enum {
     
     [self removeObserver:self forKeyPath:@"self.frame"];
     [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [[PNLiteVisibilityScheduler sharedInstance] removeObserver:self];
     [[UIDevice currentDevice] endGeneratingDeviceOrientationNotifications];
     
-    
+    // The content info view may sit on the web view, it mustn't follow it into the next ad
+    [contentInfoViewContainer removeFromSuperview];
+    [[PNLiteMRAIDWebViewPool sharedInstance] recycleWebView:webView];
+    [[PNLiteMRAIDWebViewPool sharedInstance] recycleWebView:webViewPart2];
     webView = nil;
     webViewPart2 = nil;
     currentWebView = nil;
@@ -355,6 +351,45 @@ typedef enum {
     return _isViewable;
 }
 
+- (CGFloat)exposurePercentage {
+    return [PNLiteVisibilityGeometry exposurePercentageForView:self];
+}
+
+#pragma mark - Exposure
+
+- (void)didMoveToWindow {
+    [super didMoveToWindow];
+    if (self.window) {
+        [[PNLiteVisibilityScheduler sharedInstance] addObserver:self];
+    } else {
+        [[PNLiteVisibilityScheduler sharedInstance] removeObserver:self];
+        [self updateExposure];
+    }
+}
+
+- (void)visibilitySchedulerDidTick:(PNLiteVisibilityScheduler *)scheduler {
+    [self updateExposure];
+}
+
+- (void)updateExposure {
+    if (state == PNLiteMRAIDStateLoading) {
+        // mraid.js isn't ready to hear about it yet
+        return;
+    }
+    PNLiteVisibilitySnapshot snapshot = [PNLiteVisibilityGeometry snapshotForView:self withMinVisibility:0];
+    // Tenths of a percent, smaller changes aren't worth a round trip to the creative
+    CGFloat exposurePercentage = round([PNLiteVisibilityGeometry exposurePercentageForSnapshot:snapshot] * 10) / 10;
+    if (exposurePercentage == lastExposurePercentage) {
+        return;
+    }
+    lastExposurePercentage = exposurePercentage;
+    [self fireExposureChangeEventWithSnapshot:snapshot exposurePercentage:exposurePercentage];
+    if (!isInterstitial) {
+        // As in MRAID 3, an inline ad is viewable while any part of it is on screen
+        self.isViewable = exposurePercentage > 0;
+    }
+}
+
 - (void)setRootViewController:(UIViewController *)newRootViewController {
     if(newRootViewController!=_rootViewController) {
         _rootViewController=newRootViewController;
@@ -466,8 +501,7 @@ typedef enum {
     
     if (webViewPart2) {
         // Clean up webViewPart2 if returning from 2-part expansion.
-        webViewPart2.navigationDelegate = nil;
-        webViewPart2.UIDelegate = nil;
+        [[PNLiteMRAIDWebViewPool sharedInstance] recycleWebView:webViewPart2];
         currentWebView = webView;
         webViewPart2 = nil;
     } else {
@@ -519,7 +553,6 @@ typedef enum {
         return;  // ignore programmatic touches (taps)
     }
     
-    eventJSON=[eventJSON stringByRemovingPercentEncoding];
     [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat: @"JS callback %@ %@", NSStringFromSelector(_cmd), eventJSON]];
     
     if ([supportedFeatures containsObject:PNLiteMRAIDSupportsCalendar]) {
@@ -557,22 +590,13 @@ typedef enum {
         [webView removeFromSuperview];
     } else {
         // 2-part expansion
-        webViewPart2 = [[WKWebView alloc] initWithFrame:frame configuration:[self createConfiguration]];
+        webViewPart2 = [self createWebViewWithFrame:frame];
         [self initWebView:webViewPart2];
         currentWebView = webViewPart2;
         bonafideTapObserved = YES; // by definition for 2 part expand a valid tap has occurred
         
-        if (mraidjs) {
-            [self injectJavaScript:mraidjs];
-        }
-        /*
-        if (omSDKjs) {
-            [self injectJavaScript:omSDKjs];
-        }
-        */
         // Check to see whether we've been given an absolute or relative URL.
         // If it's relative, prepend the base URL.
-        urlString = [urlString stringByRemovingPercentEncoding];
         if (![[NSURL URLWithString:urlString] scheme]) {
             // relative URL
             urlString = [[[baseURL absoluteString] stringByRemovingPercentEncoding] stringByAppendingString:urlString];
@@ -589,8 +613,7 @@ typedef enum {
             // Error! Clean up and return.
             [HyBidLogger errorLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Could not load part 2 expanded content for URL: %@" ,urlString]];
             currentWebView = webView;
-            webViewPart2.navigationDelegate = nil;
-            webViewPart2.UIDelegate = nil;
+            [[PNLiteMRAIDWebViewPool sharedInstance] recycleWebView:webViewPart2];
             webViewPart2 = nil;
             modalVC = nil;
             return;
@@ -641,7 +664,6 @@ typedef enum {
         return;  // ignore programmatic touches (taps)
     }
     
-    urlString = [urlString stringByRemovingPercentEncoding];
     [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat: @"JS callback %@ %@", NSStringFromSelector(_cmd), urlString]];
     
     // Notify the callers
@@ -656,7 +678,6 @@ typedef enum {
         return;  // ignore programmatic touches (taps)
     }
     
-    urlString = [urlString stringByRemovingPercentEncoding];
     [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat: @"JS callback %@ %@", NSStringFromSelector(_cmd), urlString]];
     if ([self.serviceDelegate respondsToSelector:@selector(mraidServicePlayVideoWithUrlString:)]) {
         [self.serviceDelegate mraidServicePlayVideoWithUrlString:urlString];
@@ -669,7 +690,6 @@ typedef enum {
         return;  // ignore programmatic touches (taps)
     }
     
-    urlString = [urlString stringByRemovingPercentEncoding];
     [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat: @"JS callback %@ %@", NSStringFromSelector(_cmd), urlString]];
     if ([self.serviceDelegate respondsToSelector:@selector(mraidServiceSendSMSWithUrlString:)]) {
         [self.serviceDelegate mraidServiceSendSMSWithUrlString:urlString];
@@ -682,7 +702,6 @@ typedef enum {
         return;  // ignore programmatic touches (taps)
     }
     
-    urlString = [urlString stringByRemovingPercentEncoding];
     [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat: @"JS callback %@ %@", NSStringFromSelector(_cmd), urlString]];
     if ([self.serviceDelegate respondsToSelector:@selector(mraidServiceCallNumberWithUrlString:)]) {
         [self.serviceDelegate mraidServiceCallNumberWithUrlString:urlString];
@@ -760,7 +779,6 @@ typedef enum {
         return;  // ignore programmatic touches (taps)
     }
     
-    urlString=[urlString stringByRemovingPercentEncoding];
     [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat: @"JS callback %@ %@", NSStringFromSelector(_cmd), urlString]];
     
     if ([supportedFeatures containsObject:PNLiteMRAIDSupportsStorePicture]) {
@@ -1021,6 +1039,28 @@ typedef enum {
     [self injectJavaScript:[NSString stringWithFormat:@"mraid.fireViewableChangeEvent(%@);", (self.isViewable ? @"true" : @"false")]];
 }
 
+- (NSString *)javaScriptRect:(CGRect)rect relativeToPoint:(CGPoint)origin {
+    return [NSString stringWithFormat:@"{x:%.0f,y:%.0f,width:%.0f,height:%.0f}", rect.origin.x - origin.x, rect.origin.y - origin.y, rect.size.width, rect.size.height];
+}
+
+- (void)fireExposureChangeEventWithSnapshot:(PNLiteVisibilitySnapshot)snapshot exposurePercentage:(CGFloat)exposurePercentage {
+    // Rectangles are in the ad's own coordinates, null when there is nothing to report
+    NSString *visibleRectangle = @"null";
+    NSString *occlusionRectangles = @"null";
+    if (exposurePercentage > 0) {
+        CGPoint origin = snapshot.frameInWindow.origin;
+        visibleRectangle = [self javaScriptRect:snapshot.clipRect relativeToPoint:origin];
+        if (snapshot.occluderCount > 0) {
+            NSMutableArray<NSString *> *rects = [NSMutableArray arrayWithCapacity:snapshot.occluderCount];
+            for (NSUInteger i = 0; i < snapshot.occluderCount; i++) {
+                [rects addObject:[self javaScriptRect:snapshot.occluders[i] relativeToPoint:origin]];
+            }
+            occlusionRectangles = [NSString stringWithFormat:@"[%@]", [rects componentsJoinedByString:@","]];
+        }
+    }
+    [self injectJavaScript:[NSString stringWithFormat:@"mraid.fireExposureChangeEvent(%.1f,%@,%@);", exposurePercentage, visibleRectangle, occlusionRectangles]];
+}
+
 - (void)setDefaultPosition {
     if (isInterstitial) {
         // For interstitials, we define defaultPosition to be the same as screen size, so set the value there.
@@ -1231,8 +1271,16 @@ createWebViewWithConfiguration:(WKWebViewConfiguration *)configuration
 
 #pragma mark - internal helper methods
 
+- (WKWebView *)createWebViewWithFrame:(CGRect)frame {
+    if ([supportedFeatures containsObject:PNLiteMRAIDSupportsInlineVideo]) {
+        // Pooled web views are set up for inline video, which is what every format asks for
+        return [[PNLiteMRAIDWebViewPool sharedInstance] dequeueWebViewWithFrame:frame forFormat:webViewPoolFormat];
+    }
+    return [[WKWebView alloc] initWithFrame:frame configuration:[self createConfiguration]];
+}
+
 - (WKWebViewConfiguration *)createConfiguration {
-    WKWebViewConfiguration *webConfiguration = [[WKWebViewConfiguration alloc] init];
+    WKWebViewConfiguration *webConfiguration = [[PNLiteMRAIDScripts sharedInstance] configuration];
 
     if ([supportedFeatures containsObject:PNLiteMRAIDSupportsInlineVideo]) {
         webConfiguration.allowsInlineMediaPlayback = YES;
@@ -1279,24 +1327,27 @@ createWebViewWithConfiguration:(WKWebViewConfiguration *)configuration
 }
 
 - (void)parseCommandUrl:(NSString *)commandUrlString {
-    NSDictionary *commandDict = [mraidParser parseCommandUrl:commandUrlString];
-    if (!commandDict) {
+    PNLiteMRAIDCommand *command = [mraidParser parseCommandUrl:commandUrlString];
+    if (!command) {
         [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"invalid command URL: %@", commandUrlString]];
         return;
     }
     
-    NSString *command = [commandDict valueForKey:@"command"];
-    NSObject *paramObj = [commandDict valueForKey:@"paramObj"];
-    
-    SEL selector = NSSelectorFromString(command);
-    
-    // Turn off the warning "PerformSelector may cause a leak because its selector is unknown".
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Warc-performSelector-leaks"
-    
-    [self performSelector:selector withObject:paramObj];
-    
-#pragma clang diagnostic pop
+    id parameter = command.parameter;
+    switch (command.type) {
+        case PNLiteMRAIDCommandTypeCreateCalendarEvent:         [self createCalendarEvent:parameter]; break;
+        case PNLiteMRAIDCommandTypeClose:                       [self close]; break;
+        case PNLiteMRAIDCommandTypeExpand:                      [self expand:parameter]; break;
+        case PNLiteMRAIDCommandTypeOpen:                        [self open:parameter]; break;
+        case PNLiteMRAIDCommandTypePlayVideo:                   [self playVideo:parameter]; break;
+        case PNLiteMRAIDCommandTypeSendSMS:                     [self sendSMS:parameter]; break;
+        case PNLiteMRAIDCommandTypeCallNumber:                  [self callNumber:parameter]; break;
+        case PNLiteMRAIDCommandTypeResize:                      [self resize]; break;
+        case PNLiteMRAIDCommandTypeSetOrientationProperties:    [self setOrientationProperties:parameter]; break;
+        case PNLiteMRAIDCommandTypeSetResizeProperties:         [self setResizeProperties:parameter]; break;
+        case PNLiteMRAIDCommandTypeStorePicture:                [self storePicture:parameter]; break;
+        case PNLiteMRAIDCommandTypeUseCustomClose:              [self useCustomClose:parameter]; break;
+    }
 }
 
 #pragma mark - Gesture Methods
@@ -22,13 +22,36 @@
 
 #import <Foundation/Foundation.h>
 
+typedef NS_ENUM(NSInteger, PNLiteMRAIDCommandType) {
+    PNLiteMRAIDCommandTypeCreateCalendarEvent,
+    PNLiteMRAIDCommandTypeClose,
+    PNLiteMRAIDCommandTypeExpand,
+    PNLiteMRAIDCommandTypeOpen,
+    PNLiteMRAIDCommandTypePlayVideo,
+    PNLiteMRAIDCommandTypeSendSMS,
+    PNLiteMRAIDCommandTypeCallNumber,
+    PNLiteMRAIDCommandTypeResize,
+    PNLiteMRAIDCommandTypeSetOrientationProperties,
+    PNLiteMRAIDCommandTypeSetResizeProperties,
+    PNLiteMRAIDCommandTypeStorePicture,
+    PNLiteMRAIDCommandTypeUseCustomClose
+};
+
+@interface PNLiteMRAIDCommand : NSObject
+
+@property (nonatomic, readonly) PNLiteMRAIDCommandType type;
+// The decoded value the command takes, a dictionary of every parameter for the property setters, nil for commands without one
+@property (nonatomic, readonly) id parameter;
+
+@end
+
 @class HyBidMRAIDView;
 // A parser class which validates MRAID commands passed from the creative to the native methods.
-// This takes a commandUrl of type "mraid://command?param1=val1&param2=val2&..." and return a
-// dictionary of key/value pairs which include command name and all the parameters. It checks
-// if the command itself is a valid MRAID command and also a simpler parameters validation.
+// This takes a commandUrl of type "mraid://command?param1=val1&param2=val2&..." and looks the command up
+// in a static table, which lists the parameters it requires and how its parameter is extracted.
+// Parameters are percent-decoded once here, so handlers get them ready to use.
 @interface PNLiteMRAIDParser : NSObject
 
-- (NSDictionary *)parseCommandUrl:(NSString *)commandUrl;
+- (PNLiteMRAIDCommand *)parseCommandUrl:(NSString *)commandUrl;
 
 @end
@@ -24,142 +24,196 @@
 
 #import "HyBidLogger.h"
 
-@interface PNLiteMRAIDParser ()
+typedef NS_ENUM(NSInteger, PNLiteMRAIDParameterExtraction) {
+    // The command takes no parameter
+    PNLiteMRAIDParameterExtractionNone,
+    // The value of the entry's value parameter, nil when it's optional and missing
+    PNLiteMRAIDParameterExtractionValue,
+    // Like value, but running to the end of the URL, mraid.js sends JSON without escaping its & and =
+    PNLiteMRAIDParameterExtractionTrailingValue,
+    // Every parameter, for the property setters
+    PNLiteMRAIDParameterExtractionDictionary
+};
 
-- (BOOL)isValidCommand:(NSString *)command;
-- (BOOL)checkParamsForCommand:(NSString *)command params:(NSDictionary *)params;
+typedef struct {
+    const char *name;
+    PNLiteMRAIDParameterExtraction extraction;
+    const char *valueParameter;
+    const char *requiredParameters[7];
+} PNLiteMRAIDCommandEntry;
+
+static const PNLiteMRAIDCommandEntry PNLiteMRAIDCommandTable[] = {
+    [PNLiteMRAIDCommandTypeCreateCalendarEvent] = {"createCalendarEvent", PNLiteMRAIDParameterExtractionTrailingValue, "eventJSON", {"eventJSON"}},
+    [PNLiteMRAIDCommandTypeClose] = {"close", PNLiteMRAIDParameterExtractionNone, NULL, {NULL}},
+    [PNLiteMRAIDCommandTypeExpand] = {"expand", PNLiteMRAIDParameterExtractionValue, "url", {NULL}},
+    [PNLiteMRAIDCommandTypeOpen] = {"open", PNLiteMRAIDParameterExtractionValue, "url", {"url"}},
+    [PNLiteMRAIDCommandTypePlayVideo] = {"playVideo", PNLiteMRAIDParameterExtractionValue, "url", {"url"}},
+    [PNLiteMRAIDCommandTypeSendSMS] = {"sendSMS", PNLiteMRAIDParameterExtractionValue, "url", {"url"}},
+    [PNLiteMRAIDCommandTypeCallNumber] = {"callNumber", PNLiteMRAIDParameterExtractionValue, "url", {"url"}},
+    [PNLiteMRAIDCommandTypeResize] = {"resize", PNLiteMRAIDParameterExtractionNone, NULL, {NULL}},
+    [PNLiteMRAIDCommandTypeSetOrientationProperties] = {"setOrientationProperties", PNLiteMRAIDParameterExtractionDictionary, NULL,
+        {"allowOrientationChange", "forceOrientation"}},
+    [PNLiteMRAIDCommandTypeSetResizeProperties] = {"setResizeProperties", PNLiteMRAIDParameterExtractionDictionary, NULL,
+        {"width", "height", "offsetX", "offsetY", "customClosePosition", "allowOffscreen"}},
+    [PNLiteMRAIDCommandTypeStorePicture] = {"storePicture", PNLiteMRAIDParameterExtractionValue, "url", {"url"}},
+    [PNLiteMRAIDCommandTypeUseCustomClose] = {"useCustomClose", PNLiteMRAIDParameterExtractionValue, "useCustomClose", {"useCustomClose"}}
+};
+
+static NSString *const PNLiteMRAIDScheme = @"mraid://";
+
+// Decoded values of this size or less don't need a heap buffer
+#define PNLiteMRAIDDecodeBufferSize 256
+
+/**
+ Length and first letter tell every command apart, so this is a perfect hash, the compare only confirms the match.
+ */
+static PNLiteMRAIDCommandType PNLiteMRAIDCommandTypeForName(const char *name, size_t length) {
+    PNLiteMRAIDCommandType type;
+    switch (length) {
+        case 4:     type = PNLiteMRAIDCommandTypeOpen; break;
+        case 5:     type = PNLiteMRAIDCommandTypeClose; break;
+        case 6:     type = name[0] == 'e' ? PNLiteMRAIDCommandTypeExpand : PNLiteMRAIDCommandTypeResize; break;
+        case 7:     type = PNLiteMRAIDCommandTypeSendSMS; break;
+        case 9:     type = PNLiteMRAIDCommandTypePlayVideo; break;
+        case 10:    type = PNLiteMRAIDCommandTypeCallNumber; break;
+        case 12:    type = PNLiteMRAIDCommandTypeStorePicture; break;
+        case 14:    type = PNLiteMRAIDCommandTypeUseCustomClose; break;
+        case 19:    type = name[0] == 'c' ? PNLiteMRAIDCommandTypeCreateCalendarEvent : PNLiteMRAIDCommandTypeSetResizeProperties; break;
+        case 24:    type = PNLiteMRAIDCommandTypeSetOrientationProperties; break;
+        default:    return NSNotFound;
+    }
+    const char *expected = PNLiteMRAIDCommandTable[type].name;
+    return (strlen(expected) == length && memcmp(expected, name, length) == 0) ? type : NSNotFound;
+}
+
+static int PNLiteMRAIDHexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ Percent-decodes in one pass. A malformed escape is kept as it is and bytes that don't decode to UTF-8 leave
+ the value undecoded, so a creative can't make a parameter disappear.
+ */
+static NSString *PNLiteMRAIDDecodeString(const char *bytes, size_t length) {
+    char stackBuffer[PNLiteMRAIDDecodeBufferSize];
+    char *buffer = length <= sizeof(stackBuffer) ? stackBuffer : malloc(length);
+    if (!buffer) {
+        return nil;
+    }
+    size_t decodedLength = 0;
+    for (size_t i = 0; i < length; i++) {
+        int high, low;
+        if (bytes[i] == '%' && i + 2 < length && (high = PNLiteMRAIDHexValue(bytes[i + 1])) >= 0 && (low = PNLiteMRAIDHexValue(bytes[i + 2])) >= 0) {
+            buffer[decodedLength++] = (char)((high << 4) | low);
+            i += 2;
+        } else {
+            buffer[decodedLength++] = bytes[i];
+        }
+    }
+    NSString *string = [[NSString alloc] initWithBytes:buffer length:decodedLength encoding:NSUTF8StringEncoding];
+    if (!string) {
+        string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    }
+    if (buffer != stackBuffer) {
+        free(buffer);
+    }
+    return string;
+}
+
+@interface PNLiteMRAIDCommand ()
+
+@property (nonatomic, assign) PNLiteMRAIDCommandType type;
+@property (nonatomic, strong) id parameter;
+
+@end
+
+@implementation PNLiteMRAIDCommand
+
+- (void)dealloc {
+    self.parameter = nil;
+}
 
 @end
 
 @implementation PNLiteMRAIDParser
 
-- (NSDictionary *)parseCommandUrl:(NSString *)commandUrl; {
+- (PNLiteMRAIDCommand *)parseCommandUrl:(NSString *)commandUrl {
     /*
      The command is a URL string that looks like this:
      
      mraid://command?param1=val1&param2=val2&...
      
-     We need to parse out the command, create a dictionary of the paramters and their associated values,
-     and then send an appropriate message back to the MRAIDView to run the command.
+     We need to parse out the command, find it in the command table, decode the parameters it takes
+     and hand them back to the MRAIDView to run the command.
      */
-    
-    [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"%@ %@", NSStringFromSelector(_cmd), commandUrl]];
-    
-    // Remove mraid:// prefix.
-    NSString *s = [commandUrl substringFromIndex:8];
-    
-    NSString *command;
-    NSMutableDictionary *params;
-    
-    // Check for parameters, parse them if found
-    NSRange range = [s rangeOfString:@"?"];
-    if (range.location != NSNotFound) {
-        command = [s substringToIndex:range.location];
-        NSString *paramStr = [s substringFromIndex:(range.location + 1)];
-        NSArray *paramArray = [paramStr componentsSeparatedByString:@"&"];
-        params = [NSMutableDictionary dictionaryWithCapacity:5];
-        for (NSString *param in paramArray) {
-            range = [param rangeOfString:@"="];
-            NSString *key = [param substringToIndex:range.location];
-            NSString *val = [param substringFromIndex:(range.location + 1)];
-            [params setValue:val forKey:key];
-        }
-    } else {
-        command = s;
+    const char *url = commandUrl.UTF8String;
+    if (!url || strncasecmp(url, PNLiteMRAIDScheme.UTF8String, PNLiteMRAIDScheme.length) != 0) {
+        [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"command URL %@ is not an MRAID URL", commandUrl]];
+        return nil;
     }
     
     // Check for valid command.
-    if (![self isValidCommand:command]) {
-        [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"command %@ is unknown", command]];
+    const char *name = url + PNLiteMRAIDScheme.length;
+    size_t nameLength = strcspn(name, "?");
+    PNLiteMRAIDCommandType type = PNLiteMRAIDCommandTypeForName(name, nameLength);
+    if (type == NSNotFound) {
+        [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"command %@ is unknown", commandUrl]];
         return nil;
     }
+    const PNLiteMRAIDCommandEntry *entry = &PNLiteMRAIDCommandTable[type];
     
-    // Check for valid parameters for the given command.
-    if (![self checkParamsForCommand:command params:params]) {
-        [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"command URL %@ is missing parameters", commandUrl]];
-        return nil;
+    // Parse the parameters, a parameter without = has an empty value
+    NSMutableDictionary<NSString *, NSString *> *params = nil;
+    if (name[nameLength] == '?' && entry->extraction != PNLiteMRAIDParameterExtractionNone) {
+        params = [NSMutableDictionary dictionaryWithCapacity:6];
+        size_t valueParameterLength = entry->valueParameter ? strlen(entry->valueParameter) : 0;
+        const char *cursor = name + nameLength + 1;
+        while (*cursor) {
+            const char *end = cursor + strcspn(cursor, "&");
+            const char *equals = memchr(cursor, '=', (size_t)(end - cursor));
+            const char *keyEnd = equals ? equals : end;
+            if (equals && entry->extraction == PNLiteMRAIDParameterExtractionTrailingValue &&
+                (size_t)(keyEnd - cursor) == valueParameterLength && memcmp(cursor, entry->valueParameter, valueParameterLength) == 0) {
+                end = equals + strlen(equals);
+            }
+            NSString *key = PNLiteMRAIDDecodeString(cursor, (size_t)(keyEnd - cursor));
+            NSString *value = equals ? PNLiteMRAIDDecodeString(equals + 1, (size_t)(end - equals - 1)) : @"";
+            if (key.length > 0 && value) {
+                params[key] = value;
+            }
+            cursor = *end ? end + 1 : end;
+        }
     }
     
-    NSObject *paramObj;
-    if (
-        [command isEqualToString:@"createCalendarEvent"] ||
-        [command isEqualToString:@"expand"] ||
-        [command isEqualToString:@"open"] ||
-        [command isEqualToString:@"playVideo"] ||
-        [command isEqualToString:@"sendSMS"] ||
-        [command isEqualToString:@"callNumber"] ||
-        [command isEqualToString:@"setOrientationProperties"] ||
-        [command isEqualToString:@"setResizeProperties"] ||
-        [command isEqualToString:@"storePicture"] ||
-        [command isEqualToString:@"useCustomClose"]
-        ) {
-        if ([command isEqualToString:@"createCalendarEvent"]) {
-            paramObj = [params valueForKey:@"eventJSON"];
-        } else if ([command isEqualToString:@"expand"] ||
-                   [command isEqualToString:@"open"] ||
-                   [command isEqualToString:@"playVideo"] ||
-                   [command isEqualToString:@"sendSMS"] ||
-                   [command isEqualToString:@"callNumber"] ||
-                   [command isEqualToString:@"storePicture"]) {
-            paramObj = [params valueForKey:@"url"];
-        } else if ([command isEqualToString:@"setOrientationProperties"] ||
-                   [command isEqualToString:@"setResizeProperties"]) {
-            paramObj = params;
-        } else if ([command isEqualToString:@"useCustomClose"]) {
-            paramObj = [params valueForKey:@"useCustomClose"];
+    // Check for valid parameters for the given command.
+    for (const char *const *parameter = entry->requiredParameters; *parameter; parameter++) {
+        if (!params[@(*parameter)]) {
+            [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"command URL %@ is missing parameters", commandUrl]];
+            return nil;
         }
-        command = [command stringByAppendingString:@":"];
-    }
-
-    NSMutableDictionary *commandDict = [@{@"command" : command} mutableCopy];
-    if (paramObj) {
-        commandDict[@"paramObj"] = paramObj;
     }
-    return commandDict;
-}
-
-- (BOOL)isValidCommand:(NSString *)command {
-    NSArray *kCommands = @[
-                           @"createCalendarEvent",
-                           @"close",
-                           @"expand",
-                           @"open",
-                           @"playVideo",
-                           @"sendSMS",
-                           @"callNumber",
-                           @"resize",
-                           @"setOrientationProperties",
-                           @"setResizeProperties",
-                           @"storePicture",
-                           @"useCustomClose"
-                           ];
-
-    return [kCommands containsObject:command];
-}
-
-- (BOOL)checkParamsForCommand:(NSString *)command params:(NSDictionary *)params; {
-    if ([command isEqualToString:@"createCalendarEvent"]) {
-        return ([params valueForKey:@"eventJSON"] != nil);
-    } else if ([command isEqualToString:@"open"] || [command isEqualToString:@"playVideo"] || [command isEqualToString:@"storePicture"] || [command isEqualToString:@"sendSMS"] || [command isEqualToString:@"callNumber"]) {
-        return ([params valueForKey:@"url"] != nil);
-    } else if ([command isEqualToString:@"setOrientationProperties"]) {
-        return (
-                [params valueForKey:@"allowOrientationChange"] != nil &&
-                [params valueForKey:@"forceOrientation"] != nil
-                );
-    } else if ([command isEqualToString:@"setResizeProperties"]) {
-        return (
-                [params valueForKey:@"width"] != nil &&
-                [params valueForKey:@"height"] != nil &&
-                [params valueForKey:@"offsetX"] != nil &&
-                [params valueForKey:@"offsetY"] != nil &&
-                [params valueForKey:@"customClosePosition"] != nil &&
-                [params valueForKey:@"allowOffscreen"] != nil
-                );
-    } else if ([command isEqualToString:@"useCustomClose"]) {
-        return ([params valueForKey:@"useCustomClose"] != nil);
+    
+    PNLiteMRAIDCommand *command = [[PNLiteMRAIDCommand alloc] init];
+    command.type = type;
+    switch (entry->extraction) {
+        case PNLiteMRAIDParameterExtractionNone:
+            break;
+        case PNLiteMRAIDParameterExtractionValue:
+        case PNLiteMRAIDParameterExtractionTrailingValue:
+            command.parameter = params[@(entry->valueParameter)];
+            break;
+        case PNLiteMRAIDParameterExtractionDictionary:
+            command.parameter = params;
+            break;
     }
-    return YES;
+    return command;
 }
 
 @end
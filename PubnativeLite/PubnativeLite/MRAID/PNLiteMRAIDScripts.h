@@ -0,0 +1,44 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import <WebKit/WebKit.h>
+
+/**
+ Process wide WebKit state shared by every MRAID web view: mraid.js is decoded once and registered as a
+ document start user script, so no web view carries its own copy or has to inject it after loading.
+ Must be used on the main thread.
+ */
+@interface PNLiteMRAIDScripts : NSObject
+
+@property (nonatomic, readonly) WKProcessPool *processPool;
+@property (nonatomic, readonly) WKUserContentController *userContentController;
+@property (nonatomic, readonly) WKUserScript *mraidUserScript;
+
++ (instancetype)sharedInstance;
+
+/**
+ New configuration sharing the process pool and the user scripts, media playback is left to the caller.
+ */
+- (WKWebViewConfiguration *)configuration;
+
+@end
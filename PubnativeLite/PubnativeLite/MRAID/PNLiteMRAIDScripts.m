@@ -0,0 +1,90 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteMRAIDScripts.h"
+#import "HyBidLogger.h"
+#import "HyBidViewabilityManager.h"
+
+#import "PNLitemraidjs.h"
+
+@interface PNLiteMRAIDScripts ()
+
+@property (nonatomic, strong) WKProcessPool *processPool;
+@property (nonatomic, strong) WKUserContentController *userContentController;
+@property (nonatomic, strong) WKUserScript *mraidUserScript;
+
+@end
+
+@implementation PNLiteMRAIDScripts
+
+- (void)dealloc {
+    self.processPool = nil;
+    self.userContentController = nil;
+    self.mraidUserScript = nil;
+}
+
++ (instancetype)sharedInstance {
+    static PNLiteMRAIDScripts *instance;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[PNLiteMRAIDScripts alloc] init];
+    });
+    return instance;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        self.processPool = [[WKProcessPool alloc] init];
+        self.userContentController = [[WKUserContentController alloc] init];
+        
+        // The embedded bytes live for the whole process, so the string can point at them instead of copying
+        NSString *mraidjs = [[NSString alloc] initWithBytesNoCopy:__PNLite_MRAID_mraid_js
+                                                           length:__PNLite_MRAID_mraid_js_len
+                                                         encoding:NSUTF8StringEncoding
+                                                     freeWhenDone:NO];
+        if (mraidjs) {
+            self.mraidUserScript = [[WKUserScript alloc] initWithSource:mraidjs
+                                                          injectionTime:WKUserScriptInjectionTimeAtDocumentStart
+                                                       forMainFrameOnly:YES];
+            [self.userContentController addUserScript:self.mraidUserScript];
+        } else {
+            [HyBidLogger errorLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:@"Embedded mraid.js is not valid UTF-8, MRAID ads won't be able to run."];
+        }
+        /*
+        WKUserScript *omSDKUserScript = [[HyBidViewabilityManager sharedInstance] getOMIDUserScript];
+        if (omSDKUserScript) {
+            [self.userContentController addUserScript:omSDKUserScript];
+        }
+        */
+    }
+    return self;
+}
+
+- (WKWebViewConfiguration *)configuration {
+    WKWebViewConfiguration *configuration = [[WKWebViewConfiguration alloc] init];
+    configuration.processPool = self.processPool;
+    configuration.userContentController = self.userContentController;
+    return configuration;
+}
+
+@end
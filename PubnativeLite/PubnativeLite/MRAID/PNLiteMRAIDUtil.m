@@ -22,89 +22,232 @@
 
 #import "PNLiteMRAIDUtil.h"
 
+// Injected right after the opening head tag, the leading newline matches the layout of the rest of the document
+static NSString *const PNLiteMRAIDUtilHeadContent =
+@"\n<meta name='viewport' content='width=device-width, initial-scale=1.0, minimum-scale=1.0, maximum-scale=1.0, user-scalable=no' />\n"
+"<style>\n"
+"body { margin:0; padding:0; }\n"
+"*:not(input) { -webkit-touch-callout:none; -webkit-user-select:none; -webkit-text-size-adjust:none; }\n"
+"</style>";
+
+static NSString *const PNLiteMRAIDUtilFragmentPrefix = @"<html>\n<head>%@\n</head>\n<body>\n<div align='center'>\n";
+static NSString *const PNLiteMRAIDUtilFragmentSuffix = @"</div>\n</body>\n</html>";
+static NSString *const PNLiteMRAIDUtilMissingHead = @"\n<head>%@\n</head>";
+
+// What a single pass over the creative finds: the mraid.js script tags to drop and where the head content goes
+typedef struct {
+    BOOL hasHtmlTag;
+    BOOL hasHeadTag;
+    BOOL hasBodyTag;
+    NSUInteger htmlTagEnd;
+    NSUInteger headTagEnd;
+    NSRange *removals;
+    NSUInteger removalCount;
+    NSUInteger removalCapacity;
+} PNLiteMRAIDHtmlScan;
+
+static BOOL PNLiteMRAIDIsSpace(unichar c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static BOOL PNLiteMRAIDIsWordCharacter(unichar c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Case insensitive match of a lowercase ASCII literal at the index
+static BOOL PNLiteMRAIDMatches(const unichar *chars, NSUInteger length, NSUInteger index, const char *literal) {
+    for (; *literal; literal++, index++) {
+        if (index >= length) {
+            return NO;
+        }
+        unichar c = chars[index];
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        if (c != (unichar)*literal) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+static NSUInteger PNLiteMRAIDFind(const unichar *chars, NSUInteger length, NSUInteger index, unichar c) {
+    for (; index < length; index++) {
+        if (chars[index] == c) {
+            return index;
+        }
+    }
+    return NSNotFound;
+}
+
+static NSUInteger PNLiteMRAIDSkipSpaces(const unichar *chars, NSUInteger length, NSUInteger index) {
+    while (index < length && PNLiteMRAIDIsSpace(chars[index])) {
+        index++;
+    }
+    return index;
+}
+
+/**
+ End of a <script src='mraid.js'></script> tag starting at the index, including the newlines after it, or NSNotFound.
+ Accepts extra attributes, whitespace and either quote, the same as the pattern this replaced:
+ <script\s+[^>]*\bsrc\s*=\s*(["'])mraid\.js\1[^>]*>\s*</script>\n*
+ */
+static NSUInteger PNLiteMRAIDScriptTagEnd(const unichar *chars, NSUInteger length, NSUInteger index) {
+    NSUInteger position = index + 7;
+    if (!PNLiteMRAIDMatches(chars, length, index, "<script") || position >= length || !PNLiteMRAIDIsSpace(chars[position])) {
+        return NSNotFound;
+    }
+    NSUInteger tagEnd = PNLiteMRAIDFind(chars, length, position, '>');
+    if (tagEnd == NSNotFound) {
+        return NSNotFound;
+    }
+    BOOL hasMRAIDSource = NO;
+    for (NSUInteger attribute = position + 1; attribute < tagEnd && !hasMRAIDSource; attribute++) {
+        if (PNLiteMRAIDIsWordCharacter(chars[attribute - 1]) || !PNLiteMRAIDMatches(chars, tagEnd, attribute, "src")) {
+            continue;
+        }
+        NSUInteger value = PNLiteMRAIDSkipSpaces(chars, tagEnd, attribute + 3);
+        if (value >= tagEnd || chars[value] != '=') {
+            continue;
+        }
+        value = PNLiteMRAIDSkipSpaces(chars, tagEnd, value + 1);
+        if (value >= tagEnd || (chars[value] != '"' && chars[value] != '\'')) {
+            continue;
+        }
+        hasMRAIDSource = PNLiteMRAIDMatches(chars, tagEnd, value + 1, "mraid.js") && value + 9 < tagEnd && chars[value + 9] == chars[value];
+    }
+    if (!hasMRAIDSource) {
+        return NSNotFound;
+    }
+    position = PNLiteMRAIDSkipSpaces(chars, length, tagEnd + 1);
+    if (!PNLiteMRAIDMatches(chars, length, position, "</script>")) {
+        return NSNotFound;
+    }
+    position += 9;
+    while (position < length && chars[position] == '\n') {
+        position++;
+    }
+    return position;
+}
+
+// Opening tag with exactly this name at the index, so <header> doesn't count as <head>
+static BOOL PNLiteMRAIDIsTag(const unichar *chars, NSUInteger length, NSUInteger index, const char *name) {
+    if (!PNLiteMRAIDMatches(chars, length, index + 1, name)) {
+        return NO;
+    }
+    NSUInteger end = index + 1 + strlen(name);
+    return end == length || PNLiteMRAIDIsSpace(chars[end]) || chars[end] == '>' || chars[end] == '/';
+}
+
+static NSUInteger PNLiteMRAIDTagEnd(const unichar *chars, NSUInteger length, NSUInteger index) {
+    NSUInteger end = PNLiteMRAIDFind(chars, length, index, '>');
+    return end == NSNotFound ? NSNotFound : end + 1;
+}
+
+static BOOL PNLiteMRAIDScanHtml(const unichar *chars, NSUInteger length, PNLiteMRAIDHtmlScan *scan) {
+    scan->htmlTagEnd = NSNotFound;
+    scan->headTagEnd = NSNotFound;
+    for (NSUInteger index = PNLiteMRAIDFind(chars, length, 0, '<'); index != NSNotFound; index = PNLiteMRAIDFind(chars, length, index + 1, '<')) {
+        NSUInteger scriptEnd = PNLiteMRAIDScriptTagEnd(chars, length, index);
+        if (scriptEnd != NSNotFound) {
+            if (scan->removalCount == scan->removalCapacity) {
+                NSUInteger capacity = scan->removalCapacity ? scan->removalCapacity * 2 : 4;
+                NSRange *removals = realloc(scan->removals, capacity * sizeof(NSRange));
+                if (!removals) {
+                    return NO;
+                }
+                scan->removals = removals;
+                scan->removalCapacity = capacity;
+            }
+            scan->removals[scan->removalCount++] = NSMakeRange(index, scriptEnd - index);
+            index = scriptEnd - 1;
+        } else if (!scan->hasHtmlTag && PNLiteMRAIDIsTag(chars, length, index, "html")) {
+            scan->hasHtmlTag = YES;
+            scan->htmlTagEnd = PNLiteMRAIDTagEnd(chars, length, index);
+        } else if (!scan->hasHeadTag && PNLiteMRAIDIsTag(chars, length, index, "head")) {
+            scan->hasHeadTag = YES;
+            scan->headTagEnd = PNLiteMRAIDTagEnd(chars, length, index);
+        } else if (!scan->hasBodyTag && PNLiteMRAIDIsTag(chars, length, index, "body")) {
+            scan->hasBodyTag = YES;
+        }
+    }
+    return YES;
+}
+
+static NSUInteger PNLiteMRAIDAppendString(unichar *output, NSUInteger position, NSString *string) {
+    [string getCharacters:output + position range:NSMakeRange(0, string.length)];
+    return position + string.length;
+}
+
 @implementation PNLiteMRAIDUtil
 
 + (NSString *)processRawHtml:(NSString *)rawHtml {
-    NSString *processedHtml = rawHtml;
-    NSRange range;
-    
-    // Remove the mraid.js script tag.
-    // We expect the tag to look like this:
-    // <script src='mraid.js'></script>
-    // But we should also be to handle additional attributes and whitespace like this:
-    // <script  type = 'text/javascript'  src = 'mraid.js' > </script>
-    
-    NSString *pattern = @"<script\\s+[^>]*\\bsrc\\s*=\\s*([\\\"\\\'])mraid\\.js\\1[^>]*>\\s*</script>\\n*";
-    NSError *error = NULL;
-    
-    NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:pattern
-                                                                           options:NSRegularExpressionCaseInsensitive
-                                                                             error:&error];
-    processedHtml = [regex stringByReplacingMatchesInString:processedHtml
-                                                    options:0
-                                                      range:NSMakeRange(0, [processedHtml length])
-                                               withTemplate:@""];
-    
-    // Add html, head, and/or body tags as needed.
-    range = [rawHtml rangeOfString:@"<html"];
-    BOOL hasHtmlTag = (range.location != NSNotFound);
-    range = [rawHtml rangeOfString:@"<head"];
-    BOOL hasHeadTag = (range.location != NSNotFound);
-    range = [rawHtml rangeOfString:@"<body"];
-    BOOL hasBodyTag = (range.location != NSNotFound);
-    
-    // basic sanity checks
-    if ((!hasHtmlTag && (hasHeadTag || hasBodyTag)) ||
-        (hasHtmlTag && !hasBodyTag)) {
+    if (!rawHtml) {
         return nil;
     }
-    
-    if (!hasHtmlTag) {
-        processedHtml = [NSString stringWithFormat:
-                         @"<html>\n"
-                         "<head>\n"
-                         "</head>\n"
-                         "<body>\n"
-                         "<div align='center'>\n"
-                         "%@"
-                         "</div>\n"
-                         "</body>\n"
-                         "</html>",
-                         processedHtml
-                         ];
-    } else if (!hasHeadTag) {
-        // html tag exists, head tag doesn't, so add it
-        pattern = @"<html[^>]*>";
-        error = NULL;
-        regex = [NSRegularExpression regularExpressionWithPattern:pattern
-                                                          options:NSRegularExpressionCaseInsensitive
-                                                            error:&error];
-        processedHtml = [regex stringByReplacingMatchesInString:processedHtml
-                                                        options:0
-                                                          range:NSMakeRange(0, [processedHtml length])
-                                                   withTemplate:@"$0\n<head>\n</head>"];
+    NSUInteger length = rawHtml.length;
+    const unichar *chars = CFStringGetCharactersPtr((__bridge CFStringRef)rawHtml);
+    unichar *copiedChars = NULL;
+    if (!chars) {
+        copiedChars = malloc(MAX(length, 1) * sizeof(unichar));
+        if (!copiedChars) {
+            return nil;
+        }
+        [rawHtml getCharacters:copiedChars range:NSMakeRange(0, length)];
+        chars = copiedChars;
     }
     
-    // Add meta and style tags to head tag.
-    NSString *metaTag =
-    @"<meta name='viewport' content='width=device-width, initial-scale=1.0, minimum-scale=1.0, maximum-scale=1.0, user-scalable=no' />";
-    
-    NSString *styleTag =
-    @"<style>\n"
-    "body { margin:0; padding:0; }\n"
-    "*:not(input) { -webkit-touch-callout:none; -webkit-user-select:none; -webkit-text-size-adjust:none; }\n"
-    "</style>";
-    
-    pattern = @"<head[^>]*>";
-    error = NULL;
-    regex = [NSRegularExpression regularExpressionWithPattern:pattern
-                                                      options:NSRegularExpressionCaseInsensitive
-                                                        error:&error];
-    processedHtml = [regex stringByReplacingMatchesInString:processedHtml
-                                                    options:0
-                                                      range:NSMakeRange(0, [processedHtml length])
-                                               withTemplate:[NSString stringWithFormat:@"$0\n%@\n%@", metaTag, styleTag]];
-    
+    PNLiteMRAIDHtmlScan scan = {0};
+    NSString *processedHtml = nil;
+    // basic sanity checks
+    if (PNLiteMRAIDScanHtml(chars, length, &scan) &&
+        !((!scan.hasHtmlTag && (scan.hasHeadTag || scan.hasBodyTag)) || (scan.hasHtmlTag && !scan.hasBodyTag))) {
+        // Add html, head, and/or body tags as needed, together with the meta and style tags.
+        NSString *prefix = @"";
+        NSString *suffix = @"";
+        NSString *insertion = @"";
+        NSUInteger insertionIndex = NSNotFound;
+        if (!scan.hasHtmlTag) {
+            prefix = [NSString stringWithFormat:PNLiteMRAIDUtilFragmentPrefix, PNLiteMRAIDUtilHeadContent];
+            suffix = PNLiteMRAIDUtilFragmentSuffix;
+        } else if (!scan.hasHeadTag) {
+            insertion = [NSString stringWithFormat:PNLiteMRAIDUtilMissingHead, PNLiteMRAIDUtilHeadContent];
+            insertionIndex = scan.htmlTagEnd;
+        } else {
+            insertion = PNLiteMRAIDUtilHeadContent;
+            insertionIndex = scan.headTagEnd;
+        }
+        if (insertionIndex == NSNotFound) {
+            insertion = @"";
+        }
+        
+        NSUInteger removedLength = 0;
+        for (NSUInteger i = 0; i < scan.removalCount; i++) {
+            removedLength += scan.removals[i].length;
+        }
+        NSUInteger outputLength = length - removedLength + prefix.length + suffix.length + insertion.length;
+        unichar *output = malloc(MAX(outputLength, 1) * sizeof(unichar));
+        if (output) {
+            NSUInteger position = PNLiteMRAIDAppendString(output, 0, prefix);
+            NSUInteger copied = 0;
+            for (NSUInteger i = 0; i <= scan.removalCount; i++) {
+                NSUInteger segmentEnd = i < scan.removalCount ? scan.removals[i].location : length;
+                if (insertionIndex != NSNotFound && insertionIndex >= copied && insertionIndex <= segmentEnd) {
+                    memcpy(output + position, chars + copied, (insertionIndex - copied) * sizeof(unichar));
+                    position = PNLiteMRAIDAppendString(output, position + insertionIndex - copied, insertion);
+                    copied = insertionIndex;
+                    insertionIndex = NSNotFound;
+                }
+                memcpy(output + position, chars + copied, (segmentEnd - copied) * sizeof(unichar));
+                position += segmentEnd - copied;
+                copied = i < scan.removalCount ? NSMaxRange(scan.removals[i]) : length;
+            }
+            position = PNLiteMRAIDAppendString(output, position, suffix);
+            processedHtml = [[NSString alloc] initWithCharactersNoCopy:output length:position freeWhenDone:YES];
+        }
+    }
+    free(scan.removals);
+    free(copiedChars);
     return processedHtml;
 }
 
@@ -0,0 +1,63 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+#import <WebKit/WebKit.h>
+
+typedef NS_ENUM(NSUInteger, PNLiteMRAIDWebViewPoolFormat) {
+    PNLiteMRAIDWebViewPoolFormatBanner,
+    PNLiteMRAIDWebViewPoolFormatMRect,
+    PNLiteMRAIDWebViewPoolFormatLeaderboard,
+    PNLiteMRAIDWebViewPoolFormatInterstitial
+};
+
+/**
+ Warm MRAID web views, so a creative doesn't wait for WebKit to launch its content process before rendering.
+ Each format an app loads adds its own share of web views to the pool, which is refilled while the main run loop is
+ idle and emptied on memory warnings. Must be used on the main thread.
+ */
+@interface PNLiteMRAIDWebViewPool : NSObject
+
+@property (nonatomic, readonly) NSUInteger idleCount;
+
++ (instancetype)sharedInstance;
++ (PNLiteMRAIDWebViewPoolFormat)formatForSize:(CGSize)size isInterstitial:(BOOL)isInterstitial;
+
+/**
+ Starts warming web views for a format about to be loaded, while its ad request is still in flight.
+ */
+- (void)prewarmForFormat:(PNLiteMRAIDWebViewPoolFormat)format;
+
+/**
+ A warm web view when one is idle, otherwise a new one. Both allow inline media playback without a user action.
+ */
+- (WKWebView *)dequeueWebViewWithFrame:(CGRect)frame forFormat:(PNLiteMRAIDWebViewPoolFormat)format;
+
+/**
+ Stops and blanks the web view, keeping it for the next ad when the pool has room for it.
+ */
+- (void)recycleWebView:(WKWebView *)webView;
+
+- (void)removeAllIdleWebViews;
+
+@end
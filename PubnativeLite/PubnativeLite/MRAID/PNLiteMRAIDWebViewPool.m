@@ -0,0 +1,219 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteMRAIDWebViewPool.h"
+#import "PNLiteMRAIDScripts.h"
+#import "HyBidLogger.h"
+
+// Web views each format keeps warm once it has been used, banners refresh into a second view before the first goes
+static NSUInteger const PNLiteMRAIDWebViewPoolCapacity[] = {
+    [PNLiteMRAIDWebViewPoolFormatBanner] = 2,
+    [PNLiteMRAIDWebViewPoolFormatMRect] = 1,
+    [PNLiteMRAIDWebViewPoolFormatLeaderboard] = 1,
+    [PNLiteMRAIDWebViewPoolFormatInterstitial] = 1
+};
+static NSUInteger const PNLiteMRAIDWebViewPoolFormatCount = sizeof(PNLiteMRAIDWebViewPoolCapacity) / sizeof(PNLiteMRAIDWebViewPoolCapacity[0]);
+// A web view that rendered this many creatives is let go rather than recycled, so leaks in creatives don't pile up
+static NSUInteger const PNLiteMRAIDWebViewPoolMaxUses = 10;
+
+@interface PNLiteMRAIDWebViewPool ()
+
+@property (nonatomic, strong) NSMutableArray<WKWebView *> *idleWebViews;
+@property (nonatomic, strong) NSMapTable<WKWebView *, NSNumber *> *useCounts;
+@property (nonatomic, strong) NSMutableIndexSet *activeFormats;
+@property (nonatomic, assign) CFRunLoopObserverRef idleObserver;
+
+@end
+
+@implementation PNLiteMRAIDWebViewPool
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [self stopRefilling];
+    self.idleWebViews = nil;
+    self.useCounts = nil;
+    self.activeFormats = nil;
+}
+
++ (instancetype)sharedInstance {
+    static PNLiteMRAIDWebViewPool *instance;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[PNLiteMRAIDWebViewPool alloc] init];
+    });
+    return instance;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        self.idleWebViews = [NSMutableArray array];
+        self.useCounts = [NSMapTable weakToStrongObjectsMapTable];
+        self.activeFormats = [NSMutableIndexSet indexSet];
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(didReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
++ (PNLiteMRAIDWebViewPoolFormat)formatForSize:(CGSize)size isInterstitial:(BOOL)isInterstitial {
+    if (isInterstitial) {
+        return PNLiteMRAIDWebViewPoolFormatInterstitial;
+    } else if (size.width >= 728.0f) {
+        return PNLiteMRAIDWebViewPoolFormatLeaderboard;
+    } else if (size.height >= 250.0f) {
+        return PNLiteMRAIDWebViewPoolFormatMRect;
+    }
+    return PNLiteMRAIDWebViewPoolFormatBanner;
+}
+
+- (NSUInteger)idleCount {
+    return self.idleWebViews.count;
+}
+
+- (NSUInteger)capacity {
+    __block NSUInteger capacity = 0;
+    [self.activeFormats enumerateIndexesUsingBlock:^(NSUInteger format, BOOL *stop) {
+        capacity += PNLiteMRAIDWebViewPoolCapacity[format];
+    }];
+    return capacity;
+}
+
+- (void)prewarmForFormat:(PNLiteMRAIDWebViewPoolFormat)format {
+    if (format >= PNLiteMRAIDWebViewPoolFormatCount) {
+        return;
+    }
+    [self.activeFormats addIndex:format];
+    [self startRefilling];
+}
+
+- (WKWebView *)dequeueWebViewWithFrame:(CGRect)frame forFormat:(PNLiteMRAIDWebViewPoolFormat)format {
+    [self prewarmForFormat:format];
+    WKWebView *webView = self.idleWebViews.lastObject;
+    if (webView) {
+        [self.idleWebViews removeLastObject];
+        webView.frame = frame;
+    } else {
+        webView = [self createWebViewWithFrame:frame];
+    }
+    self.useCounts[webView] = @(self.useCounts[webView].unsignedIntegerValue + 1);
+    return webView;
+}
+
+- (void)recycleWebView:(WKWebView *)webView {
+    if (!webView || [self.idleWebViews containsObject:webView]) {
+        return;
+    }
+    [webView stopLoading];
+    webView.navigationDelegate = nil;
+    webView.UIDelegate = nil;
+    [webView removeFromSuperview];
+    
+    NSNumber *useCount = self.useCounts[webView];
+    if (!useCount || useCount.unsignedIntegerValue >= PNLiteMRAIDWebViewPoolMaxUses || self.idleWebViews.count >= [self capacity]) {
+        // Not one of ours, worn out or not needed, blank it so nothing of the creative keeps running until it goes
+        [webView loadHTMLString:@"" baseURL:nil];
+        [self.useCounts removeObjectForKey:webView];
+        return;
+    }
+    [self resetWebView:webView];
+    [self.idleWebViews addObject:webView];
+}
+
+- (void)removeAllIdleWebViews {
+    for (WKWebView *webView in self.idleWebViews) {
+        [webView stopLoading];
+        [self.useCounts removeObjectForKey:webView];
+    }
+    [self.idleWebViews removeAllObjects];
+}
+
+#pragma mark Web views
+
+- (WKWebView *)createWebViewWithFrame:(CGRect)frame {
+    WKWebViewConfiguration *configuration = [[PNLiteMRAIDScripts sharedInstance] configuration];
+    configuration.allowsInlineMediaPlayback = YES;
+    configuration.requiresUserActionForMediaPlayback = NO;
+    WKWebView *webView = [[WKWebView alloc] initWithFrame:frame configuration:configuration];
+    [self resetWebView:webView];
+    return webView;
+}
+
+- (void)resetWebView:(WKWebView *)webView {
+    webView.opaque = NO;
+    webView.scrollView.scrollEnabled = NO;
+    webView.transform = CGAffineTransformIdentity;
+    webView.alpha = 1.0f;
+    webView.hidden = NO;
+    // Loading a document is what launches the content process, and it replaces whatever the last creative left behind
+    [webView loadHTMLString:@"" baseURL:nil];
+}
+
+#pragma mark Refilling
+
+- (void)startRefilling {
+    if (self.idleObserver || self.idleWebViews.count >= [self capacity]) {
+        return;
+    }
+    __weak typeof(self) weakSelf = self;
+    // Default mode only, so web views aren't created while the user is scrolling
+    self.idleObserver = CFRunLoopObserverCreateWithHandler(kCFAllocatorDefault, kCFRunLoopBeforeWaiting, YES, 0, ^(CFRunLoopObserverRef observer, CFRunLoopActivity activity) {
+        [weakSelf refillOneWebView];
+    });
+    CFRunLoopAddObserver(CFRunLoopGetMain(), self.idleObserver, kCFRunLoopDefaultMode);
+}
+
+- (void)stopRefilling {
+    if (self.idleObserver) {
+        CFRunLoopObserverInvalidate(self.idleObserver);
+        CFRelease(self.idleObserver);
+        self.idleObserver = NULL;
+    }
+}
+
+- (void)refillOneWebView {
+    if (self.idleWebViews.count >= [self capacity]) {
+        [self stopRefilling];
+        return;
+    }
+    // One per idle pass, creating a web view takes long enough to be felt if several go in a row
+    WKWebView *webView = [self createWebViewWithFrame:[UIScreen mainScreen].bounds];
+    self.useCounts[webView] = @0;
+    [self.idleWebViews addObject:webView];
+    if (self.idleWebViews.count >= [self capacity]) {
+        [self stopRefilling];
+    }
+}
+
+#pragma mark Memory
+
+- (void)didReceiveMemoryWarning:(NSNotification *)notification {
+    [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Releasing %lu idle MRAID web views.", (unsigned long)self.idleWebViews.count]];
+    [self stopRefilling];
+    [self removeAllIdleWebViews];
+    // Warm again only once ads are being loaded again
+    [self.activeFormats removeAllIndexes];
+}
+
+@end
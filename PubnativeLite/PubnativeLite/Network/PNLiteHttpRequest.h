@@ -37,7 +37,25 @@
 @property (nonatomic, strong) NSDictionary *header;
 @property (nonatomic, strong) NSData *body;
 @property (nonatomic, assign) BOOL shouldRetry;
+/**
+ Request timeout in seconds, the default of 60 seconds is used when 0.
+ */
+@property (nonatomic, assign) NSTimeInterval timeout;
+/**
+ Response of the last finished request, so callers can read its headers.
+ */
+@property (nonatomic, readonly) NSHTTPURLResponse *response;
+
+/**
+ Session shared by every SDK request so connections to the same host are reused.
+ */
++ (NSURLSession *)sharedSession;
 
 - (void)startWithUrlString:(NSString *)urlString withMethod:(NSString *)method delegate:(NSObject<PNLiteHttpRequestDelegate>*)delegate;
 
+/**
+ Stops the request, the delegate isn't called anymore.
+ */
+- (void)cancel;
+
 @end
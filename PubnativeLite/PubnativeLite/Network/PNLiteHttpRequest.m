@@ -25,10 +25,12 @@
 #import "PNLiteCryptoUtils.h"
 #import "HyBidLogger.h"
 #import "HyBidWebBrowserUserAgentInfo.h"
+#import "PNLiteThroughputEstimator.h"
 
 NSTimeInterval const PNLiteHttpRequestDefaultTimeout = 60;
 NSURLRequestCachePolicy const PNLiteHttpRequestDefaultCachePolicy = NSURLRequestUseProtocolCachePolicy;
 NSInteger const MAX_RETRIES = 1;
+NSInteger const PNLiteHttpRequestMaxConnectionsPerHost = 6;
 
 @interface PNLiteHttpRequest ()
 
@@ -36,11 +38,52 @@ NSInteger const MAX_RETRIES = 1;
 @property (nonatomic, strong) NSString *urlString;
 @property (nonatomic, strong) NSString *method;
 @property (nonatomic, assign) NSInteger retryCount;
+@property (nonatomic, strong) NSURLSessionDataTask *task;
+@property (nonatomic, assign) BOOL isCancelled;
+@property (nonatomic, strong) NSHTTPURLResponse *response;
+
+@end
+
+@interface PNLiteHttpRequestMetricsCollector : NSObject <NSURLSessionTaskDelegate>
+
+@end
+
+@implementation PNLiteHttpRequestMetricsCollector
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didFinishCollectingMetrics:(NSURLSessionTaskMetrics *)metrics API_AVAILABLE(ios(10.0))
+{
+    // Only the body transfer is timed, queueing, DNS, TLS and server think time say nothing about bandwidth
+    NSURLSessionTaskTransactionMetrics *transaction = metrics.transactionMetrics.lastObject;
+    NSHTTPURLResponse *response = (NSHTTPURLResponse *)task.response;
+    if (task.error
+        || ![response isKindOfClass:[NSHTTPURLResponse class]]
+        || response.statusCode < 200 || response.statusCode >= 300
+        || transaction.resourceFetchType != NSURLSessionTaskMetricsResourceFetchTypeNetworkLoad
+        || !transaction.responseStartDate || !transaction.responseEndDate) {
+        return;
+    }
+    NSTimeInterval duration = [transaction.responseEndDate timeIntervalSinceDate:transaction.responseStartDate];
+    [[PNLiteThroughputEstimator sharedInstance] addSampleWithBytes:task.countOfBytesReceived duration:duration];
+}
 
 @end
 
 @implementation PNLiteHttpRequest
 
++ (NSURLSession *)sharedSession
+{
+    static NSURLSession *session;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+        configuration.HTTPMaximumConnectionsPerHost = PNLiteHttpRequestMaxConnectionsPerHost;
+        session = [NSURLSession sessionWithConfiguration:configuration
+                                                delegate:[[PNLiteHttpRequestMetricsCollector alloc] init]
+                                           delegateQueue:nil];
+    });
+    return session;
+}
+
 - (void)dealloc
 {
     self.delegate = nil;
@@ -48,6 +91,8 @@ NSInteger const MAX_RETRIES = 1;
     self.method = nil;
     self.header = nil;
     self.body = nil;
+    self.task = nil;
+    self.response = nil;
 }
 
 - (void)startWithUrlString:(NSString *)urlString withMethod:(NSString *)method delegate:(NSObject<PNLiteHttpRequestDelegate> *)delegate
@@ -75,6 +120,16 @@ NSInteger const MAX_RETRIES = 1;
     }
 }
 
+- (void)cancel
+{
+    @synchronized (self) {
+        self.isCancelled = YES;
+        [self.task cancel];
+        self.task = nil;
+        self.delegate = nil;
+    }
+}
+
 - (void)executeAsyncRequest
 {
     dispatch_async(dispatch_get_main_queue(), ^{
@@ -91,13 +146,15 @@ NSInteger const MAX_RETRIES = 1;
         NSString *message = [NSString stringWithFormat:@"URL cannot be parsed: %@", self.urlString];
         [self invokeFailWithMessage:message andAttemptRetry:NO];
     } else {
-        NSURLSession *session = [NSURLSession sharedSession];
-        session.configuration.HTTPAdditionalHeaders = @{@"User-Agent": HyBidWebBrowserUserAgentInfo.userAgent};
+        NSURLSession *session = [PNLiteHttpRequest sharedSession];
         NSMutableURLRequest *request = [[NSMutableURLRequest alloc] init];
         [request setURL:url];
         [request setCachePolicy:PNLiteHttpRequestDefaultCachePolicy];
-        [request setTimeoutInterval:PNLiteHttpRequestDefaultTimeout];
+        [request setTimeoutInterval:self.timeout > 0 ? self.timeout : PNLiteHttpRequestDefaultTimeout];
         [request setHTTPMethod:self.method];
+        if (HyBidWebBrowserUserAgentInfo.userAgent) {
+            [request setValue:HyBidWebBrowserUserAgentInfo.userAgent forHTTPHeaderField:@"User-Agent"];
+        }
         if (self.header && self.header.count > 0) {
             for (NSString *key in self.header) {
                 id value = self.header[key];
@@ -108,20 +165,36 @@ NSInteger const MAX_RETRIES = 1;
         if (self.body) {
             [request setHTTPBody:self.body];
             [request setValue:[NSString stringWithFormat:@"%lu",(unsigned long)[self.body length]] forHTTPHeaderField:@"Content-Length"];
-            [request setValue:[PNLiteCryptoUtils md5WithString:[[NSString alloc] initWithData:self.body encoding:NSUTF8StringEncoding]] forHTTPHeaderField:@"Content-MD5"];
+            [request setValue:[PNLiteCryptoUtils md5WithData:self.body] forHTTPHeaderField:@"Content-MD5"];
         }
     
-        [[session dataTaskWithRequest:request
-                    completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
-                        NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *)response;
-                        if (error) {
-                            [self invokeFailWithError:error andAttemptRetry:NO];
-                        } else {
-                            dispatch_async(dispatch_get_main_queue(), ^{
-                                [self invokeFinishWithData:data statusCode:httpResponse.statusCode];
-                            });
-                        }
-                    }] resume];
+        NSURLSessionDataTask *task = [session dataTaskWithRequest:request
+                                                completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+                                                    NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *)response;
+                                                    if (self.isCancelled) {
+                                                        return;
+                                                    }
+                                                    dispatch_async(dispatch_get_main_queue(), ^{
+                                                        // The request may have been cancelled while this block waited for the main queue
+                                                        if (self.isCancelled) {
+                                                            return;
+                                                        } else if (error) {
+                                                            [self invokeFailWithError:error andAttemptRetry:NO];
+                                                        } else {
+                                                            if ([httpResponse isKindOfClass:[NSHTTPURLResponse class]]) {
+                                                                self.response = httpResponse;
+                                                            }
+                                                            [self invokeFinishWithData:data statusCode:httpResponse.statusCode];
+                                                        }
+                                                    });
+                                                }];
+        @synchronized (self) {
+            if (self.isCancelled) {
+                return;
+            }
+            self.task = task;
+        }
+        [task resume];
     }
 }
 
@@ -0,0 +1,44 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ Running estimate of the download throughput seen by the SDK, used to pick media the network can keep up with.
+ */
+@interface PNLiteThroughputEstimator : NSObject
+
+/**
+ Exponentially weighted estimate in kilobits per second, 0 until enough has been downloaded.
+ */
+@property (nonatomic, readonly) double estimatedKbps;
+
++ (instancetype)sharedInstance;
+
+/**
+ Records a finished download. Transfers too small to say anything about bandwidth are ignored.
+ */
+- (void)addSampleWithBytes:(int64_t)bytes duration:(NSTimeInterval)duration;
+
+- (void)reset;
+
+@end
@@ -0,0 +1,73 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteThroughputEstimator.h"
+
+// Below this size a transfer is dominated by TCP slow start rather than bandwidth, which also keeps ad responses out
+int64_t const PNLiteThroughputEstimatorMinSampleBytes = 64 * 1024;
+// Weight of the newest sample, high enough to follow a network change within a few downloads
+double const PNLiteThroughputEstimatorSampleWeight = 0.3;
+
+@interface PNLiteThroughputEstimator ()
+
+@property (nonatomic, assign) double estimatedKbps;
+
+@end
+
+@implementation PNLiteThroughputEstimator
+
++ (instancetype)sharedInstance {
+    static PNLiteThroughputEstimator *instance;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[PNLiteThroughputEstimator alloc] init];
+    });
+    return instance;
+}
+
+- (void)addSampleWithBytes:(int64_t)bytes duration:(NSTimeInterval)duration {
+    if (bytes < PNLiteThroughputEstimatorMinSampleBytes || duration <= 0) {
+        return;
+    }
+    double kbps = (bytes * 8.0 / 1000.0) / duration;
+    @synchronized (self) {
+        if (self.estimatedKbps <= 0) {
+            self.estimatedKbps = kbps;
+        } else {
+            self.estimatedKbps = PNLiteThroughputEstimatorSampleWeight * kbps + (1 - PNLiteThroughputEstimatorSampleWeight) * self.estimatedKbps;
+        }
+    }
+}
+
+- (double)estimatedKbps {
+    @synchronized (self) {
+        return _estimatedKbps;
+    }
+}
+
+- (void)reset {
+    @synchronized (self) {
+        self.estimatedKbps = 0;
+    }
+}
+
+@end
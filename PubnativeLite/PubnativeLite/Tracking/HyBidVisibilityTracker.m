@@ -22,18 +22,15 @@
 
 #import "HyBidVisibilityTracker.h"
 #import "PNLiteVisibilityTrackerItem.h"
+#import "PNLiteVisibilityScheduler.h"
+#import "PNLiteVisibilityGeometry.h"
 #import "HyBidLogger.h"
 
-NSTimeInterval const PNLiteVisibilityTrackerPeriod = 0.1f; // 100ms
+@interface HyBidVisibilityTracker () <PNLiteVisibilitySchedulerObserver>
 
-@interface HyBidVisibilityTracker ()
-
-@property (nonatomic, assign) BOOL isVisibilityScheduled;
-@property (nonatomic, strong) NSMutableArray<PNLiteVisibilityTrackerItem *> *trackedItems;
-@property (nonatomic, strong) NSMutableArray<UIView *> *visibleViews;
-@property (nonatomic, strong) NSMutableArray<UIView *> *invisibleViews;
-@property (nonatomic, strong) NSMutableArray<PNLiteVisibilityTrackerItem *> *removedItems;
+@property (nonatomic, strong) NSMapTable<UIView *, PNLiteVisibilityTrackerItem *> *trackedItems;
 @property (nonatomic, assign) BOOL isValid;
+@property (nonatomic, assign) BOOL isEvaluating;
 
 @end
 
@@ -41,31 +38,33 @@ NSTimeInterval const PNLiteVisibilityTrackerPeriod = 0.1f; // 100ms
 
 - (void)dealloc {
     self.isValid = NO;
-    self.isVisibilityScheduled = NO;
+    [[PNLiteVisibilityScheduler sharedInstance] removeObserver:self];
     
     self.delegate = nil;
     [self.trackedItems removeAllObjects];
     self.trackedItems = nil;
-    [self.visibleViews removeAllObjects];
-    self.visibleViews = nil;
-    [self.invisibleViews removeAllObjects];
-    self.invisibleViews = nil;
-    [self.removedItems removeAllObjects];
-    self.removedItems = nil;
 }
 
 - (instancetype)init {
     self = [super init];
     if (self) {
         self.isValid = YES;
-        self.trackedItems = [NSMutableArray array];
-        self.visibleViews = [NSMutableArray array];
-        self.invisibleViews = [NSMutableArray array];
-        self.removedItems = [NSMutableArray array];
+        // Keyed weakly by the view, so lookups are O(1) and a deallocated view drops out on its own
+        self.trackedItems = [NSMapTable weakToStrongObjectsMapTable];
     }
     return self;
 }
 
++ (dispatch_queue_t)evaluationQueue {
+    static dispatch_queue_t queue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        dispatch_queue_attr_t attributes = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0);
+        queue = dispatch_queue_create("net.pubnative.hybid.visibility", attributes);
+    });
+    return queue;
+}
+
 - (void)addView:(UIView*)view withMinVisibility:(CGFloat)minVisibility {
     if(!view) {
         [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:@"View is nil and required, dropping this call."];
@@ -75,138 +74,121 @@ NSTimeInterval const PNLiteVisibilityTrackerPeriod = 0.1f; // 100ms
         PNLiteVisibilityTrackerItem *item = [[PNLiteVisibilityTrackerItem alloc] init];
         item.view = view;
         item.minVisibility = minVisibility;
-        [self.trackedItems addObject:item];
+        [self.trackedItems setObject:item forKey:view];
         [self scheduleVisibilityCheck];
     }
 }
 
 - (void)removeView:(UIView*)view {
-    
+    if (view) {
+        [self.trackedItems removeObjectForKey:view];
+    }
+    if (self.trackedItems.count == 0) {
+        [[PNLiteVisibilityScheduler sharedInstance] removeObserver:self];
+    }
 }
 
 - (void)clear {
     self.isValid = NO;
     [self.trackedItems removeAllObjects];
-    self.isVisibilityScheduled = NO;
+    [[PNLiteVisibilityScheduler sharedInstance] removeObserver:self];
 }
 
 #pragma mark Tracking Views
 
 - (BOOL)isTrackingView:(UIView*)view {
-    return [self indexOfView:view] >= 0;
-}
-
-- (NSInteger)indexOfView:(UIView*)view {
-    NSInteger result = -1;
-    for (int i = 0; i < self.trackedItems.count; i++) {
-        PNLiteVisibilityTrackerItem *item = self.trackedItems[i];
-        if (item != nil && view == item.view) {
-            result = i;
-            break;
-        }
-    }
-    return result;
+    return [self.trackedItems objectForKey:view] != nil;
 }
 
 #pragma mark Visibility Check
 
 - (void)scheduleVisibilityCheck {
-    if(self.isValid && !self.isVisibilityScheduled) {
-        self.isVisibilityScheduled = YES;
-        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, PNLiteVisibilityTrackerPeriod * NSEC_PER_SEC), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-            [self checkVisibility];
-        });
+    if(self.isValid) {
+        [[PNLiteVisibilityScheduler sharedInstance] addObserver:self];
     }
 }
 
-- (void)checkVisibility {
-    for (PNLiteVisibilityTrackerItem *item in self.trackedItems) {
-        // For safety we need to ensure that the view being tracked wasn't removed, in which case we stop tracking It
-        if (item != nil) {
-            if (!item.view || !item.view.superview) {
-                [self.removedItems addObject:item];
-            } else if (![self.removedItems containsObject:item]) {
-                if([self isVisibleView:item.view]
-                   && [self view:item.view visibleWithMinPercent:item.minVisibility]) {
-                    [self.visibleViews addObject:item.view];
-                } else {
-                    [self.invisibleViews addObject:item.view];
-                }
-            }
-        }
-    }
-    
-    // We clear up all removed views
-    for (PNLiteVisibilityTrackerItem *item in self.removedItems) {
-        
-        if(item != nil) {
-            [self.trackedItems removeObject:item];
-        }
-    }
-    [self.removedItems removeAllObjects];
-    
-    [self invokeCheckVisibiltyWithVisibleViews:self.visibleViews andWithInvisibleViews:self.invisibleViews];
-    [self.visibleViews removeAllObjects];
-    [self.invisibleViews removeAllObjects];
-    
-    self.isVisibilityScheduled = NO;
-    [self scheduleVisibilityCheck];
-}
-
-#pragma mark Visibility Helpers
+#pragma mark PNLiteVisibilitySchedulerObserver
 
-- (BOOL)isVisibleView:(UIView*)view {
-    return (!view.hidden
-            && ![self hasHiddenAncestorForView:view]
-            && [self inersectsParentViewOfView:view]);
+- (void)visibilitySchedulerDidTick:(PNLiteVisibilityScheduler *)scheduler {
+    [self checkVisibility];
 }
 
-- (BOOL)hasHiddenAncestorForView:(UIView*)view {
-    UIView *ancestor = view.superview;
-    while (ancestor) {
-        if (ancestor.hidden) return YES;
-        ancestor = ancestor.superview;
+- (void)checkVisibility {
+    if (self.isEvaluating) {
+        // The previous snapshot is still being evaluated, skip this tick rather than queue up work
+        return;
     }
-    return NO;
-}
-
-- (BOOL)inersectsParentViewOfView:(UIView*)view {
-    UIWindow *parentWindow = [self parentWindowForView:view];
     
-    if (!parentWindow) {
-        return NO;
+    // One pass on the main thread copies out everything UIKit-related...
+    NSMutableArray<PNLiteVisibilityTrackerItem *> *items = [NSMutableArray arrayWithCapacity:self.trackedItems.count];
+    for (UIView *view in self.trackedItems) {
+        PNLiteVisibilityTrackerItem *item = [self.trackedItems objectForKey:view];
+        if (item) {
+            [items addObject:item];
+        }
+    }
+    NSMutableData *snapshots = [NSMutableData dataWithLength:items.count * sizeof(PNLiteVisibilitySnapshot)];
+    PNLiteVisibilitySnapshot *buffer = snapshots.mutableBytes;
+    for (NSUInteger i = 0; i < items.count; i++) {
+        buffer[i] = [PNLiteVisibilityGeometry snapshotForView:items[i].view withMinVisibility:items[i].minVisibility];
     }
     
-    CGRect viewFrameInWindowCoordinates = [view.superview convertRect:view.frame toView:parentWindow];
-    return CGRectIntersectsRect(viewFrameInWindowCoordinates, parentWindow.frame);
+    // ...and the maths runs on the snapshot in the background
+    self.isEvaluating = YES;
+    __weak typeof(self) weakSelf = self;
+    dispatch_async([HyBidVisibilityTracker evaluationQueue], ^{
+        const PNLiteVisibilitySnapshot *results = snapshots.bytes;
+        NSMutableIndexSet *visibleIndexes = [NSMutableIndexSet indexSet];
+        NSMutableIndexSet *removedIndexes = [NSMutableIndexSet indexSet];
+        for (NSUInteger i = 0; i < items.count; i++) {
+            if (!results[i].isAttached) {
+                // For safety we need to ensure that the view being tracked wasn't removed, in which case we stop tracking It
+                [removedIndexes addIndex:i];
+            } else if ([PNLiteVisibilityGeometry isVisibleSnapshot:results[i]]) {
+                [visibleIndexes addIndex:i];
+            }
+        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [weakSelf finishCheckWithItems:items visibleIndexes:visibleIndexes removedIndexes:removedIndexes];
+        });
+    });
 }
 
-- (BOOL)view:(UIView*)view visibleWithMinPercent:(CGFloat)percentVisible {
-    UIWindow *parentWindow = [self parentWindowForView:view];
-    
-    if (!parentWindow) {
-        return NO;
+- (void)finishCheckWithItems:(NSArray<PNLiteVisibilityTrackerItem *> *)items
+              visibleIndexes:(NSIndexSet *)visibleIndexes
+              removedIndexes:(NSIndexSet *)removedIndexes {
+    self.isEvaluating = NO;
+    if (!self.isValid) {
+        return;
     }
     
-    // We need to call convertRect:toView: on this view's superview rather than on this view itself.
-    CGRect viewFrameInWindowCoordinates = [view.superview convertRect:view.frame toView:parentWindow];
-    CGRect intersection = CGRectIntersection(viewFrameInWindowCoordinates, parentWindow.frame);
+    NSMutableArray<UIView *> *visibleViews = [NSMutableArray array];
+    NSMutableArray<UIView *> *invisibleViews = [NSMutableArray array];
+    for (NSUInteger i = 0; i < items.count; i++) {
+        PNLiteVisibilityTrackerItem *item = items[i];
+        UIView *view = item.view;
+        if (!view || [self.trackedItems objectForKey:view] != item) {
+            // The view went away or was removed while the snapshot was being evaluated
+            continue;
+        } else if ([removedIndexes containsIndex:i]) {
+            // We clear up all removed views
+            [self.trackedItems removeObjectForKey:view];
+        } else {
+            if ([visibleIndexes containsIndex:i]) {
+                [visibleViews addObject:view];
+            } else {
+                [invisibleViews addObject:view];
+            }
+        }
+    }
     
-    CGFloat intersectionArea = CGRectGetWidth(intersection) * CGRectGetHeight(intersection);
-    CGFloat originalArea = CGRectGetWidth(view.bounds) * CGRectGetHeight(view.bounds);
+    [self invokeCheckVisibiltyWithVisibleViews:visibleViews andWithInvisibleViews:invisibleViews];
     
-    return intersectionArea >= (originalArea * percentVisible);
-}
-
-- (UIWindow*)parentWindowForView:(UIView*)view {
-    UIView *ancestor = view.superview;
-    while (ancestor) {
-        if ([ancestor isKindOfClass:[UIWindow class]]) {
-            return (UIWindow *)ancestor;
-        }
-        ancestor = ancestor.superview;
+    if (self.trackedItems.count == 0) {
+        // Nothing left to watch, let the shared scheduler go idle
+        [[PNLiteVisibilityScheduler sharedInstance] removeObserver:self];
     }
-    return nil;
 }
 
 #pragma mark Callback Helpers
@@ -0,0 +1,56 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+@class PNLiteBeaconBatcher;
+
+@protocol PNLiteBeaconBatcherDelegate <NSObject>
+
+- (void)batcher:(PNLiteBeaconBatcher *)batcher didFailToDeliverURLs:(NSArray<NSURL *> *)urls;
+
+@optional
+- (void)batcher:(PNLiteBeaconBatcher *)batcher didDeliverURLs:(NSArray<NSURL *> *)urls;
+
+@end
+
+@interface PNLiteBeaconBatcher : NSObject
+
+@property (nonatomic, weak) NSObject<PNLiteBeaconBatcherDelegate> *delegate;
+/**
+ YES while any URL is waiting for its batch window or for the batch POST to finish.
+ */
+@property (nonatomic, readonly) BOOL hasUndeliveredURLs;
+
+/**
+ URLs are persisted until their batch is delivered or handed back to the delegate.
+ Batches the ones a previous launch left undelivered, call it once the delegate is set.
+ */
+- (void)start;
+
+/**
+ Returns YES when the URL goes to a first-party host whose batch endpoint has not been rejected.
+ */
+- (BOOL)canBatchURL:(NSURL *)url;
+- (void)addURL:(NSURL *)url;
+
+@end
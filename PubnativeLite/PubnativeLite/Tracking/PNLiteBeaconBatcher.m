@@ -0,0 +1,262 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteBeaconBatcher.h"
+#import "PNLiteHttpRequest.h"
+#import "HyBidLogger.h"
+#import <zlib.h>
+
+NSString * const PNLiteBeaconBatcherQueueKey = @"PNLiteBeaconBatcher.queue.key";
+NSString * const PNLiteBeaconBatcherFirstPartyHost = @"got.pubnative.net";
+NSString * const PNLiteBeaconBatcherEndpointPath = @"/batch";
+NSTimeInterval const PNLiteBeaconBatcherWindow = 0.5;
+NSUInteger const PNLiteBeaconBatcherMaxBatchSize = 20;
+
+@interface PNLiteBeaconBatch : NSObject
+
+@property (nonatomic, strong) NSString *host;
+@property (nonatomic, strong) NSURL *endpointURL;
+@property (nonatomic, strong) NSMutableArray<NSURL *> *urls;
+
+@end
+
+@implementation PNLiteBeaconBatch
+
+- (void)dealloc {
+    self.host = nil;
+    self.endpointURL = nil;
+    self.urls = nil;
+}
+
+@end
+
+@interface PNLiteBeaconBatcher () <PNLiteHttpRequestDelegate>
+
+@property (nonatomic, strong) NSMutableDictionary<NSString *, PNLiteBeaconBatch *> *pendingBatches;
+@property (nonatomic, strong) NSMapTable<PNLiteHttpRequest *, PNLiteBeaconBatch *> *inFlightBatches;
+@property (nonatomic, strong) NSMutableSet<NSString *> *unavailableHosts;
+@property (nonatomic, strong) NSUserDefaults *userDefaults;
+
+@end
+
+@implementation PNLiteBeaconBatcher
+
+- (void)dealloc {
+    self.pendingBatches = nil;
+    self.inFlightBatches = nil;
+    self.unavailableHosts = nil;
+    self.userDefaults = nil;
+}
+
+- (instancetype)init {
+    return [self initWithUserDefaults:[NSUserDefaults standardUserDefaults]];
+}
+
+- (instancetype)initWithUserDefaults:(NSUserDefaults *)userDefaults {
+    self = [super init];
+    if (self) {
+        self.userDefaults = userDefaults;
+        self.pendingBatches = [NSMutableDictionary dictionary];
+        self.inFlightBatches = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                                     valueOptions:NSPointerFunctionsStrongMemory];
+        self.unavailableHosts = [NSMutableSet set];
+    }
+    return self;
+}
+
+- (void)start {
+    NSArray<NSString *> *undelivered = [self.userDefaults objectForKey:PNLiteBeaconBatcherQueueKey];
+    [self.userDefaults removeObjectForKey:PNLiteBeaconBatcherQueueKey];
+    for (NSString *urlString in undelivered) {
+        NSURL *url = [NSURL URLWithString:urlString];
+        if (url) {
+            [self addURL:url];
+        }
+    }
+}
+
+- (BOOL)hasUndeliveredURLs {
+    return self.pendingBatches.count > 0 || self.inFlightBatches.count > 0;
+}
+
+- (BOOL)canBatchURL:(NSURL *)url {
+    NSString *host = url.host.lowercaseString;
+    return [host isEqualToString:PNLiteBeaconBatcherFirstPartyHost] && ![self.unavailableHosts containsObject:host];
+}
+
+- (void)addURL:(NSURL *)url {
+    NSString *host = url.host.lowercaseString;
+    PNLiteBeaconBatch *batch = self.pendingBatches[host];
+    if (!batch) {
+        batch = [[PNLiteBeaconBatch alloc] init];
+        batch.host = host;
+        NSURLComponents *components = [[NSURLComponents alloc] init];
+        components.scheme = url.scheme;
+        components.host = url.host;
+        components.port = url.port;
+        components.path = PNLiteBeaconBatcherEndpointPath;
+        batch.endpointURL = components.URL;
+        batch.urls = [NSMutableArray array];
+        self.pendingBatches[host] = batch;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(PNLiteBeaconBatcherWindow * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+            [self flushBatch:batch];
+        });
+    }
+    [batch.urls addObject:url];
+    [self persistURL:url];
+    if (batch.urls.count >= PNLiteBeaconBatcherMaxBatchSize) {
+        [self flushBatch:batch];
+    }
+}
+
+- (void)flushBatch:(PNLiteBeaconBatch *)batch {
+    if (self.pendingBatches[batch.host] != batch) {
+        // Already flushed because it filled up before the window closed
+        return;
+    }
+    [self.pendingBatches removeObjectForKey:batch.host];
+    
+    if (batch.urls.count == 1) {
+        // Nothing to combine, a plain GET is cheaper than a POST
+        [self invokeDidFailToDeliverURLs:batch.urls];
+        return;
+    }
+    
+    NSMutableArray *urlStrings = [NSMutableArray arrayWithCapacity:batch.urls.count];
+    for (NSURL *url in batch.urls) {
+        [urlStrings addObject:url.absoluteString];
+    }
+    NSData *json = [NSJSONSerialization dataWithJSONObject:@{@"beacons" : urlStrings} options:0 error:nil];
+    NSData *body = [self gzipData:json];
+    if (!body) {
+        [self invokeDidFailToDeliverURLs:batch.urls];
+        return;
+    }
+    
+    [self sendBatch:batch withBody:body];
+}
+
+- (void)sendBatch:(PNLiteBeaconBatch *)batch withBody:(NSData *)body {
+    PNLiteHttpRequest *request = [[PNLiteHttpRequest alloc] init];
+    request.header = @{@"Content-Type" : @"application/json",
+                       @"Content-Encoding" : @"gzip"};
+    request.body = body;
+    [self.inFlightBatches setObject:batch forKey:request];
+    [request startWithUrlString:batch.endpointURL.absoluteString withMethod:@"POST" delegate:self];
+}
+
+- (NSData *)gzipData:(NSData *)data {
+    if (data.length == 0) {
+        return nil;
+    }
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // windowBits 15 + 16 selects the gzip wrapper instead of raw zlib
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return nil;
+    }
+    NSMutableData *result = [NSMutableData dataWithLength:deflateBound(&stream, (uLong)data.length)];
+    stream.next_in = (Bytef *)data.bytes;
+    stream.avail_in = (uInt)data.length;
+    stream.next_out = result.mutableBytes;
+    stream.avail_out = (uInt)result.length;
+    int status = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    if (status != Z_STREAM_END) {
+        return nil;
+    }
+    result.length = stream.total_out;
+    return result;
+}
+
+#pragma mark Persistence
+
+- (void)persistURL:(NSURL *)url {
+    NSMutableArray<NSString *> *queue = [[self.userDefaults objectForKey:PNLiteBeaconBatcherQueueKey] mutableCopy] ?: [NSMutableArray array];
+    [queue addObject:url.absoluteString];
+    [self.userDefaults setObject:queue forKey:PNLiteBeaconBatcherQueueKey];
+}
+
+- (void)forgetURLs:(NSArray<NSURL *> *)urls {
+    NSMutableArray<NSString *> *queue = [[self.userDefaults objectForKey:PNLiteBeaconBatcherQueueKey] mutableCopy];
+    for (NSURL *url in urls) {
+        // One entry per URL, the same beacon may be waiting in another batch
+        NSUInteger index = [queue indexOfObject:url.absoluteString];
+        if (index != NSNotFound) {
+            [queue removeObjectAtIndex:index];
+        }
+    }
+    if (queue.count > 0) {
+        [self.userDefaults setObject:queue forKey:PNLiteBeaconBatcherQueueKey];
+    } else {
+        [self.userDefaults removeObjectForKey:PNLiteBeaconBatcherQueueKey];
+    }
+}
+
+- (void)invokeDidFailToDeliverURLs:(NSArray<NSURL *> *)urls {
+    if (self.delegate && [self.delegate respondsToSelector:@selector(batcher:didFailToDeliverURLs:)]) {
+        [self.delegate batcher:self didFailToDeliverURLs:urls];
+    }
+    // Only forgotten once the delegate has queued them, so a crash in between can't lose them
+    [self forgetURLs:urls];
+}
+
+- (void)invokeDidDeliverURLs:(NSArray<NSURL *> *)urls {
+    [self forgetURLs:urls];
+    if (self.delegate && [self.delegate respondsToSelector:@selector(batcher:didDeliverURLs:)]) {
+        [self.delegate batcher:self didDeliverURLs:urls];
+    }
+}
+
+- (void)finishBatchWithRequest:(PNLiteHttpRequest *)request delivered:(BOOL)delivered endpointAvailable:(BOOL)endpointAvailable {
+    PNLiteBeaconBatch *batch = [self.inFlightBatches objectForKey:request];
+    if (batch) {
+        [self.inFlightBatches removeObjectForKey:request];
+        if (!endpointAvailable) {
+            [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Batch endpoint is not available for host %@, falling back to individual requests.", batch.host]];
+            [self.unavailableHosts addObject:batch.host];
+        }
+        if (delivered) {
+            [self invokeDidDeliverURLs:batch.urls];
+        } else {
+            [self invokeDidFailToDeliverURLs:batch.urls];
+        }
+    }
+}
+
+#pragma mark PNLiteHttpRequestDelegate
+
+- (void)request:(PNLiteHttpRequest *)request didFinishWithData:(NSData *)data statusCode:(NSInteger)statusCode {
+    dispatch_async(dispatch_get_main_queue(), ^{
+        BOOL delivered = statusCode >= 200 && statusCode < 300;
+        BOOL endpointAvailable = statusCode != 404 && statusCode != 405 && statusCode != 501;
+        [self finishBatchWithRequest:request delivered:delivered endpointAvailable:endpointAvailable];
+    });
+}
+
+- (void)request:(PNLiteHttpRequest *)request didFailWithError:(NSError *)error {
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self finishBatchWithRequest:request delivered:NO endpointAvailable:YES];
+    });
+}
+
+@end
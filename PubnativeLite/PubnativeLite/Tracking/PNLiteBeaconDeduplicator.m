@@ -0,0 +1,116 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteBeaconDeduplicator.h"
+#import "PNLiteCryptoUtils.h"
+#import "HyBidLogger.h"
+
+NSString * const PNLiteBeaconDeduplicatorKey = @"PNLiteBeaconDeduplicator.firedBeacons.key";
+NSTimeInterval const PNLiteBeaconDeduplicatorValidTime = 1800;
+NSUInteger const PNLiteBeaconDeduplicatorCapacity = 1024;
+
+@interface PNLiteBeaconDeduplicator ()
+
+// Beacon hash -> wall-clock time it fired
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *firedBeacons;
+@property (nonatomic, strong) NSUserDefaults *userDefaults;
+
+@end
+
+@implementation PNLiteBeaconDeduplicator
+
+- (void)dealloc {
+    self.firedBeacons = nil;
+    self.userDefaults = nil;
+}
+
+- (instancetype)init {
+    return [self initWithUserDefaults:[NSUserDefaults standardUserDefaults]];
+}
+
+- (instancetype)initWithUserDefaults:(NSUserDefaults *)userDefaults {
+    self = [super init];
+    if (self) {
+        self.userDefaults = userDefaults;
+        NSDictionary *persisted = [userDefaults objectForKey:PNLiteBeaconDeduplicatorKey];
+        self.firedBeacons = persisted ? [persisted mutableCopy] : [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
++ (instancetype)sharedInstance {
+    static PNLiteBeaconDeduplicator *instance;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[PNLiteBeaconDeduplicator alloc] init];
+    });
+    return instance;
+}
+
+- (BOOL)registerBeaconWithURL:(NSString *)url forAdIdentifier:(NSString *)adIdentifier {
+    return [self registerBeaconWithURL:url forAdIdentifier:adIdentifier atTime:[[NSDate date] timeIntervalSince1970]];
+}
+
+- (BOOL)registerBeaconWithURL:(NSString *)url forAdIdentifier:(NSString *)adIdentifier atTime:(NSTimeInterval)now {
+    if (!url || url.length == 0 || !adIdentifier || adIdentifier.length == 0) {
+        // Without an ad instance the same URL may legitimately belong to another ad
+        return YES;
+    }
+    NSString *key = [PNLiteCryptoUtils md5WithString:[NSString stringWithFormat:@"%@|%@", adIdentifier, url]];
+    BOOL result = YES;
+    @synchronized (self) {
+        NSNumber *firedAt = self.firedBeacons[key];
+        if (firedAt && now - [firedAt doubleValue] < PNLiteBeaconDeduplicatorValidTime) {
+            result = NO;
+        } else {
+            self.firedBeacons[key] = @(now);
+            [self trimWithCurrentTime:now];
+            [self.userDefaults setObject:self.firedBeacons forKey:PNLiteBeaconDeduplicatorKey];
+        }
+    }
+    if (!result) {
+        [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Beacon already fired, dropping duplicate: %@", url]];
+    }
+    return result;
+}
+
+- (void)trimWithCurrentTime:(NSTimeInterval)now {
+    if (self.firedBeacons.count <= PNLiteBeaconDeduplicatorCapacity) {
+        return;
+    }
+    NSMutableArray *expiredKeys = [NSMutableArray array];
+    [self.firedBeacons enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSNumber *firedAt, BOOL *stop) {
+        if (now - [firedAt doubleValue] >= PNLiteBeaconDeduplicatorValidTime) {
+            [expiredKeys addObject:key];
+        }
+    }];
+    [self.firedBeacons removeObjectsForKeys:expiredKeys];
+    
+    if (self.firedBeacons.count > PNLiteBeaconDeduplicatorCapacity) {
+        // Still full of live entries: forget the oldest ones first
+        NSArray *keysByAge = [self.firedBeacons keysSortedByValueUsingSelector:@selector(compare:)];
+        NSUInteger overflow = self.firedBeacons.count - PNLiteBeaconDeduplicatorCapacity;
+        [self.firedBeacons removeObjectsForKeys:[keysByAge subarrayWithRange:NSMakeRange(0, overflow)]];
+    }
+}
+
+@end
@@ -0,0 +1,63 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+typedef enum {
+    // The exposure time has to be met in one go, losing visibility starts it over
+    PNLiteImpressionRuleModeContinuous,
+    // Exposure time adds up across every period the view was visible
+    PNLiteImpressionRuleModeCumulative
+} PNLiteImpressionRuleMode;
+
+@interface PNLiteImpressionRule : NSObject
+
+@property (nonatomic, readonly) CGFloat minVisibility;
+@property (nonatomic, readonly) NSTimeInterval minExposureTime;
+@property (nonatomic, readonly) PNLiteImpressionRuleMode mode;
+
+/**
+ MRC display: 50% of the pixels for 1 continuous second.
+ */
++ (instancetype)displayRule;
+
+/**
+ MRC video: 50% of the pixels for 2 continuous seconds.
+ */
++ (instancetype)videoRule;
+
+/**
+ MRC large format (242,500 pixels or more): 30% of the pixels for 1 continuous second.
+ */
++ (instancetype)largeFormatRule;
+
+/**
+ The large format rule for ads of 242,500 points or more, the display rule otherwise.
+ */
++ (instancetype)ruleForAdSize:(CGSize)size;
+
++ (instancetype)ruleWithMinVisibility:(CGFloat)minVisibility
+                      minExposureTime:(NSTimeInterval)minExposureTime
+                                 mode:(PNLiteImpressionRuleMode)mode;
+
+@end
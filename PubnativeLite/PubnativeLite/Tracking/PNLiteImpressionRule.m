@@ -0,0 +1,66 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteImpressionRule.h"
+
+static CGFloat const PNLiteImpressionRuleLargeFormatArea = 242500;
+
+@interface PNLiteImpressionRule ()
+
+@property (nonatomic, assign) CGFloat minVisibility;
+@property (nonatomic, assign) NSTimeInterval minExposureTime;
+@property (nonatomic, assign) PNLiteImpressionRuleMode mode;
+
+@end
+
+@implementation PNLiteImpressionRule
+
++ (instancetype)displayRule {
+    return [self ruleWithMinVisibility:0.5f minExposureTime:1 mode:PNLiteImpressionRuleModeContinuous];
+}
+
++ (instancetype)videoRule {
+    return [self ruleWithMinVisibility:0.5f minExposureTime:2 mode:PNLiteImpressionRuleModeContinuous];
+}
+
++ (instancetype)largeFormatRule {
+    return [self ruleWithMinVisibility:0.3f minExposureTime:1 mode:PNLiteImpressionRuleModeContinuous];
+}
+
++ (instancetype)ruleForAdSize:(CGSize)size {
+    if (size.width * size.height >= PNLiteImpressionRuleLargeFormatArea) {
+        return [self largeFormatRule];
+    }
+    return [self displayRule];
+}
+
++ (instancetype)ruleWithMinVisibility:(CGFloat)minVisibility
+                      minExposureTime:(NSTimeInterval)minExposureTime
+                                 mode:(PNLiteImpressionRuleMode)mode {
+    PNLiteImpressionRule *rule = [[self alloc] init];
+    rule.minVisibility = MIN(MAX(minVisibility, 0), 1);
+    rule.minExposureTime = MAX(minExposureTime, 0);
+    rule.mode = mode;
+    return rule;
+}
+
+@end
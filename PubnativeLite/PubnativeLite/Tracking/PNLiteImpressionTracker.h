@@ -22,6 +22,7 @@
 
 #import <Foundation/Foundation.h>
 #import "UIKit/UIKit.h"
+#import "PNLiteImpressionRule.h"
 
 @protocol PNLiteImpressionTrackerDelegate <NSObject>
 
@@ -32,8 +33,18 @@
 @interface PNLiteImpressionTracker : NSObject
 
 @property (nonatomic, weak) NSObject<PNLiteImpressionTrackerDelegate> *delegate;
+@property (nonatomic, readonly) PNLiteImpressionRule *rule;
 
+/**
+ Tracks views against the given rule, -init uses the MRC display rule.
+ */
+- (instancetype)initWithRule:(PNLiteImpressionRule *)rule;
 - (void)addView:(UIView*)view;
+- (void)addView:(UIView*)view withRule:(PNLiteImpressionRule *)rule;
+/**
+ Tracks the view with the display or large format rule, picked from its size on the first check it has been laid out.
+ */
+- (void)addViewWithRuleForAdSize:(UIView*)view;
 - (void)removeView:(UIView*)view;
 - (void)clear;
 
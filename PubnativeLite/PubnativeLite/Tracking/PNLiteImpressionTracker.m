@@ -23,123 +23,128 @@
 #import "PNLiteImpressionTracker.h"
 #import "PNLiteImpressionTrackerItem.h"
 #import "HyBidVisibilityTracker.h"
+#import "PNLiteVisibilityScheduler.h"
+#import "PNLiteMonotonicClock.h"
 #import "HyBidLogger.h"
 
-NSTimeInterval const kPNImpressionCheckPeriod = 0.25f; // Check every 250 ms
-CGFloat const kPNVisibilityThreshold = 0.5f; // 50% of the view
-CGFloat const kPNVisibilityImpressionTime = 1; // 1 second
+@interface PNLiteImpressionTracker () <HyBidVisibilityTrackerDelegate, PNLiteVisibilitySchedulerObserver>
 
-@interface PNLiteImpressionTracker () <HyBidVisibilityTrackerDelegate>
-
-@property (nonatomic, strong) NSMutableArray<PNLiteImpressionTrackerItem*> *visibleViews;
-@property (nonatomic, strong) NSMutableArray<UIView*> *trackedViews;
+@property (nonatomic, strong) PNLiteImpressionRule *rule;
+@property (nonatomic, strong) NSMapTable<UIView*, PNLiteImpressionTrackerItem*> *visibleViews;
+@property (nonatomic, strong) NSMapTable<UIView*, PNLiteImpressionTrackerItem*> *trackedItems;
 @property (nonatomic, strong) HyBidVisibilityTracker *visibilityTracker;
-@property (nonatomic, assign) BOOL isVisibiltyCheckScheduled;
-@property (nonatomic, assign) BOOL isVisibiltyCheckValid;
 
 @end
 
 @implementation PNLiteImpressionTracker
 
 - (void)dealloc {
+    [[PNLiteVisibilityScheduler sharedInstance] removeObserver:self];
     self.delegate = nil;
-    [self.trackedViews removeAllObjects];
-    self.trackedViews = nil;
+    self.rule = nil;
+    [self.trackedItems removeAllObjects];
+    self.trackedItems = nil;
     [self.visibleViews removeAllObjects];
     self.visibleViews = nil;
 }
 
 - (instancetype)init {
+    return [self initWithRule:[PNLiteImpressionRule displayRule]];
+}
+
+- (instancetype)initWithRule:(PNLiteImpressionRule *)rule {
     self = [super init];
     if (self) {
-        self.visibleViews = [NSMutableArray array];
-        self.trackedViews = [NSMutableArray array];
+        self.rule = rule ? rule : [PNLiteImpressionRule displayRule];
+        self.visibleViews = [NSMapTable weakToStrongObjectsMapTable];
+        self.trackedItems = [NSMapTable weakToStrongObjectsMapTable];
         self.visibilityTracker = [[HyBidVisibilityTracker alloc] init];
         self.visibilityTracker.delegate = self;
-        self.isVisibiltyCheckScheduled = NO;
-        self.isVisibiltyCheckValid = NO;
     }
     return self;
 }
 
 - (void)addView:(UIView*)view {
-    if([self.trackedViews containsObject:view]) {
+    [self addView:view withRule:self.rule];
+}
+
+- (void)addView:(UIView*)view withRule:(PNLiteImpressionRule *)rule {
+    [self addView:view withRule:rule resolvingRuleFromViewSize:NO];
+}
+
+- (void)addViewWithRuleForAdSize:(UIView*)view {
+    // Until the view is laid out it is measured against the display rule
+    [self addView:view withRule:[PNLiteImpressionRule displayRule] resolvingRuleFromViewSize:YES];
+}
+
+- (void)addView:(UIView*)view withRule:(PNLiteImpressionRule *)rule resolvingRuleFromViewSize:(BOOL)resolvesRuleFromViewSize {
+    if(!view) {
+        [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:@"View is nil and required, dropping this call."];
+    } else if([self.trackedItems objectForKey:view]) {
         [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:@"View is already being tracked, dropping this call."];
     } else {
-        [self.trackedViews addObject:view];
-        [self.visibilityTracker addView:view withMinVisibility:kPNVisibilityThreshold];
+        PNLiteImpressionTrackerItem *item = [[PNLiteImpressionTrackerItem alloc] init];
+        item.view = view;
+        item.rule = rule ? rule : self.rule;
+        item.resolvesRuleFromViewSize = resolvesRuleFromViewSize;
+        [self.trackedItems setObject:item forKey:view];
+        [self.visibilityTracker addView:view withMinVisibility:item.rule.minVisibility];
     }
 }
 
 - (void)removeView:(UIView*)view {
     [self.visibilityTracker removeView:view];
-    [self.trackedViews removeObject:view];
+    [self.trackedItems removeObjectForKey:view];
+    // Drop its pending visibility too, otherwise the scheduler keeps ticking for a view nobody tracks
+    [self.visibleViews removeObjectForKey:view];
 }
 
 - (void)clear {
-    self.isVisibiltyCheckValid = NO;
-    self.isVisibiltyCheckScheduled = NO;
+    [[PNLiteVisibilityScheduler sharedInstance] removeObserver:self];
     [self.visibleViews removeAllObjects];
     self.visibleViews = nil;
+    [self.trackedItems removeAllObjects];
     [self.visibilityTracker clear];
     self.visibilityTracker = nil;
 }
 
 - (void)scheduleNextRun {
-    if(self.isVisibiltyCheckValid && !self.isVisibiltyCheckScheduled) {
-        self.isVisibiltyCheckScheduled = YES;
-        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, kPNImpressionCheckPeriod * NSEC_PER_SEC), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-            if(!self.delegate) {
-                [self clear];
-            } else if(self.visibleViews && self.visibleViews.count > 0) {
-                [self checkVisibility];
-            }
-        });
-        
+    if (self.visibleViews) {
+        [[PNLiteVisibilityScheduler sharedInstance] addObserver:self];
+    }
+}
+
+#pragma mark PNLiteVisibilitySchedulerObserver
+
+- (void)visibilitySchedulerDidTick:(PNLiteVisibilityScheduler *)scheduler {
+    if(!self.delegate) {
+        [self clear];
+    } else if(self.visibleViews && self.visibleViews.count > 0) {
+        [self checkVisibility];
     } else {
-        self.isVisibiltyCheckValid = YES;
+        [[PNLiteVisibilityScheduler sharedInstance] removeObserver:self];
     }
 }
 
 - (void)checkVisibility {
     if(self.visibleViews != nil) {
-        for (int i = 0; i < self.visibleViews.count; i++) {
-            if (i < self.visibleViews.count) {
-                PNLiteImpressionTrackerItem *item = self.visibleViews[i];
-                // It could happen that we've removed the view right when we're tracking, so we simply skip this item
-                if([self.trackedViews containsObject:item.view]) {
-                    NSTimeInterval currentTimestamp = [[NSDate date] timeIntervalSince1970];
-                    NSTimeInterval elapsedTime = currentTimestamp - item.timestamp;
-                    if(kPNVisibilityImpressionTime <= elapsedTime) {
-                        [self removeView:item.view];
-                        [self invokeImpressionDetected:item.view];
-                    }
-                }
-            } else {
-                // We have emptied the visible views while going through It, so we leave this for
-                break;
+        NSTimeInterval uptime = [PNLiteMonotonicClock uptime];
+        // Detecting an impression removes the view, so walk a copy of the keys
+        for (UIView *view in [[self.visibleViews keyEnumerator] allObjects]) {
+            PNLiteImpressionTrackerItem *item = [self.visibleViews objectForKey:view];
+            // It could happen that we've removed the view right when we're tracking, so we simply skip this item
+            if(item && [self.trackedItems objectForKey:view] == item && [item meetsRuleAtUptime:uptime]) {
+                [self removeView:view];
+                [self invokeImpressionDetected:view];
             }
         }
         
-        self.isVisibiltyCheckScheduled = NO;
-        if(self.visibleViews.count > 0) {
-            [self scheduleNextRun];
+        if(self.visibleViews.count == 0) {
+            [[PNLiteVisibilityScheduler sharedInstance] removeObserver:self];
         }
     }
 }
 
-- (NSInteger)indexOfVisibleView:(UIView*)view {
-    NSInteger result = -1;
-    for (int index = 0; index<self.visibleViews.count; index++) {
-        PNLiteImpressionTrackerItem *item = self.visibleViews[index];
-        if(item.view == view) {
-            result = index;
-            break;
-        }
-    }
-    return result;
-}
-
 #pragma mark Callback Helper
 
 - (void)invokeImpressionDetected:(UIView*)view {
@@ -148,27 +153,39 @@ CGFloat const kPNVisibilityImpressionTime = 1; // 1 second
     }
 }
 
+- (void)resolveRulesForViews:(NSArray<UIView *> *)views {
+    for (UIView *view in views) {
+        PNLiteImpressionTrackerItem *item = [self.trackedItems objectForKey:view];
+        CGFloat minVisibility = item.rule.minVisibility;
+        if ([item resolveRuleFromViewSize] && item.rule.minVisibility != minVisibility) {
+            // The new threshold applies from the next check on
+            [self.visibilityTracker removeView:view];
+            [self.visibilityTracker addView:view withMinVisibility:item.rule.minVisibility];
+        }
+    }
+}
+
 #pragma mark HyBidVisibilityTrackerDelegate
 
 - (void)checkVisibilityWithVisibleViews:(NSArray<UIView *> *)visibleViews andWithInvisibleViews:(NSArray<UIView *> *)invisibleViews {
     if(!self.delegate) {
         [self clear];
     } else {
+        [self resolveRulesForViews:[visibleViews arrayByAddingObjectsFromArray:invisibleViews]];
+        NSTimeInterval uptime = [PNLiteMonotonicClock uptime];
         for (UIView *visibleView in visibleViews) {
-            NSInteger index = [self indexOfVisibleView:visibleView];
-            PNLiteImpressionTrackerItem *item;
-            if(index < 0) {
-                // First time it's visible, add it
-                item = [[PNLiteImpressionTrackerItem alloc] init];
-                item.view = visibleView;
-                item.timestamp = [[NSDate date] timeIntervalSince1970];
-                [self.visibleViews addObject:item];
+            PNLiteImpressionTrackerItem *item = [self.trackedItems objectForKey:visibleView];
+            if(item && ![self.visibleViews objectForKey:visibleView]) {
+                // A new visible period starts, cumulative rules keep what they gathered before
+                [item markVisibleAtUptime:uptime];
+                [self.visibleViews setObject:item forKey:visibleView];
             }
         }
         for (UIView *invisibleView in invisibleViews) {
-            NSInteger index = [self indexOfVisibleView:invisibleView];
-            if(index >= 0) {
-                [self.visibleViews removeObjectAtIndex:index];
+            PNLiteImpressionTrackerItem *item = [self.visibleViews objectForKey:invisibleView];
+            if(item) {
+                [item markInvisibleAtUptime:uptime];
+                [self.visibleViews removeObjectForKey:invisibleView];
             }
         }
         if (self.visibleViews.count > 0) {
@@ -22,10 +22,24 @@
 
 #import <Foundation/Foundation.h>
 #import <UIKit/UIKit.h>
+#import "PNLiteImpressionRule.h"
 
 @interface PNLiteImpressionTrackerItem : NSObject
 
 @property (nonatomic, weak) UIView *view;
-@property (nonatomic, assign) NSTimeInterval timestamp;
+@property (nonatomic, strong) PNLiteImpressionRule *rule;
+// Monotonic uptime the current visible period started at, 0 while the view is not visible
+@property (nonatomic, assign) NSTimeInterval visibleSince;
+// Exposure from previous visible periods, only kept by cumulative rules
+@property (nonatomic, assign) NSTimeInterval accumulatedExposure;
+// The rule is picked from the view's size once it has been laid out, see resolveRuleFromViewSize
+@property (nonatomic, assign) BOOL resolvesRuleFromViewSize;
+
+- (void)markVisibleAtUptime:(NSTimeInterval)uptime;
+- (void)markInvisibleAtUptime:(NSTimeInterval)uptime;
+- (NSTimeInterval)exposureAtUptime:(NSTimeInterval)uptime;
+- (BOOL)meetsRuleAtUptime:(NSTimeInterval)uptime;
+// YES when this call picked the rule, which waits for the first non-zero bounds of the view
+- (BOOL)resolveRuleFromViewSize;
 
 @end
@@ -26,6 +26,46 @@
 
 - (void)dealloc {
     self.view = nil;
+    self.rule = nil;
+}
+
+- (BOOL)isVisible {
+    return self.visibleSince > 0;
+}
+
+- (void)markVisibleAtUptime:(NSTimeInterval)uptime {
+    if (![self isVisible]) {
+        self.visibleSince = uptime;
+    }
+}
+
+- (void)markInvisibleAtUptime:(NSTimeInterval)uptime {
+    if ([self isVisible] && self.rule.mode == PNLiteImpressionRuleModeCumulative) {
+        self.accumulatedExposure += uptime - self.visibleSince;
+    }
+    self.visibleSince = 0;
+}
+
+- (NSTimeInterval)exposureAtUptime:(NSTimeInterval)uptime {
+    NSTimeInterval exposure = self.rule.mode == PNLiteImpressionRuleModeCumulative ? self.accumulatedExposure : 0;
+    if ([self isVisible]) {
+        exposure += MAX(uptime - self.visibleSince, 0);
+    }
+    return exposure;
+}
+
+- (BOOL)meetsRuleAtUptime:(NSTimeInterval)uptime {
+    return [self exposureAtUptime:uptime] >= self.rule.minExposureTime;
+}
+
+- (BOOL)resolveRuleFromViewSize {
+    CGSize size = self.view.bounds.size;
+    if (!self.resolvesRuleFromViewSize || size.width <= 0 || size.height <= 0) {
+        return NO;
+    }
+    self.rule = [PNLiteImpressionRule ruleForAdSize:size];
+    self.resolvesRuleFromViewSize = NO;
+    return YES;
 }
 
 @end
@@ -0,0 +1,337 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteJSBeaconEngine.h"
+#import "HyBidLogger.h"
+#import <WebKit/WebKit.h>
+#import <UIKit/UIKit.h>
+
+NSUInteger const PNLiteJSBeaconEnginePoolSize = 2;
+NSTimeInterval const PNLiteJSBeaconEngineScriptTimeout = 5;
+// Web views are recycled after a while so the memory held by their web content process doesn't pile up
+NSUInteger const PNLiteJSBeaconEngineScriptsPerWebView = 20;
+NSString *const PNLiteJSBeaconEngineMessageHandler = @"pnliteBeacon";
+// Every job gets this fresh document, so globals, timers and listeners of one ad never reach the next
+NSString *const PNLiteJSBeaconEngineDocument = @"<!DOCTYPE html><html><head></head><body></body></html>";
+// Counts the pixels still loading and posts the job's generation once the script's pixels are all done.
+// Pixels are tracked through the image src setter, the way beacon scripts fire them.
+NSString *const PNLiteJSBeaconEngineSettleScript = @"(function() {"
+"var pending = 0, generation = null;"
+"function settle() { if (generation !== null && pending === 0) { window.webkit.messageHandlers.pnliteBeacon.postMessage(generation); generation = null; } }"
+"var descriptor = Object.getOwnPropertyDescriptor(HTMLImageElement.prototype, 'src');"
+"Object.defineProperty(HTMLImageElement.prototype, 'src', { configurable: true, enumerable: descriptor.enumerable, get: descriptor.get, set: function(value) {"
+"var image = this;"
+"if (!image.__pnlitePending) { image.__pnlitePending = true; pending++;"
+"var done = function() { image.removeEventListener('load', done); image.removeEventListener('error', done); image.__pnlitePending = false; pending--; settle(); };"
+"image.addEventListener('load', done); image.addEventListener('error', done); }"
+"descriptor.set.call(image, value); } });"
+"window.__pnliteBeaconSettle = function(jobGeneration) { generation = jobGeneration; setTimeout(settle, 0); };"
+"})();";
+
+@interface PNLiteJSBeaconJob : NSObject
+
+@property (nonatomic, strong) NSString *script;
+@property (nonatomic, copy) PNLiteJSBeaconCompletionBlock completion;
+
+@end
+
+@implementation PNLiteJSBeaconJob
+
+- (void)dealloc {
+    self.script = nil;
+    self.completion = nil;
+}
+
+@end
+
+@interface PNLiteJSBeaconWebView : NSObject
+
+@property (nonatomic, strong) WKWebView *webView;
+@property (nonatomic, strong) PNLiteJSBeaconJob *currentJob;
+@property (nonatomic, strong) WKNavigation *navigation;
+@property (nonatomic, assign) NSUInteger evaluatedScripts;
+@property (nonatomic, assign) NSUInteger jobGeneration;
+
+@end
+
+@implementation PNLiteJSBeaconWebView
+
+- (void)dealloc {
+    [self.webView stopLoading];
+    self.webView = nil;
+    self.currentJob = nil;
+    self.navigation = nil;
+}
+
+@end
+
+// WKUserContentController retains its handlers, this keeps it from retaining the engine
+@interface PNLiteJSBeaconMessageHandler : NSObject <WKScriptMessageHandler>
+
+@property (nonatomic, weak) id<WKScriptMessageHandler> handler;
+
+@end
+
+@implementation PNLiteJSBeaconMessageHandler
+
+- (void)dealloc {
+    self.handler = nil;
+}
+
+- (void)userContentController:(WKUserContentController *)userContentController didReceiveScriptMessage:(WKScriptMessage *)message {
+    [self.handler userContentController:userContentController didReceiveScriptMessage:message];
+}
+
+@end
+
+@interface PNLiteJSBeaconEngine () <WKNavigationDelegate, WKScriptMessageHandler>
+
+@property (nonatomic, strong) NSMutableArray<PNLiteJSBeaconJob *> *pendingJobs;
+@property (nonatomic, strong) NSMutableArray<PNLiteJSBeaconWebView *> *pool;
+@property (nonatomic, strong) WKProcessPool *processPool;
+@property (nonatomic, assign) NSTimeInterval scriptTimeout;
+
+@end
+
+@implementation PNLiteJSBeaconEngine
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    self.pendingJobs = nil;
+    self.pool = nil;
+    self.processPool = nil;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        self.pendingJobs = [NSMutableArray array];
+        self.pool = [NSMutableArray array];
+        self.processPool = [[WKProcessPool alloc] init];
+        self.scriptTimeout = PNLiteJSBeaconEngineScriptTimeout;
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(didReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
++ (instancetype)sharedInstance {
+    static PNLiteJSBeaconEngine *instance;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[PNLiteJSBeaconEngine alloc] init];
+    });
+    return instance;
+}
+
+- (void)evaluateBeaconScript:(NSString *)script completion:(PNLiteJSBeaconCompletionBlock)completion {
+    if (!script || script.length == 0) {
+        [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:@"Beacon script is nil or empty, dropping this call."];
+        return;
+    }
+    PNLiteJSBeaconJob *job = [[PNLiteJSBeaconJob alloc] init];
+    job.script = script;
+    job.completion = completion;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self.pendingJobs addObject:job];
+        [self runNextJobs];
+    });
+}
+
+#pragma mark Scheduling
+
+- (void)runNextJobs {
+    while (self.pendingJobs.count > 0) {
+        PNLiteJSBeaconWebView *slot = [self idleSlot];
+        if (!slot) {
+            break;
+        }
+        PNLiteJSBeaconJob *job = self.pendingJobs.firstObject;
+        [self.pendingJobs removeObjectAtIndex:0];
+        [self runJob:job onSlot:slot];
+    }
+}
+
+- (PNLiteJSBeaconWebView *)idleSlot {
+    for (PNLiteJSBeaconWebView *slot in self.pool) {
+        if (!slot.currentJob) {
+            return slot;
+        }
+    }
+    if (self.pool.count < PNLiteJSBeaconEnginePoolSize) {
+        PNLiteJSBeaconWebView *slot = [[PNLiteJSBeaconWebView alloc] init];
+        slot.webView = [self createWebView];
+        [self.pool addObject:slot];
+        return slot;
+    }
+    return nil;
+}
+
+- (PNLiteJSBeaconWebView *)slotForWebView:(WKWebView *)webView {
+    for (PNLiteJSBeaconWebView *slot in self.pool) {
+        if (slot.webView == webView) {
+            return slot;
+        }
+    }
+    return nil;
+}
+
+- (WKWebView *)createWebView {
+    PNLiteJSBeaconMessageHandler *messageHandler = [[PNLiteJSBeaconMessageHandler alloc] init];
+    messageHandler.handler = self;
+    WKUserContentController *userContentController = [[WKUserContentController alloc] init];
+    [userContentController addScriptMessageHandler:messageHandler name:PNLiteJSBeaconEngineMessageHandler];
+    [userContentController addUserScript:[[WKUserScript alloc] initWithSource:PNLiteJSBeaconEngineSettleScript
+                                                                injectionTime:WKUserScriptInjectionTimeAtDocumentStart
+                                                             forMainFrameOnly:YES]];
+    WKWebViewConfiguration *configuration = [[WKWebViewConfiguration alloc] init];
+    configuration.processPool = self.processPool;
+    configuration.userContentController = userContentController;
+    WKWebView *webView = [[WKWebView alloc] initWithFrame:CGRectZero configuration:configuration];
+    webView.navigationDelegate = self;
+    return webView;
+}
+
+- (void)runJob:(PNLiteJSBeaconJob *)job onSlot:(PNLiteJSBeaconWebView *)slot {
+    slot.currentJob = job;
+    slot.jobGeneration++;
+    NSUInteger generation = slot.jobGeneration;
+    
+    // The script runs once the fresh document has finished loading, see webView:didFinishNavigation:
+    slot.navigation = [slot.webView loadHTMLString:PNLiteJSBeaconEngineDocument baseURL:nil];
+    __weak typeof(self) weakSelf = self;
+    __weak PNLiteJSBeaconWebView *weakSlot = slot;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.scriptTimeout * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        NSError *error = [NSError errorWithDomain:@"Beacon script timed out." code:0 userInfo:nil];
+        [weakSelf finishJobOnSlot:weakSlot generation:generation withError:error timedOut:YES];
+    });
+}
+
+- (void)evaluateJobOnSlot:(PNLiteJSBeaconWebView *)slot {
+    NSUInteger generation = slot.jobGeneration;
+    __weak typeof(self) weakSelf = self;
+    __weak PNLiteJSBeaconWebView *weakSlot = slot;
+    [slot.webView evaluateJavaScript:slot.currentJob.script completionHandler:^(id result, NSError *error) {
+        if (error) {
+            [weakSelf finishJobOnSlot:weakSlot generation:generation withError:error timedOut:NO];
+            return;
+        }
+        // Completion comes from the message handler once the pixels the script fired have loaded
+        NSString *settle = [NSString stringWithFormat:@"window.__pnliteBeaconSettle(%lu);", (unsigned long)generation];
+        [weakSlot.webView evaluateJavaScript:settle completionHandler:^(id result, NSError *error) {
+            if (error) {
+                [weakSelf finishJobOnSlot:weakSlot generation:generation withError:error timedOut:NO];
+            }
+        }];
+    }];
+}
+
+- (void)finishJobOnSlot:(PNLiteJSBeaconWebView *)slot generation:(NSUInteger)generation withError:(NSError *)error timedOut:(BOOL)timedOut {
+    if (!slot || slot.jobGeneration != generation || !slot.currentJob) {
+        // Already finished, either by the script itself or by its timeout
+        return;
+    }
+    PNLiteJSBeaconJob *job = slot.currentJob;
+    slot.currentJob = nil;
+    slot.navigation = nil;
+    slot.evaluatedScripts++;
+    
+    if (error) {
+        [HyBidLogger errorLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Beacon script failed with error: %@", error.localizedDescription]];
+    }
+    if (timedOut || slot.evaluatedScripts >= PNLiteJSBeaconEngineScriptsPerWebView) {
+        // A hung script would block every later beacon on this web view, so start over with a fresh one
+        [slot.webView stopLoading];
+        slot.webView.navigationDelegate = nil;
+        slot.webView = [self createWebView];
+        slot.evaluatedScripts = 0;
+    }
+    if (job.completion) {
+        job.completion(error);
+    }
+    [self runNextJobs];
+}
+
+#pragma mark WKNavigationDelegate
+
+- (void)webView:(WKWebView *)webView didFinishNavigation:(WKNavigation *)navigation {
+    PNLiteJSBeaconWebView *slot = [self slotForWebView:webView];
+    if (!slot.currentJob || slot.navigation != navigation) {
+        return;
+    }
+    slot.navigation = nil;
+    [self evaluateJobOnSlot:slot];
+}
+
+- (void)webView:(WKWebView *)webView didFailNavigation:(WKNavigation *)navigation withError:(NSError *)error {
+    [self failJobOnWebView:webView navigation:navigation withError:error];
+}
+
+- (void)webView:(WKWebView *)webView didFailProvisionalNavigation:(WKNavigation *)navigation withError:(NSError *)error {
+    [self failJobOnWebView:webView navigation:navigation withError:error];
+}
+
+- (void)failJobOnWebView:(WKWebView *)webView navigation:(WKNavigation *)navigation withError:(NSError *)error {
+    PNLiteJSBeaconWebView *slot = [self slotForWebView:webView];
+    if (!slot.currentJob || slot.navigation != navigation) {
+        return;
+    }
+    [self finishJobOnSlot:slot generation:slot.jobGeneration withError:error timedOut:NO];
+}
+
+- (void)webViewWebContentProcessDidTerminate:(WKWebView *)webView {
+    PNLiteJSBeaconWebView *slot = [self slotForWebView:webView];
+    if (!slot.currentJob) {
+        return;
+    }
+    NSError *error = [NSError errorWithDomain:@"Beacon web view process terminated." code:0 userInfo:nil];
+    [self finishJobOnSlot:slot generation:slot.jobGeneration withError:error timedOut:YES];
+}
+
+#pragma mark WKScriptMessageHandler
+
+- (void)userContentController:(WKUserContentController *)userContentController didReceiveScriptMessage:(WKScriptMessage *)message {
+    if (![message.body isKindOfClass:[NSNumber class]]) {
+        return;
+    }
+    // The generation drops a late message from a job that already timed out
+    [self finishJobOnSlot:[self slotForWebView:message.webView]
+               generation:[message.body unsignedIntegerValue]
+                withError:nil
+                 timedOut:NO];
+}
+
+#pragma mark Memory
+
+- (void)didReceiveMemoryWarning:(NSNotification *)notification {
+    NSMutableArray *busySlots = [NSMutableArray array];
+    for (PNLiteJSBeaconWebView *slot in self.pool) {
+        if (slot.currentJob) {
+            [busySlots addObject:slot];
+        }
+    }
+    [self.pool setArray:busySlots];
+}
+
+@end
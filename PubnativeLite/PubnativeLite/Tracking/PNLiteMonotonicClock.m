@@ -0,0 +1,56 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteMonotonicClock.h"
+#import <sys/sysctl.h>
+#import <time.h>
+
+// kern.boottime moves along with wall-clock adjustments, so allow for small corrections
+NSTimeInterval const PNLiteMonotonicClockBootTimeTolerance = 60;
+
+@implementation PNLiteMonotonicClock
+
++ (NSTimeInterval)uptime {
+    if (@available(iOS 10.0, *)) {
+        return (NSTimeInterval)clock_gettime_nsec_np(CLOCK_MONOTONIC) / NSEC_PER_SEC;
+    } else {
+        // CACurrentMediaTime stops while the device sleeps, the time since kern.boottime doesn't.
+        // Setting the device clock moves kern.boottime with it, so the difference is unaffected.
+        return [[NSDate date] timeIntervalSince1970] - [self bootTime];
+    }
+}
+
++ (NSTimeInterval)bootTime {
+    struct timeval bootTime;
+    size_t size = sizeof(bootTime);
+    int mib[2] = {CTL_KERN, KERN_BOOTTIME};
+    if (sysctl(mib, 2, &bootTime, &size, NULL, 0) != 0) {
+        return 0;
+    }
+    return bootTime.tv_sec + bootTime.tv_usec / (NSTimeInterval)USEC_PER_SEC;
+}
+
++ (BOOL)isCurrentBootTime:(NSTimeInterval)bootTime {
+    return bootTime > 0 && fabs([self bootTime] - bootTime) < PNLiteMonotonicClockBootTimeTolerance;
+}
+
+@end
@@ -22,8 +22,35 @@
 
 #import <Foundation/Foundation.h>
 
+/**
+ Status code is 0 when no response was received. Called on the main queue.
+ */
+typedef void (^PNLiteTrackingManagerCompletionBlock)(NSInteger statusCode, NSError *error);
+
 @interface PNLiteTrackingManager : NSObject
 
 + (void)trackWithURL:(NSURL *)url;
 
+/**
+ Tracks the URL through the queue and reports how its first attempt went. A failed attempt is still
+ retried in the background, but the completion is not called again. URLs tracked this way are never batched.
+ */
++ (void)trackWithURL:(NSURL *)url completion:(PNLiteTrackingManagerCompletionBlock)completion;
+
+/**
+ Tracks URLs that fire together, like every beacon of one VAST event, with a single pass through the queue.
+ */
++ (void)trackWithURLs:(NSArray<NSURL *> *)urls;
+
+/**
+ Tracks the URL, never dispatching it while another item with the same ordering key is still in flight.
+ Items without an ordering key are dispatched as soon as a slot is free.
+ */
++ (void)trackWithURL:(NSURL *)url withOrderingKey:(NSString *)orderingKey;
+
+/**
+ Sets how many beacons can be in flight at the same time. Defaults to 4.
+ */
++ (void)setMaxConcurrentRequests:(NSInteger)maxConcurrentRequests;
+
 @end
@@ -22,29 +22,61 @@
 #import "PNLiteTrackingManager.h"
 #import "PNLiteTrackingManagerItem.h"
 #import "PNLiteHttpRequest.h"
+#import "PNLiteBeaconBatcher.h"
+#import "PNLiteTrackingRetryScheduler.h"
+#import "HyBidSettings.h"
 #import "HyBidLogger.h"
+#import <UIKit/UIKit.h>
 
 NSString * const PNLiteTrackingManagerQueueKey             = @"PNLiteTrackingManager.queue.key";
 NSString * const PNLiteTrackingManagerFailedQueueKey       = @"PNLiteTrackingManager.failedQueue.key";
 NSTimeInterval const PNLiteTrackingManagerItemValidTime    = 1800;
+NSInteger const PNLiteTrackingManagerDefaultMaxConcurrentRequests = 4;
 
-@interface PNLiteTrackingManager () <PNLiteHttpRequestDelegate>
+@interface PNLiteTrackingManager () <PNLiteHttpRequestDelegate, PNLiteBeaconBatcherDelegate, PNLiteTrackingRetrySchedulerDelegate>
 
-@property (nonatomic, assign) BOOL isRunning;
-@property (nonatomic, strong) PNLiteTrackingManagerItem *currentItem;
+@property (nonatomic, assign) NSInteger maxConcurrentRequests;
+@property (nonatomic, strong) NSMapTable<PNLiteHttpRequest *, PNLiteTrackingManagerItem *> *inFlightItems;
+@property (nonatomic, strong) NSCountedSet<NSString *> *inFlightOrderingKeys;
+@property (nonatomic, strong) NSCountedSet<NSURL *> *inFlightURLs;
+@property (nonatomic, assign) UIBackgroundTaskIdentifier backgroundTask;
+@property (nonatomic, strong) PNLiteBeaconBatcher *batcher;
+@property (nonatomic, strong) PNLiteTrackingRetryScheduler *retryScheduler;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, PNLiteTrackingManagerCompletionBlock> *completions;
 
 @end
 
 @implementation PNLiteTrackingManager
 
 - (void)dealloc {
-    self.currentItem = nil;
+    self.inFlightItems = nil;
+    self.inFlightOrderingKeys = nil;
+    self.inFlightURLs = nil;
+    self.batcher = nil;
+    self.retryScheduler = nil;
+    self.completions = nil;
 }
 
 - (instancetype)init {
     self = [super init];
     if (self) {
-        self.isRunning = NO;
+        self.maxConcurrentRequests = PNLiteTrackingManagerDefaultMaxConcurrentRequests;
+        self.inFlightItems = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                                   valueOptions:NSPointerFunctionsStrongMemory];
+        self.inFlightOrderingKeys = [NSCountedSet set];
+        self.inFlightURLs = [NSCountedSet set];
+        self.backgroundTask = UIBackgroundTaskInvalid;
+        self.completions = [NSMutableDictionary dictionary];
+        self.batcher = [[PNLiteBeaconBatcher alloc] init];
+        self.batcher.delegate = self;
+        self.retryScheduler = [[PNLiteTrackingRetryScheduler alloc] initWithQueueKey:PNLiteTrackingManagerFailedQueueKey
+                                                                           validTime:PNLiteTrackingManagerItemValidTime];
+        self.retryScheduler.delegate = self;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self.batcher start];
+            [self.retryScheduler start];
+            [self updateBackgroundTask];
+        });
     }
     return self;
 }
@@ -58,50 +90,146 @@ NSTimeInterval const PNLiteTrackingManagerItemValidTime    = 1800;
     return instance;
 }
 
++ (void)setMaxConcurrentRequests:(NSInteger)maxConcurrentRequests {
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self sharedManager].maxConcurrentRequests = MAX(1, maxConcurrentRequests);
+        [[self sharedManager] trackNextItems];
+    });
+}
+
 + (void)trackWithURL:(NSURL*)url {
+    [self trackWithURL:url withOrderingKey:nil];
+}
+
++ (void)trackWithURL:(NSURL *)url withOrderingKey:(NSString *)orderingKey {
     if (!url) {
         [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:@"URL passed is nil or empty, dropping this call."];
     } else {
-        // Enqueue failed items
-        NSMutableArray *failedQueue = [self queueForKey:PNLiteTrackingManagerFailedQueueKey];
-        for (NSDictionary *dictionary in failedQueue) {
-            PNLiteTrackingManagerItem *item = [[PNLiteTrackingManagerItem alloc] initWithDictionary:dictionary];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            PNLiteBeaconBatcher *batcher = [self sharedManager].batcher;
+            if ([HyBidSettings sharedInstance].beaconBatching && !orderingKey && [batcher canBatchURL:url]) {
+                [batcher addURL:url];
+                [[self sharedManager] updateBackgroundTask];
+                return;
+            }
+            
+            PNLiteTrackingManagerItem *item = [[PNLiteTrackingManagerItem alloc] initWithURL:url];
+            item.orderingKey = orderingKey;
             [self enqueueItem:item withQueueKey:PNLiteTrackingManagerQueueKey];
-        }
-        [self setQueue:nil forKey:PNLiteTrackingManagerFailedQueueKey];
-        
-        // Enqueue current item
-        PNLiteTrackingManagerItem *item = [[PNLiteTrackingManagerItem alloc] init];
-        item.url = url;
-        item.timestamp = [NSNumber numberWithDouble:[[NSDate date] timeIntervalSince1970]];
-        [self enqueueItem:item withQueueKey:PNLiteTrackingManagerQueueKey];
-        [[self sharedManager] trackNextItem];
+            [[self sharedManager] trackNextItems];
+        });
+    }
+}
+
++ (void)trackWithURL:(NSURL *)url completion:(PNLiteTrackingManagerCompletionBlock)completion {
+    if (!url) {
+        [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:@"URL passed is nil or empty, dropping this call."];
+    } else {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            PNLiteTrackingManagerItem *item = [[PNLiteTrackingManagerItem alloc] initWithURL:url];
+            if (completion) {
+                item.identifier = [[NSUUID UUID] UUIDString];
+                [self sharedManager].completions[item.identifier] = completion;
+            }
+            [self enqueueItem:item withQueueKey:PNLiteTrackingManagerQueueKey];
+            [[self sharedManager] trackNextItems];
+        });
     }
 }
 
-- (void)trackNextItem {
-    if(!self.isRunning) {
-        
-        self.isRunning = YES;
-        PNLiteTrackingManagerItem *item = [PNLiteTrackingManager dequeueItemWithQueueKey:PNLiteTrackingManagerQueueKey];
-        if(item) {
-            self.currentItem = item;
-            NSTimeInterval currentTimestamp = [[NSDate date] timeIntervalSince1970];
-            NSTimeInterval itemTimestamp = [item.timestamp doubleValue];
-            if((currentTimestamp - itemTimestamp) < PNLiteTrackingManagerItemValidTime) {
-                // Track item
-                [[PNLiteHttpRequest alloc] startWithUrlString:[self.currentItem.url absoluteString] withMethod:@"GET" delegate:self];
++ (void)trackWithURLs:(NSArray<NSURL *> *)urls {
+    if (urls.count == 0) {
+        return;
+    }
+    dispatch_async(dispatch_get_main_queue(), ^{
+        PNLiteBeaconBatcher *batcher = [self sharedManager].batcher;
+        BOOL beaconBatching = [HyBidSettings sharedInstance].beaconBatching;
+        // The persisted queue is read and written once for the whole batch
+        NSMutableArray *queue = [PNLiteTrackingManager queueForKey:PNLiteTrackingManagerQueueKey];
+        for (NSURL *url in urls) {
+            if (beaconBatching && [batcher canBatchURL:url]) {
+                [batcher addURL:url];
             } else {
-                // Discard the item and continue
-//                This code piece down below makes sure that isRunning param resets itself.
-//                But this scenario is happening only when we have breakpoints.
-//                Since Timestamp difference is not a valid time because we are debugging and we are using time for it.
-//                self.isRunning = NO;
-                [self trackNextItem];
+                [queue addObject:[[[PNLiteTrackingManagerItem alloc] initWithURL:url] toDictionary]];
             }
+        }
+        [PNLiteTrackingManager setQueue:queue forKey:PNLiteTrackingManagerQueueKey];
+        [[self sharedManager] trackNextItems];
+    });
+}
+
+- (void)trackNextItems {
+    while (self.inFlightItems.count < self.maxConcurrentRequests) {
+        // Items sharing an ordering key or a URL with an in-flight item stay queued until that one completes.
+        // A shared URL may belong to another ad, so it is delayed rather than dropped.
+        PNLiteTrackingManagerItem *item = [PNLiteTrackingManager dequeueItemWithQueueKey:PNLiteTrackingManagerQueueKey
+                                                                    excludingOrderingKeys:self.inFlightOrderingKeys
+                                                                                     URLs:self.inFlightURLs];
+        if (!item) {
+            break;
+        }
+        if (!item.url) {
+            [self completeItem:item withStatusCode:0 error:[NSError errorWithDomain:@"Invalid tracking URL." code:0 userInfo:nil]];
+        } else if ([item age] < PNLiteTrackingManagerItemValidTime) {
+            [self startTrackingItem:item];
         } else {
-            self.isRunning = NO;
+            [self completeItem:item withStatusCode:0 error:[NSError errorWithDomain:@"Tracking URL expired before it could be sent." code:0 userInfo:nil]];
+        }
+    }
+    [self updateBackgroundTask];
+}
+
+- (void)startTrackingItem:(PNLiteTrackingManagerItem *)item {
+    PNLiteHttpRequest *request = [[PNLiteHttpRequest alloc] init];
+    [self.inFlightItems setObject:item forKey:request];
+    [self.inFlightURLs addObject:item.url];
+    if (item.orderingKey) {
+        [self.inFlightOrderingKeys addObject:item.orderingKey];
+    }
+    [request startWithUrlString:[item.url absoluteString] withMethod:@"GET" delegate:self];
+}
+
+- (void)finishTrackingWithRequest:(PNLiteHttpRequest *)request statusCode:(NSInteger)statusCode error:(NSError *)error {
+    PNLiteTrackingManagerItem *item = [self.inFlightItems objectForKey:request];
+    if (item) {
+        [self completeItem:item withStatusCode:statusCode error:error];
+        if (error) {
+            [self.retryScheduler scheduleItem:item];
         }
+        if (item.orderingKey) {
+            [self.inFlightOrderingKeys removeObject:item.orderingKey];
+        }
+        [self.inFlightURLs removeObject:item.url];
+        [self.inFlightItems removeObjectForKey:request];
+    }
+    [self trackNextItems];
+}
+
+- (void)completeItem:(PNLiteTrackingManagerItem *)item withStatusCode:(NSInteger)statusCode error:(NSError *)error {
+    if (!item.identifier) {
+        return;
+    }
+    PNLiteTrackingManagerCompletionBlock completion = self.completions[item.identifier];
+    [self.completions removeObjectForKey:item.identifier];
+    if (completion) {
+        completion(statusCode, error);
+    }
+}
+
+#pragma mark Background Task
+
+- (void)updateBackgroundTask {
+    UIApplication *application = [UIApplication sharedApplication];
+    BOOL hasUndeliveredBeacons = self.inFlightItems.count > 0 || self.batcher.hasUndeliveredURLs;
+    if (hasUndeliveredBeacons && self.backgroundTask == UIBackgroundTaskInvalid) {
+        // Keep the app alive long enough for beacons already on the wire, or waiting for their batch, to reach partners
+        self.backgroundTask = [application beginBackgroundTaskWithName:NSStringFromClass([self class]) expirationHandler:^{
+            [application endBackgroundTask:self.backgroundTask];
+            self.backgroundTask = UIBackgroundTaskInvalid;
+        }];
+    } else if (!hasUndeliveredBeacons && self.backgroundTask != UIBackgroundTaskInvalid) {
+        [application endBackgroundTask:self.backgroundTask];
+        self.backgroundTask = UIBackgroundTaskInvalid;
     }
 }
 
@@ -115,13 +243,17 @@ NSTimeInterval const PNLiteTrackingManagerItemValidTime    = 1800;
     }
 }
 
-+ (PNLiteTrackingManagerItem *)dequeueItemWithQueueKey:(NSString*)key {
++ (PNLiteTrackingManagerItem *)dequeueItemWithQueueKey:(NSString*)key excludingOrderingKeys:(NSCountedSet *)orderingKeys URLs:(NSCountedSet *)urls {
     PNLiteTrackingManagerItem *result = nil;
     NSMutableArray *queue = [PNLiteTrackingManager queueForKey:key];
-    if (queue.count > 0) {
-        result = [[PNLiteTrackingManagerItem alloc] initWithDictionary:queue[0]];
-        [queue removeObjectAtIndex:0];
-        [PNLiteTrackingManager setQueue:queue forKey:key];
+    for (NSUInteger index = 0; index < queue.count; index++) {
+        PNLiteTrackingManagerItem *item = [[PNLiteTrackingManagerItem alloc] initWithDictionary:queue[index]];
+        if ((!item.orderingKey || ![orderingKeys containsObject:item.orderingKey]) && (!item.url || ![urls containsObject:item.url])) {
+            result = item;
+            [queue removeObjectAtIndex:index];
+            [PNLiteTrackingManager setQueue:queue forKey:key];
+            break;
+        }
     }
     return result;
 }
@@ -143,19 +275,42 @@ NSTimeInterval const PNLiteTrackingManagerItemValidTime    = 1800;
                                               forKey:key];
 }
 
+#pragma mark PNLiteBeaconBatcherDelegate
+
+- (void)batcher:(PNLiteBeaconBatcher *)batcher didFailToDeliverURLs:(NSArray<NSURL *> *)urls {
+    for (NSURL *url in urls) {
+        PNLiteTrackingManagerItem *item = [[PNLiteTrackingManagerItem alloc] initWithURL:url];
+        [PNLiteTrackingManager enqueueItem:item withQueueKey:PNLiteTrackingManagerQueueKey];
+    }
+    [self trackNextItems];
+}
+
+- (void)batcher:(PNLiteBeaconBatcher *)batcher didDeliverURLs:(NSArray<NSURL *> *)urls {
+    [self updateBackgroundTask];
+}
+
+#pragma mark PNLiteTrackingRetrySchedulerDelegate
+
+- (void)retryScheduler:(PNLiteTrackingRetryScheduler *)scheduler didReleaseItems:(NSArray<PNLiteTrackingManagerItem *> *)items {
+    for (PNLiteTrackingManagerItem *item in items) {
+        [PNLiteTrackingManager enqueueItem:item withQueueKey:PNLiteTrackingManagerQueueKey];
+    }
+    [self trackNextItems];
+}
+
 #pragma mark PNLiteHttpRequestDelegate
 
 - (void)request:(PNLiteHttpRequest *)request didFinishWithData:(NSData *)data statusCode:(NSInteger)statusCode {
-    self.isRunning = NO;
-    [self trackNextItem];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self finishTrackingWithRequest:request statusCode:statusCode error:nil];
+    });
 }
 
 - (void)request:(PNLiteHttpRequest *)request didFailWithError:(NSError *)error {
     [HyBidLogger errorLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Track Request %@ failed with error: %@",request, error.localizedDescription]];
-    [PNLiteTrackingManager enqueueItem:self.currentItem withQueueKey:PNLiteTrackingManagerFailedQueueKey];
-    self.isRunning = NO;
-    [self trackNextItem];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self finishTrackingWithRequest:request statusCode:0 error:error];
+    });
 }
 
-
 @end
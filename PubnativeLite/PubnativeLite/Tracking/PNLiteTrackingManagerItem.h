@@ -26,8 +26,22 @@
 
 @property (nonatomic, strong) NSURL *url;
 @property (nonatomic, strong )NSNumber *timestamp;
+@property (nonatomic, strong) NSNumber *uptime;
+@property (nonatomic, strong) NSNumber *bootTime;
+@property (nonatomic, strong) NSNumber *attempts;
+@property (nonatomic, strong) NSNumber *nextAttemptUptime;
+@property (nonatomic, strong) NSString *orderingKey;
+// Only set when someone waits for the outcome of the item
+@property (nonatomic, strong) NSString *identifier;
 
 - (NSDictionary *)toDictionary;
 - (instancetype)initWithDictionary:(NSDictionary *)dictionary;
+- (instancetype)initWithURL:(NSURL *)url;
+
+/**
+ Seconds since the item was created. Measured on the monotonic clock when the item was created
+ during the current boot, falling back to the wall clock otherwise.
+ */
+- (NSTimeInterval)age;
 
 @end
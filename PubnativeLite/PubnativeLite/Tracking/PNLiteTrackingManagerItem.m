@@ -20,15 +20,40 @@
 //  THE SOFTWARE.
 //
 #import "PNLiteTrackingManagerItem.h"
+#import "PNLiteMonotonicClock.h"
 
 NSString * const PNLiteTrackingManagerURLKey = @"url";
 NSString * const PNLiteTrackingManagerTimestampKey = @"timestamp";
+NSString * const PNLiteTrackingManagerUptimeKey = @"uptime";
+NSString * const PNLiteTrackingManagerBootTimeKey = @"bootTime";
+NSString * const PNLiteTrackingManagerAttemptsKey = @"attempts";
+NSString * const PNLiteTrackingManagerNextAttemptUptimeKey = @"nextAttemptUptime";
+NSString * const PNLiteTrackingManagerOrderingKey = @"orderingKey";
+NSString * const PNLiteTrackingManagerIdentifierKey = @"identifier";
 
 @implementation PNLiteTrackingManagerItem
 
 - (void)dealloc {
     self.url = nil;
     self.timestamp = nil;
+    self.uptime = nil;
+    self.bootTime = nil;
+    self.attempts = nil;
+    self.nextAttemptUptime = nil;
+    self.orderingKey = nil;
+    self.identifier = nil;
+}
+
+- (instancetype)initWithURL:(NSURL *)url {
+    self = [self init];
+    if (self) {
+        self.url = url;
+        self.timestamp = [NSNumber numberWithDouble:[[NSDate date] timeIntervalSince1970]];
+        self.uptime = [NSNumber numberWithDouble:[PNLiteMonotonicClock uptime]];
+        self.bootTime = [NSNumber numberWithDouble:[PNLiteMonotonicClock bootTime]];
+        self.attempts = @0;
+    }
+    return self;
 }
 
 - (instancetype)initWithDictionary:(NSDictionary *)dictionary {
@@ -36,13 +61,43 @@ NSString * const PNLiteTrackingManagerTimestampKey = @"timestamp";
     if (self) {
         self.url = [NSURL URLWithString:dictionary[PNLiteTrackingManagerURLKey]];
         self.timestamp = dictionary[PNLiteTrackingManagerTimestampKey];
+        self.uptime = dictionary[PNLiteTrackingManagerUptimeKey];
+        self.bootTime = dictionary[PNLiteTrackingManagerBootTimeKey];
+        self.attempts = dictionary[PNLiteTrackingManagerAttemptsKey] ? dictionary[PNLiteTrackingManagerAttemptsKey] : @0;
+        self.nextAttemptUptime = dictionary[PNLiteTrackingManagerNextAttemptUptimeKey];
+        self.orderingKey = dictionary[PNLiteTrackingManagerOrderingKey];
+        self.identifier = dictionary[PNLiteTrackingManagerIdentifierKey];
     }
     return self;
 }
 
 - (NSDictionary *)toDictionary {
-    return @{ PNLiteTrackingManagerURLKey : [self.url absoluteString],
-              PNLiteTrackingManagerTimestampKey : self.timestamp };
+    NSMutableDictionary *result = [NSMutableDictionary dictionary];
+    result[PNLiteTrackingManagerURLKey] = [self.url absoluteString];
+    result[PNLiteTrackingManagerTimestampKey] = self.timestamp;
+    result[PNLiteTrackingManagerAttemptsKey] = self.attempts;
+    if (self.uptime && self.bootTime) {
+        result[PNLiteTrackingManagerUptimeKey] = self.uptime;
+        result[PNLiteTrackingManagerBootTimeKey] = self.bootTime;
+    }
+    if (self.nextAttemptUptime) {
+        result[PNLiteTrackingManagerNextAttemptUptimeKey] = self.nextAttemptUptime;
+    }
+    if (self.orderingKey) {
+        result[PNLiteTrackingManagerOrderingKey] = self.orderingKey;
+    }
+    if (self.identifier) {
+        result[PNLiteTrackingManagerIdentifierKey] = self.identifier;
+    }
+    return result;
+}
+
+- (NSTimeInterval)age {
+    if (self.uptime && [PNLiteMonotonicClock isCurrentBootTime:[self.bootTime doubleValue]]) {
+        return [PNLiteMonotonicClock uptime] - [self.uptime doubleValue];
+    } else {
+        return [[NSDate date] timeIntervalSince1970] - [self.timestamp doubleValue];
+    }
 }
 
 @end
@@ -0,0 +1,54 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import "PNLiteTrackingManagerItem.h"
+
+@class PNLiteTrackingRetryScheduler;
+
+@protocol PNLiteTrackingRetrySchedulerDelegate <NSObject>
+
+- (void)retryScheduler:(PNLiteTrackingRetryScheduler *)scheduler didReleaseItems:(NSArray<PNLiteTrackingManagerItem *> *)items;
+
+@end
+
+@interface PNLiteTrackingRetryScheduler : NSObject
+
+@property (nonatomic, weak) NSObject<PNLiteTrackingRetrySchedulerDelegate> *delegate;
+
+/**
+ Items are persisted under the given key so pending retries survive app restarts.
+ */
+- (instancetype)initWithQueueKey:(NSString *)queueKey validTime:(NSTimeInterval)validTime;
+
+/**
+ Schedules the item for another attempt with exponential backoff. Items that ran out of attempts
+ or outlived the valid time are dropped. Failures while offline don't count as attempts.
+ */
+- (void)scheduleItem:(PNLiteTrackingManagerItem *)item;
+
+/**
+ Starts watching reachability and releases persisted items that are already due.
+ */
+- (void)start;
+
+@end
@@ -0,0 +1,188 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteTrackingRetryScheduler.h"
+#import "PNLiteMonotonicClock.h"
+#import "PNLiteReachability.h"
+#import "HyBidLogger.h"
+
+NSTimeInterval const PNLiteTrackingRetrySchedulerBaseDelay = 5;
+NSTimeInterval const PNLiteTrackingRetrySchedulerMaxDelay = 300;
+NSInteger const PNLiteTrackingRetrySchedulerMaxAttempts = 5;
+
+@interface PNLiteTrackingRetryScheduler ()
+
+@property (nonatomic, strong) NSString *queueKey;
+@property (nonatomic, assign) NSTimeInterval validTime;
+@property (nonatomic, strong) PNLiteReachability *reachability;
+@property (nonatomic, strong) dispatch_source_t timer;
+@property (nonatomic, assign) BOOL isOffline;
+
+@end
+
+@implementation PNLiteTrackingRetryScheduler
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [self.reachability stopNotifier];
+    if (self.timer) {
+        dispatch_source_cancel(self.timer);
+    }
+    self.reachability = nil;
+    self.timer = nil;
+    self.queueKey = nil;
+}
+
+- (instancetype)initWithQueueKey:(NSString *)queueKey validTime:(NSTimeInterval)validTime {
+    self = [super init];
+    if (self) {
+        self.queueKey = queueKey;
+        self.validTime = validTime;
+    }
+    return self;
+}
+
+- (void)start {
+    if (self.reachability) {
+        return;
+    }
+    self.reachability = [PNLiteReachability reachabilityForInternetConnection];
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(reachabilityChanged:)
+                                                 name:PNLiteReachabilityChangedNotification
+                                               object:self.reachability];
+    [self.reachability startNotifier];
+    self.isOffline = [self.reachability currentReachabilityStatus] == PNLiteNetworkStatus_NotReachable;
+    [self releaseDueItems];
+}
+
+- (void)scheduleItem:(PNLiteTrackingManagerItem *)item {
+    if (!item) {
+        return;
+    }
+    if (!self.isOffline) {
+        item.attempts = @([item.attempts integerValue] + 1);
+    }
+    NSInteger attempts = [item.attempts integerValue];
+    if (attempts >= PNLiteTrackingRetrySchedulerMaxAttempts || [item age] >= self.validTime) {
+        [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Dropping beacon after %ld attempts: %@", (long)attempts, item.url]];
+        return;
+    }
+    
+    // Equal jitter: half the delay is kept so retries still back off, the other half is random
+    // so beacons that failed together don't retry in lockstep
+    NSTimeInterval delay = MIN(PNLiteTrackingRetrySchedulerMaxDelay, PNLiteTrackingRetrySchedulerBaseDelay * pow(2, MAX(0, attempts - 1)));
+    delay = delay / 2 + arc4random_uniform((uint32_t)(delay * 500)) / 1000.0;
+    item.nextAttemptUptime = @([PNLiteMonotonicClock uptime] + delay);
+    
+    NSMutableArray *queue = [self queue];
+    [queue addObject:[item toDictionary]];
+    [self setQueue:queue];
+    [self armTimer];
+}
+
+#pragma mark Scheduling
+
+- (void)releaseDueItems {
+    if (self.isOffline) {
+        return;
+    }
+    NSTimeInterval now = [PNLiteMonotonicClock uptime];
+    NSMutableArray *pending = [NSMutableArray array];
+    NSMutableArray *dueItems = [NSMutableArray array];
+    for (NSDictionary *dictionary in [self queue]) {
+        PNLiteTrackingManagerItem *item = [[PNLiteTrackingManagerItem alloc] initWithDictionary:dictionary];
+        if ([item age] >= self.validTime) {
+            continue;
+        }
+        // Uptimes recorded before a reboot are meaningless now, so those items are due right away
+        BOOL sameBoot = [PNLiteMonotonicClock isCurrentBootTime:[item.bootTime doubleValue]];
+        if (!sameBoot || !item.nextAttemptUptime || [item.nextAttemptUptime doubleValue] <= now) {
+            [dueItems addObject:item];
+        } else {
+            [pending addObject:dictionary];
+        }
+    }
+    [self setQueue:pending];
+    if (dueItems.count > 0 && self.delegate && [self.delegate respondsToSelector:@selector(retryScheduler:didReleaseItems:)]) {
+        [self.delegate retryScheduler:self didReleaseItems:dueItems];
+    }
+    [self armTimer];
+}
+
+- (void)armTimer {
+    if (self.timer) {
+        dispatch_source_cancel(self.timer);
+        self.timer = nil;
+    }
+    if (self.isOffline) {
+        // Nothing can go out until reachability comes back
+        return;
+    }
+    NSTimeInterval nextAttempt = DBL_MAX;
+    for (NSDictionary *dictionary in [self queue]) {
+        PNLiteTrackingManagerItem *item = [[PNLiteTrackingManagerItem alloc] initWithDictionary:dictionary];
+        nextAttempt = MIN(nextAttempt, [item.nextAttemptUptime doubleValue]);
+    }
+    if (nextAttempt == DBL_MAX) {
+        return;
+    }
+    NSTimeInterval delay = MAX(0, nextAttempt - [PNLiteMonotonicClock uptime]);
+    __weak typeof(self) weakSelf = self;
+    self.timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+    dispatch_source_set_timer(self.timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), DISPATCH_TIME_FOREVER, (uint64_t)(NSEC_PER_SEC / 2));
+    dispatch_source_set_event_handler(self.timer, ^{
+        [weakSelf releaseDueItems];
+    });
+    dispatch_resume(self.timer);
+}
+
+- (void)reachabilityChanged:(NSNotification *)notification {
+    BOOL wasOffline = self.isOffline;
+    self.isOffline = [self.reachability currentReachabilityStatus] == PNLiteNetworkStatus_NotReachable;
+    if (wasOffline && !self.isOffline) {
+        // Back online: anything that was waiting on connectivity goes out now
+        NSMutableArray *queue = [NSMutableArray array];
+        for (NSDictionary *dictionary in [self queue]) {
+            PNLiteTrackingManagerItem *item = [[PNLiteTrackingManagerItem alloc] initWithDictionary:dictionary];
+            item.nextAttemptUptime = nil;
+            [queue addObject:[item toDictionary]];
+        }
+        [self setQueue:queue];
+        [self releaseDueItems];
+    } else {
+        [self armTimer];
+    }
+}
+
+#pragma mark Queue
+
+- (NSMutableArray *)queue {
+    NSArray *queue = [[NSUserDefaults standardUserDefaults] objectForKey:self.queueKey];
+    return queue ? [queue mutableCopy] : [NSMutableArray array];
+}
+
+- (void)setQueue:(NSArray *)queue {
+    [[NSUserDefaults standardUserDefaults] setObject:queue forKey:self.queueKey];
+}
+
+@end
@@ -0,0 +1,74 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+/**
+ Upper bound on the occluders recorded per view, this keeps a check bounded no matter how busy the hierarchy is.
+ */
+#define PNLiteVisibilityMaxOccluders 16
+
+/**
+ Plain copy of the UIKit state a visibility check needs, so the maths can run off the main thread.
+ */
+typedef struct {
+    CGRect frameInWindow;
+    CGRect windowBounds;
+    CGRect clipRect;
+    CGFloat area;
+    CGFloat minVisibility;
+    BOOL isAttached;
+    BOOL isHidden;
+    BOOL hasWindow;
+    NSUInteger occluderCount;
+    CGRect occluders[PNLiteVisibilityMaxOccluders];
+} PNLiteVisibilitySnapshot;
+
+@interface PNLiteVisibilityGeometry : NSObject
+
+/**
+ Reads the view's geometry in a single walk up its ancestors, clipping it by every ancestor that clips to bounds and collecting the opaque views drawn above it. Must be called on the main thread.
+ */
++ (PNLiteVisibilitySnapshot)snapshotForView:(UIView *)view withMinVisibility:(CGFloat)minVisibility;
+
+/**
+ Pure geometry on a snapshot, safe to call from any thread.
+ */
++ (BOOL)isVisibleSnapshot:(PNLiteVisibilitySnapshot)snapshot;
+
+/**
+ Area of the view left on screen once clipping and occluders are taken out, in window points.
+ */
++ (CGFloat)exposedAreaForSnapshot:(PNLiteVisibilitySnapshot)snapshot;
+
+/**
+ Exposed area as a percentage (0-100) of the view's on-screen size, safe to call from any thread.
+ */
++ (CGFloat)exposurePercentageForSnapshot:(PNLiteVisibilitySnapshot)snapshot;
+
+/**
+ Convenience for callers on the main thread, like MRAID, that only need the current exposure of a view.
+ */
++ (CGFloat)exposurePercentageForView:(UIView *)view;
+
+@end
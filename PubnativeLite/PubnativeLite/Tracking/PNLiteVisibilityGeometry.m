@@ -0,0 +1,217 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteVisibilityGeometry.h"
+
+// Views this transparent are not drawn by UIKit, matching its own hit-testing cutoff
+CGFloat const kPNLiteVisibilityMinAlpha = 0.01f;
+// Hard cap on the views inspected when looking for occluders, so a check stays bounded
+NSUInteger const kPNLiteVisibilityMaxInspectedViews = 64;
+
+static CGFloat PNLiteRectArea(CGRect rect) {
+    return CGRectIsNull(rect) || CGRectIsEmpty(rect) ? 0 : CGRectGetWidth(rect) * CGRectGetHeight(rect);
+}
+
+static int PNLiteCompareFloats(const void *a, const void *b) {
+    CGFloat left = *(const CGFloat *)a;
+    CGFloat right = *(const CGFloat *)b;
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+/**
+ Area of the union of up to PNLiteVisibilityMaxOccluders rectangles. Sweeps across the x edges and, for
+ every strip between two edges, merges the y intervals of the rectangles covering it: O(n² log n) for n rects.
+ */
+static CGFloat PNLiteUnionArea(const CGRect *rects, NSUInteger count) {
+    if (count == 0) {
+        return 0;
+    }
+    CGFloat edges[PNLiteVisibilityMaxOccluders * 2];
+    for (NSUInteger i = 0; i < count; i++) {
+        edges[i * 2] = CGRectGetMinX(rects[i]);
+        edges[i * 2 + 1] = CGRectGetMaxX(rects[i]);
+    }
+    qsort(edges, count * 2, sizeof(CGFloat), PNLiteCompareFloats);
+    
+    CGFloat area = 0;
+    CGFloat intervals[PNLiteVisibilityMaxOccluders][2];
+    for (NSUInteger e = 0; e + 1 < count * 2; e++) {
+        CGFloat left = edges[e];
+        CGFloat width = edges[e + 1] - left;
+        if (width <= 0) {
+            continue;
+        }
+        NSUInteger intervalCount = 0;
+        for (NSUInteger i = 0; i < count; i++) {
+            if (CGRectGetMinX(rects[i]) <= left && CGRectGetMaxX(rects[i]) >= edges[e + 1]) {
+                intervals[intervalCount][0] = CGRectGetMinY(rects[i]);
+                intervals[intervalCount][1] = CGRectGetMaxY(rects[i]);
+                intervalCount++;
+            }
+        }
+        qsort(intervals, intervalCount, sizeof(intervals[0]), PNLiteCompareFloats);
+        CGFloat covered = 0;
+        CGFloat start = 0;
+        CGFloat end = 0;
+        for (NSUInteger i = 0; i < intervalCount; i++) {
+            if (i == 0 || intervals[i][0] > end) {
+                covered += end - start;
+                start = intervals[i][0];
+                end = intervals[i][1];
+            } else if (intervals[i][1] > end) {
+                end = intervals[i][1];
+            }
+        }
+        covered += end - start;
+        area += covered * width;
+    }
+    return area;
+}
+
+@implementation PNLiteVisibilityGeometry
+
++ (PNLiteVisibilitySnapshot)snapshotForView:(UIView *)view withMinVisibility:(CGFloat)minVisibility {
+    PNLiteVisibilitySnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.minVisibility = minVisibility;
+    snapshot.isAttached = view != nil && view.superview != nil;
+    if (!snapshot.isAttached) {
+        return snapshot;
+    }
+    
+    snapshot.isHidden = view.hidden || view.alpha < kPNLiteVisibilityMinAlpha;
+    UIWindow *window = nil;
+    UIView *ancestor = view.superview;
+    while (ancestor) {
+        if (ancestor.hidden || ancestor.alpha < kPNLiteVisibilityMinAlpha) {
+            snapshot.isHidden = YES;
+        }
+        if (!window && [ancestor isKindOfClass:[UIWindow class]]) {
+            window = (UIWindow *)ancestor;
+        }
+        ancestor = ancestor.superview;
+    }
+    
+    snapshot.area = CGRectGetWidth(view.bounds) * CGRectGetHeight(view.bounds);
+    if (!window || snapshot.isHidden) {
+        return snapshot;
+    }
+    
+    snapshot.hasWindow = YES;
+    snapshot.windowBounds = window.bounds;
+    // We need to call convertRect:toView: on this view's superview rather than on this view itself.
+    // Transformed views come back as their axis-aligned bounding box, which is what is measured.
+    snapshot.frameInWindow = [view.superview convertRect:view.frame toView:window];
+    snapshot.area = PNLiteRectArea(snapshot.frameInWindow);
+    
+    // Clip by the window and by every ancestor that clips its content, scroll views included
+    CGRect clipRect = CGRectIntersection(snapshot.frameInWindow, snapshot.windowBounds);
+    for (ancestor = view.superview; ancestor && ancestor != window && !CGRectIsNull(clipRect); ancestor = ancestor.superview) {
+        if (ancestor.clipsToBounds) {
+            clipRect = CGRectIntersection(clipRect, [ancestor convertRect:ancestor.bounds toView:window]);
+        }
+    }
+    snapshot.clipRect = clipRect;
+    if (PNLiteRectArea(clipRect) == 0) {
+        return snapshot;
+    }
+    
+    // Anything drawn after the view or one of its ancestors sits above it
+    NSUInteger budget = kPNLiteVisibilityMaxInspectedViews;
+    UIView *current = view;
+    while (current != window && current.superview) {
+        NSArray<UIView *> *siblings = current.superview.subviews;
+        NSUInteger index = [siblings indexOfObjectIdenticalTo:current];
+        for (NSUInteger i = index + 1; i < siblings.count; i++) {
+            [self collectOccludersFromView:siblings[i] inWindow:window withClipRect:clipRect intoSnapshot:&snapshot budget:&budget];
+        }
+        current = current.superview;
+    }
+    return snapshot;
+}
+
++ (void)collectOccludersFromView:(UIView *)candidate
+                        inWindow:(UIWindow *)window
+                    withClipRect:(CGRect)clipRect
+                    intoSnapshot:(PNLiteVisibilitySnapshot *)snapshot
+                          budget:(NSUInteger *)budget {
+    if (*budget == 0 || snapshot->occluderCount >= PNLiteVisibilityMaxOccluders) {
+        return;
+    }
+    (*budget)--;
+    if (candidate.hidden || candidate.alpha < kPNLiteVisibilityMinAlpha) {
+        return;
+    }
+    
+    CGRect covered = CGRectIntersection([candidate convertRect:candidate.bounds toView:window], clipRect);
+    BOOL intersects = PNLiteRectArea(covered) > 0;
+    if (intersects && [self isOpaqueView:candidate]) {
+        snapshot->occluders[snapshot->occluderCount++] = covered;
+        if (candidate.clipsToBounds) {
+            // Its subviews can't draw outside of what it already covers
+            return;
+        }
+    } else if (!intersects && candidate.clipsToBounds) {
+        return;
+    }
+    
+    // A transparent container can still hold opaque content
+    CGRect childClipRect = candidate.clipsToBounds ? covered : clipRect;
+    for (UIView *subview in candidate.subviews) {
+        [self collectOccludersFromView:subview inWindow:window withClipRect:childClipRect intoSnapshot:snapshot budget:budget];
+    }
+}
+
++ (BOOL)isOpaqueView:(UIView *)view {
+    if (view.alpha < 1 || !view.backgroundColor) {
+        return NO;
+    }
+    return CGColorGetAlpha(view.backgroundColor.CGColor) >= 1;
+}
+
++ (BOOL)isVisibleSnapshot:(PNLiteVisibilitySnapshot)snapshot {
+    if (!snapshot.isAttached || snapshot.isHidden || !snapshot.hasWindow || snapshot.area <= 0) {
+        return NO;
+    }
+    return [self exposedAreaForSnapshot:snapshot] >= (snapshot.area * snapshot.minVisibility);
+}
+
++ (CGFloat)exposedAreaForSnapshot:(PNLiteVisibilitySnapshot)snapshot {
+    if (!snapshot.isAttached || snapshot.isHidden || !snapshot.hasWindow) {
+        return 0;
+    }
+    CGFloat exposedArea = PNLiteRectArea(snapshot.clipRect) - PNLiteUnionArea(snapshot.occluders, snapshot.occluderCount);
+    return MAX(exposedArea, 0);
+}
+
++ (CGFloat)exposurePercentageForSnapshot:(PNLiteVisibilitySnapshot)snapshot {
+    if (snapshot.area <= 0) {
+        return 0;
+    }
+    return MIN([self exposedAreaForSnapshot:snapshot] / snapshot.area, 1) * 100;
+}
+
++ (CGFloat)exposurePercentageForView:(UIView *)view {
+    return [self exposurePercentageForSnapshot:[self snapshotForView:view withMinVisibility:0]];
+}
+
+@end
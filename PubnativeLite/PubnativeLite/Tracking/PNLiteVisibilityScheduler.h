@@ -0,0 +1,46 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+
+extern NSInteger const PNLiteVisibilitySchedulerFramesPerSecond;
+
+@class PNLiteVisibilityScheduler;
+
+@protocol PNLiteVisibilitySchedulerObserver <NSObject>
+
+- (void)visibilitySchedulerDidTick:(PNLiteVisibilityScheduler *)scheduler;
+
+@end
+
+/**
+ Drives every visibility and impression check in the process from one display link on the main
+ thread. Observers are held weakly and the display link only runs while there is at least one.
+ */
+@interface PNLiteVisibilityScheduler : NSObject
+
++ (instancetype)sharedInstance;
+
+- (void)addObserver:(NSObject<PNLiteVisibilitySchedulerObserver> *)observer;
+- (void)removeObserver:(NSObject<PNLiteVisibilitySchedulerObserver> *)observer;
+
+@end
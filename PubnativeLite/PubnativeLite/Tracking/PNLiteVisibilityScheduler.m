@@ -0,0 +1,118 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteVisibilityScheduler.h"
+#import <QuartzCore/QuartzCore.h>
+
+NSInteger const PNLiteVisibilitySchedulerFramesPerSecond = 10;
+
+@interface PNLiteVisibilityScheduler ()
+
+@property (nonatomic, strong) NSHashTable<NSObject<PNLiteVisibilitySchedulerObserver> *> *observers;
+@property (nonatomic, strong) CADisplayLink *displayLink;
+
+@end
+
+@implementation PNLiteVisibilityScheduler
+
+- (void)dealloc {
+    [self.displayLink invalidate];
+    self.displayLink = nil;
+    self.observers = nil;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        self.observers = [NSHashTable weakObjectsHashTable];
+    }
+    return self;
+}
+
++ (instancetype)sharedInstance {
+    static PNLiteVisibilityScheduler *instance;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[PNLiteVisibilityScheduler alloc] init];
+    });
+    return instance;
+}
+
+- (void)addObserver:(NSObject<PNLiteVisibilitySchedulerObserver> *)observer {
+    if (!observer) {
+        return;
+    }
+    [self performOnMainThread:^{
+        [self.observers addObject:observer];
+        [self updateDisplayLink];
+    }];
+}
+
+- (void)removeObserver:(NSObject<PNLiteVisibilitySchedulerObserver> *)observer {
+    if (!observer) {
+        return;
+    }
+    [self performOnMainThread:^{
+        [self.observers removeObject:observer];
+        [self updateDisplayLink];
+    }];
+}
+
+- (void)performOnMainThread:(dispatch_block_t)block {
+    if ([NSThread isMainThread]) {
+        block();
+    } else {
+        dispatch_async(dispatch_get_main_queue(), block);
+    }
+}
+
+#pragma mark Display Link
+
+- (void)updateDisplayLink {
+    if (self.observers.count > 0 && !self.displayLink) {
+        self.displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(tick:)];
+        if (@available(iOS 10.0, *)) {
+            self.displayLink.preferredFramesPerSecond = PNLiteVisibilitySchedulerFramesPerSecond;
+        } else {
+            self.displayLink.frameInterval = 60 / PNLiteVisibilitySchedulerFramesPerSecond;
+        }
+        // Common modes keep checks running while the user is scrolling a feed
+        [self.displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+    } else if (self.observers.count == 0 && self.displayLink) {
+        [self.displayLink invalidate];
+        self.displayLink = nil;
+    }
+}
+
+- (void)tick:(CADisplayLink *)displayLink {
+    // Observers may unregister themselves while being notified, so iterate over a copy
+    for (NSObject<PNLiteVisibilitySchedulerObserver> *observer in self.observers.allObjects) {
+        [observer visibilitySchedulerDidTick:self];
+    }
+    // Weak entries of deallocated observers only disappear from allObjects, not from count
+    if (self.observers.allObjects.count == 0) {
+        [self.observers removeAllObjects];
+        [self updateDisplayLink];
+    }
+}
+
+@end
@@ -25,6 +25,7 @@
 @interface PNLiteCryptoUtils : NSObject
 
 + (NSString *)md5WithString:(NSString *)text;
++ (NSString *)md5WithData:(NSData *)data;
 + (NSString *)sha1WithString:(NSString *)text;
 
 @end
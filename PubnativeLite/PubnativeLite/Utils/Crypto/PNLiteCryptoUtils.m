@@ -39,6 +39,18 @@
     return result;
 }
 
++ (NSString *)md5WithData:(NSData *)data {
+    if (data.length <= 0) { return nil; }
+    
+    unsigned char hash[CC_MD5_DIGEST_LENGTH];
+    CC_MD5(data.bytes, (CC_LONG)data.length, hash);
+    NSMutableString *hashString = [[NSMutableString alloc] initWithCapacity:CC_MD5_DIGEST_LENGTH * 2];
+    for (int i = 0; i < CC_MD5_DIGEST_LENGTH; ++i) {
+        [hashString appendFormat:@"%02X", hash[i]];
+    }
+    return [NSString stringWithString:hashString];
+}
+
 + (NSString *)sha1WithString:(NSString *)text {
     const char *cstr = [text cStringUsingEncoding:NSUTF8StringEncoding];
     NSData *data = [NSData dataWithBytes:cstr length:text.length];
@@ -50,6 +50,8 @@ typedef enum : NSInteger {
 - (id)initWithEvents:(NSDictionary *)events delegate:(id<PNLiteVASTEventProcessorDelegate>)delegate;
 // sends the given VASTEvent
 - (void)trackEvent:(PNLiteVASTEvent)event;
+// sends events that happen at the same moment, their URLs go out as one batch
+- (void)trackEvents:(NSArray<NSNumber *> *)events;
 // sends the set of http requests to supplied URLs, used for Impressions, ClickTracking, and Errors.
 - (void)sendVASTUrls:(NSArray *)urls;
 
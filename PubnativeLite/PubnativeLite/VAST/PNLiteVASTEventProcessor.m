@@ -22,7 +22,8 @@
 
 #import "PNLiteVASTEventProcessor.h"
 #import "HyBidLogger.h"
-#import "HyBidWebBrowserUserAgentInfo.h"
+#import "PNLiteTrackingManager.h"
+#import "PNLiteVASTMacros.h"
 
 @interface PNLiteVASTEventProcessor()
 
@@ -48,6 +49,32 @@
 }
 
 - (void)trackEvent:(PNLiteVASTEvent)event {
+    [self trackEvents:@[@(event)]];
+}
+
+- (void)trackEvents:(NSArray<NSNumber *> *)events {
+    NSMutableArray<NSURL *> *eventUrls = [NSMutableArray array];
+    for (NSNumber *eventNumber in events) {
+        PNLiteVASTEvent event = (PNLiteVASTEvent)eventNumber.integerValue;
+        NSString *eventString = [self stringForEvent:event];
+        [self invokeDidTrackEvent:event];
+        if(!eventString) {
+            [self invokeDidTrackEvent:PNLiteVASTEvent_Unknown];
+        } else {
+            for (NSURL *templateUrl in self.events[eventString]) {
+                NSURL *eventUrl = [NSURL URLWithString:[PNLiteVASTMacros expandMacrosInURLString:templateUrl.absoluteString]];
+                if (!eventUrl) {
+                    continue;
+                }
+                [eventUrls addObject:eventUrl];
+                [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Sent event '%@' to url: %@", eventString, [eventUrl absoluteString]]];
+            }
+        }
+    }
+    [PNLiteTrackingManager trackWithURLs:eventUrls];
+}
+
+- (NSString *)stringForEvent:(PNLiteVASTEvent)event {
     NSString *eventString = nil;
     switch (event) {
         case PNLiteVASTEvent_Start:           eventString = @"start";           break;
@@ -60,15 +87,7 @@
         case PNLiteVASTEvent_Resume:          eventString = @"resume";          break;
         default: break;
     }
-    [self invokeDidTrackEvent:event];
-    if(!eventString) {
-        [self invokeDidTrackEvent:PNLiteVASTEvent_Unknown];
-    } else {
-        for (NSURL *eventUrl in self.events[eventString]) {
-            [self sendTrackingRequest:[eventUrl absoluteString]];
-            [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Sent event '%@' to url: %@", eventString, [eventUrl absoluteString]]];
-        }
-    }
+    return eventString;
 }
 
 - (void)invokeDidTrackEvent:(PNLiteVASTEvent)event {
@@ -78,42 +97,15 @@
 }
 
 - (void)sendVASTUrls:(NSArray *)urls {
+    NSMutableArray<NSURL *> *vastUrls = [NSMutableArray arrayWithCapacity:urls.count];
     for (NSString *stringURL in urls) {
-        [self sendTrackingRequest:stringURL];
-        [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Sent http request to url: %@", stringURL]];
+        NSURL *url = [NSURL URLWithString:[PNLiteVASTMacros expandMacrosInURLString:stringURL]];
+        if (url) {
+            [vastUrls addObject:url];
+            [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Sent http request to url: %@", stringURL]];
+        }
     }
-}
-
-- (void)sendTrackingRequest:(NSString *)url {
-    dispatch_queue_t sendTrackRequestQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
-    dispatch_async(sendTrackRequestQueue, ^{
-        
-        [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Event processor sending request to url: %@", url]];
-        
-        NSURLSession * session = [NSURLSession sharedSession];
-            dispatch_async(dispatch_get_main_queue(), ^{
-                session.configuration.HTTPAdditionalHeaders = @{@"User-Agent": HyBidWebBrowserUserAgentInfo.userAgent};
-                NSURLRequest* request = [NSURLRequest requestWithURL:[NSURL URLWithString:url]
-                                                         cachePolicy:NSURLRequestReloadIgnoringLocalCacheData
-                                                     timeoutInterval:1.0];
-                
-                [[session dataTaskWithRequest:request
-                            completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
-                                
-                                // Send the request only, no response or errors
-                                if(!error) {
-                                    if ([data length] > 0) {
-                                        [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Tracking url %@ response: %@", response.URL, [NSString stringWithUTF8String:[data bytes]]]];
-                                    } else {
-                                        [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Tracking url: %@", response.URL]];
-                                    }
-                                } else {
-                                    [HyBidLogger errorLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Tracking url %@ error: %@", response.URL, error]];
-                                }
-                            }] resume];
-            });
-        
-    });
+    [PNLiteTrackingManager trackWithURLs:vastUrls];
 }
 
 @end
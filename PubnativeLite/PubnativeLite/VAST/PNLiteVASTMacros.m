@@ -0,0 +1,71 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteVASTMacros.h"
+
+@implementation PNLiteVASTMacros
+
++ (NSString *)timestampForDate:(NSDate *)date {
+    static NSDateFormatter *formatter;
+    static NSCharacterSet *allowedCharacters;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        formatter = [[NSDateFormatter alloc] init];
+        formatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        formatter.timeZone = [NSTimeZone timeZoneWithAbbreviation:@"UTC"];
+        formatter.dateFormat = @"yyyy-MM-dd'T'HH:mm:ss.SSS'Z'";
+        NSMutableCharacterSet *characters = [[NSCharacterSet URLQueryAllowedCharacterSet] mutableCopy];
+        [characters removeCharactersInString:@":+"];
+        allowedCharacters = characters;
+    });
+    @synchronized (formatter) {
+        // VAST wants the ISO 8601 timestamp percent-encoded
+        return [[formatter stringFromDate:date] stringByAddingPercentEncodingWithAllowedCharacters:allowedCharacters];
+    }
+}
+
++ (NSString *)expandMacrosInURLString:(NSString *)urlString {
+    NSString *cacheBuster = [NSString stringWithFormat:@"%08u", arc4random_uniform(100000000)];
+    return [self expandMacrosInURLString:urlString withDate:[NSDate date] cacheBuster:cacheBuster];
+}
+
++ (NSString *)expandMacrosInURLString:(NSString *)urlString withDate:(NSDate *)date cacheBuster:(NSString *)cacheBuster {
+    if (!urlString
+        || ([urlString rangeOfString:@"CACHEBUSTING" options:NSCaseInsensitiveSearch].location == NSNotFound
+            && [urlString rangeOfString:@"TIMESTAMP" options:NSCaseInsensitiveSearch].location == NSNotFound)) {
+        return urlString;
+    }
+    NSDictionary<NSString *, NSString *> *values = @{@"CACHEBUSTING": cacheBuster,
+                                                     @"TIMESTAMP": [self timestampForDate:date]};
+    NSMutableString *expanded = [urlString mutableCopy];
+    for (NSString *macro in values) {
+        for (NSString *format in @[@"[%@]", @"%%5B%@%%5D"]) {
+            [expanded replaceOccurrencesOfString:[NSString stringWithFormat:format, macro]
+                                      withString:values[macro]
+                                         options:NSCaseInsensitiveSearch
+                                           range:NSMakeRange(0, expanded.length)];
+        }
+    }
+    return expanded;
+}
+
+@end
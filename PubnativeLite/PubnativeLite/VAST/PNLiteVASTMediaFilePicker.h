@@ -23,9 +23,16 @@
 #import <Foundation/Foundation.h>
 #import "PNLiteVASTMediaFile.h"
 
-// An implementation of how to pick media file from one or more in a VAST Document. VASTMediaFilePicker looks for internet first and eliminate entries with mime type which we can't play in the phone. After that, the list is sorted by bit rate (if exists) along with hi or low speed connection + progressive/streaming attribute. Once we have the final list, we end up picking the first from the list. If you have no valid media file to pick, you will get a nil and that will generate an error to the caller.
+#import <UIKit/UIKit.h>
+
+// An implementation of how to pick media file from one or more in a VAST Document. VASTMediaFilePicker looks for internet first and eliminate entries with mime type which we can't play in the phone. Every remaining file is then scored on how close its size is to the screen, whether its bit rate fits the measured throughput of the connection and its progressive/streaming delivery, and the best scoring one is picked. If you have no valid media file to pick, you will get a nil and that will generate an error to the caller.
 @interface PNLiteVASTMediaFilePicker : NSObject
 
 + (PNLiteVASTMediaFile *)pick:(NSArray *)mediaFiles;
 
+/**
+ Pure selection for a given screen size (in points) and throughput (in kilobits per second), used by pick: with the current device state.
+ */
++ (PNLiteVASTMediaFile *)pick:(NSArray *)mediaFiles forScreenSize:(CGSize)screenSize throughput:(double)throughput;
+
 @end
@@ -22,9 +22,18 @@
 
 #import "PNLiteVASTMediaFilePicker.h"
 #import "PNLiteReachability.h"
-#import <UIKit/UIKit.h>
+#import "PNLiteThroughputEstimator.h"
 #import "HyBidLogger.h"
 
+// Throughput assumed before the SDK has measured any download, in kilobits per second
+double const PNLiteVASTMediaFilePickerDefaultWiFiThroughput = 5000;
+double const PNLiteVASTMediaFilePickerDefaultWWANThroughput = 1500;
+// Share of the throughput a file may use, the rest is headroom so playback doesn't stall on a dip
+double const PNLiteVASTMediaFilePickerThroughputHeadroom = 0.75;
+// Bits per pixel per frame at 30 fps, used to guess the bit rate of files that don't declare one
+double const PNLiteVASTMediaFilePickerBitsPerPixel = 0.1;
+double const PNLiteVASTMediaFilePickerStreamingDeliveryWeight = 0.8;
+
 @interface PNLiteVASTMediaFilePicker()
 
 + (BOOL)isMIMETypeCompatible:(PNLiteVASTMediaFile *)vastMediaFile;
@@ -36,80 +45,96 @@
 + (PNLiteVASTMediaFile *)pick:(NSArray *)mediaFiles {
     // Check whether we even have a network connection.
     // If not, return a nil.
-    if (![PNLiteVASTMediaFilePicker isInternetReachable]) {
+    PNLiteNetworkStatus currentNetwork = [PNLiteVASTMediaFilePicker currentNetworkStatus];
+    if (currentNetwork == PNLiteNetworkStatus_NotReachable) {
         return nil;
     }
     
-    // Go through the provided media files and only those that have a compatible MIME type.
-    NSMutableArray *compatibleMediaFiles = [[NSMutableArray alloc] init];
+    double throughput = [PNLiteThroughputEstimator sharedInstance].estimatedKbps;
+    if (throughput <= 0) {
+        throughput = currentNetwork == PNLiteNetworkStatus_ReachableViaWiFi ? PNLiteVASTMediaFilePickerDefaultWiFiThroughput : PNLiteVASTMediaFilePickerDefaultWWANThroughput;
+    }
+    return [self pick:mediaFiles forScreenSize:[[UIScreen mainScreen] bounds].size throughput:throughput];
+}
+
++ (PNLiteVASTMediaFile *)pick:(NSArray *)mediaFiles forScreenSize:(CGSize)screenSize throughput:(double)throughput {
+    double screenArea = screenSize.width * screenSize.height;
+    PNLiteVASTMediaFile *toReturn = nil;
+    double bestScore = 0;
+    double bestBitrate = 0;
     for (PNLiteVASTMediaFile *vastMediaFile in mediaFiles) {
         // Make sure that you have type specified for mediafile and ignore accordingly
-        if (vastMediaFile.type != nil && [self isMIMETypeCompatible:vastMediaFile]) {
-            [compatibleMediaFiles addObject:vastMediaFile];
+        if (vastMediaFile.type == nil || !vastMediaFile.url || ![self isMIMETypeCompatible:vastMediaFile]) {
+            continue;
         }
-    }
-    if ([compatibleMediaFiles count] == 0) {
-        return nil;
-    }
-    
-    // Sort the media files based on their video size (in square pixels).
-    NSArray *sortedMediaFiles = [compatibleMediaFiles sortedArrayUsingComparator:^NSComparisonResult(id a, id b) {
-        PNLiteVASTMediaFile *mf1 = (PNLiteVASTMediaFile *)a;
-        PNLiteVASTMediaFile *mf2 = (PNLiteVASTMediaFile *)b;
-        int area1 = mf1.width * mf1.height;
-        int area2 = mf2.width * mf2.height;
-        if (area1 < area2) {
-            return NSOrderedAscending;
-        } else if (area1 > area2) {
-            return NSOrderedDescending;
-        } else {
-            return NSOrderedSame;
+        double bitrate = [self bitrateForMediaFile:vastMediaFile];
+        double score = [self scoreForMediaFile:vastMediaFile bitrate:bitrate screenArea:screenArea throughput:throughput];
+        // On a tie the lighter file wins, it starts sooner
+        if (!toReturn || score > bestScore || (score == bestScore && bitrate < bestBitrate)) {
+            toReturn = vastMediaFile;
+            bestScore = score;
+            bestBitrate = bitrate;
         }
-    }];
+    }
     
-    // Pick the media file with the video size closes to the device's screen size.
-    CGSize screenSize = [[UIScreen mainScreen] bounds].size;
-    int screenArea = screenSize.width * screenSize.height;
-    int bestMatch = 0;
-    int bestMatchDiff = INT_MAX;
-    int len = (int)[sortedMediaFiles count];
+    if (toReturn) {
+        [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Selected Media File: %@ (%.0f kbps for %.0f kbps available)", toReturn.url, bestBitrate, throughput]];
+    }
+    return toReturn;
+}
+
+// Declared bit rate in kilobits per second, or a guess from the video size when it is missing
++ (double)bitrateForMediaFile:(PNLiteVASTMediaFile *)vastMediaFile {
+    if (vastMediaFile.bitrate > 0) {
+        return vastMediaFile.bitrate;
+    }
+    double area = (double)vastMediaFile.width * vastMediaFile.height;
+    return area > 0 ? area * 30 * PNLiteVASTMediaFilePickerBitsPerPixel / 1000 : PNLiteVASTMediaFilePickerDefaultWWANThroughput;
+}
+
++ (double)scoreForMediaFile:(PNLiteVASTMediaFile *)vastMediaFile bitrate:(double)bitrate screenArea:(double)screenArea throughput:(double)throughput {
+    // How close the video size is to the screen size, 1 for a perfect match
+    double area = (double)vastMediaFile.width * vastMediaFile.height;
+    double sizeScore = 0.5;
+    if (area > 0 && screenArea > 0) {
+        sizeScore = MIN(area, screenArea) / MAX(area, screenArea);
+    }
     
-    for (int i = 0; i < len; i++) {
-        int videoArea = ((PNLiteVASTMediaFile *)sortedMediaFiles[i]).width * ((PNLiteVASTMediaFile *)sortedMediaFiles[i]).height;
-        int diff = abs(screenArea - videoArea);
-       if (diff >= bestMatchDiff) {
-            break;
-        }
-        bestMatch = i;
-        bestMatchDiff = diff;
+    // A file the connection can't keep up with is going to rebuffer, which is worse than a soft picture
+    double budget = throughput * PNLiteVASTMediaFilePickerThroughputHeadroom;
+    double bitrateScore = 1;
+    if (bitrate > budget) {
+        bitrateScore = budget > 0 ? pow(budget / bitrate, 2) : 0;
     }
     
-    PNLiteVASTMediaFile *toReturn = (PNLiteVASTMediaFile *)sortedMediaFiles[bestMatch];
-    [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"Selected Media File: %@", toReturn.url]];
-    return toReturn;
+    double deliveryScore = 1;
+    if (vastMediaFile.delivery && [vastMediaFile.delivery caseInsensitiveCompare:@"progressive"] != NSOrderedSame) {
+        deliveryScore = PNLiteVASTMediaFilePickerStreamingDeliveryWeight;
+    }
+    return sizeScore * bitrateScore * deliveryScore;
 }
 
-+ (BOOL)isInternetReachable {
-    BOOL result = false;
++ (PNLiteNetworkStatus)currentNetworkStatus {
     PNLiteReachability *reachability = [PNLiteReachability reachabilityForInternetConnection];
     [reachability startNotifier];
     PNLiteNetworkStatus currentNetwork = [reachability currentReachabilityStatus];
     [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"NetworkType: %ld", (long)currentNetwork]];
-    result = currentNetwork != PNLiteNetworkStatus_NotReachable;
     [reachability stopNotifier];
-    return result;}
+    return currentNetwork;
+}
 
 + (BOOL)isMIMETypeCompatible:(PNLiteVASTMediaFile *)vastMediaFile {
-    NSString *pattern = @"(mp4|m4v|quicktime|3gpp)";
-    NSError *error = NULL;
-    NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:pattern
-                                                                           options:NSRegularExpressionCaseInsensitive
-                                                                             error:&error];
-    NSArray *matches = [regex matchesInString:vastMediaFile.type
-                                      options:0
-                                        range:NSMakeRange(0, [vastMediaFile.type length])];
-    
-    return ([matches count] > 0);
+    // Compiled once, the same pattern is checked for every media file of every ad
+    static NSRegularExpression *regex;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        regex = [NSRegularExpression regularExpressionWithPattern:@"(mp4|m4v|quicktime|3gpp)"
+                                                          options:NSRegularExpressionCaseInsensitive
+                                                            error:nil];
+    });
+    return [regex firstMatchInString:vastMediaFile.type
+                             options:0
+                               range:NSMakeRange(0, [vastMediaFile.type length])] != nil;
 }
 
 @end
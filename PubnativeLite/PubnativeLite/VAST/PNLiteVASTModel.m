@@ -22,18 +22,19 @@
 
 #import "PNLiteVASTModel.h"
 #import "PNLiteVASTMediaFile.h"
-#import "PNLiteVASTXMLUtil.h"
+#import "PNLiteVASTParsedDocument.h"
 #import "HyBidLogger.h"
 
 @interface PNLiteVASTModel ()
 
-@property (nonatomic, strong)NSMutableArray *vastDocumentArray;
-
-// returns an array of VASTUrlWithId objects
-- (NSArray *)resultsForQuery:(NSString *)query;
-
-// returns the text content of both simple text and CDATA sections
-- (NSString *)content:(NSDictionary *)node;
+@property (nonatomic, strong) NSString *version;
+@property (nonatomic, strong) NSString *adTagURI;
+@property (nonatomic, strong) NSMutableArray<NSString *> *errorArray;
+@property (nonatomic, strong) NSMutableArray<NSString *> *impressionArray;
+@property (nonatomic, strong) NSString *clickThroughURL;
+@property (nonatomic, strong) NSMutableArray<NSString *> *clickTrackingArray;
+@property (nonatomic, strong) NSMutableDictionary *trackingEventDictionary;
+@property (nonatomic, strong) NSMutableArray *mediaFileArray;
 
 @end
 
@@ -42,217 +43,169 @@
 #pragma mark - "private" method
 
 - (void)dealloc {
-    self.vastDocumentArray = nil;
+    self.version = nil;
+    self.adTagURI = nil;
+    self.errorArray = nil;
+    self.impressionArray = nil;
+    self.clickThroughURL = nil;
+    self.clickTrackingArray = nil;
+    self.trackingEventDictionary = nil;
+    self.mediaFileArray = nil;
 }
 
 // We deliberately do not declare this method in the header file in order to hide it.
 // It should be used only be the VAST2Parser to build the model.
 // It should not be used by anybody else receiving the model object.
-- (void)addVASTDocument:(NSData *)vastDocument {
-    if (!self.vastDocumentArray) {
-        self.vastDocumentArray = [NSMutableArray array];
-    }
-    [self.vastDocumentArray addObject:vastDocument];
+// Every document is streamed once here and merged into the model, so the public accessors are plain field reads.
+- (BOOL)addVASTDocument:(NSData *)vastDocument {
+    return [self addVASTDocument:vastDocument withAdTagURIHandler:nil];
 }
 
-#pragma mark - public methods
+// The handler is called as soon as a wrapper's ad tag URI is known, while the rest of the document is still being read.
+- (BOOL)addVASTDocument:(NSData *)vastDocument withAdTagURIHandler:(void (^)(NSString *adTagURI))handler {
+    PNLiteVASTParsedDocument *parsedDocument = [[PNLiteVASTParsedDocument alloc] initWithData:vastDocument adTagURIHandler:handler];
+    if (!parsedDocument) {
+        return NO;
+    }
+    [self addParsedDocument:parsedDocument];
+    return YES;
+}
 
-- (NSString *)vastVersion {
-    // sanity check
-    if ([self.vastDocumentArray count] == 0) {
-        return nil;
+// Merging copies every string out of the document, so a cached document can be added to many models.
+- (void)addParsedDocument:(PNLiteVASTParsedDocument *)parsedDocument {
+    const PNLiteVASTDocument *document = parsedDocument.document;
+    
+    // the version comes from the first document of the chain
+    if (!self.version) {
+        self.version = [parsedDocument stringForString:document->version];
     }
+    self.adTagURI = [parsedDocument stringForString:document->adTagURI];
     
-    NSString *version;
-    NSString *query = @"/VAST/@version";
-    NSArray *results = performXMLXPathQuery(self.vastDocumentArray[0], query);
-    // there should be only a single result
-    if ([results count] > 0) {
-        NSDictionary *attribute = results[0];
-        version = attribute[@"nodeContent"];
+    NSUInteger impressionCount = 0;
+    for (size_t i = 0; i < document->urlCount; i++) {
+        PNLiteVASTURL url = document->urls[i];
+        NSString *urlString = [parsedDocument stringForString:url.url];
+        switch (url.kind) {
+            case PNLiteVASTURLKindError:
+                self.errorArray = [self array:self.errorArray byAddingString:urlString];
+                break;
+            case PNLiteVASTURLKindImpression:
+                self.impressionArray = [self array:self.impressionArray byAddingString:urlString];
+                impressionCount++;
+                break;
+            case PNLiteVASTURLKindClickThrough:
+                // There should be at most only one ClickThrough in the whole chain.
+                if (!self.clickThroughURL) {
+                    self.clickThroughURL = urlString;
+                }
+                break;
+            case PNLiteVASTURLKindClickTracking:
+                self.clickTrackingArray = [self array:self.clickTrackingArray byAddingString:urlString];
+                break;
+            case PNLiteVASTURLKindTracking:
+                [self addTrackingEvent:[parsedDocument stringForString:url.event] withURLString:urlString];
+                break;
+        }
+    }
+    for (size_t i = 0; i < document->mediaFileCount; i++) {
+        [self addMediaFile:document->mediaFiles[i] fromDocument:parsedDocument];
     }
-    return version;
+    
+    [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"VAST Model added document with %lu impression(s), %lu event(s) and %lu media file(s)", (unsigned long)impressionCount, (unsigned long)[self.trackingEventDictionary count], (unsigned long)[self.mediaFileArray count]]];
+}
+
+#pragma mark - public methods
+
+- (NSString *)vastVersion {
+    return self.version;
 }
 
 - (NSArray<NSString*> *)errors {
-    NSString *query = @"//Error";
-    return [self resultsForQuery:query];
+    return self.errorArray;
 }
 
 - (NSArray<NSString*> *)impressions {
-    NSString *query = @"//Impression";
-    return [self resultsForQuery:query];
+    return self.impressionArray;
 }
 
 - (NSString *)clickThrough {
-    NSString *query = @"//ClickThrough";
-    NSArray *array = [self resultsForQuery:query];
-    // There should be at most only one array element.
-    return ([array count] > 0) ? array[0] : nil;
+    return self.clickThroughURL;
 }
 
 - (NSArray<NSString*> *)clickTracking {
-    NSString *query = @"//ClickTracking";
-    return [self resultsForQuery:query];
+    return self.clickTrackingArray;
 }
 
 - (NSDictionary *)trackingEvents {
-    NSMutableDictionary *eventDict;
-    NSString *query = @"//Linear//Tracking";
-    
-    for (NSData *document in self.vastDocumentArray) {
-        NSArray *results = performXMLXPathQuery(document, query);
-        for (NSDictionary *result in results) {
-            // use lazy initialization
-            if (!eventDict) {
-                eventDict = [NSMutableDictionary dictionary];
-            }
-            NSString *urlString = [self content:result];
-            NSArray *attributes = result[@"nodeAttributeArray"];
-            for (NSDictionary *attribute in attributes) {
-                NSString *name = attribute[@"attributeName"];
-                if ([name isEqualToString:@"event"]) {
-                    NSString *event = attribute[@"nodeContent"];
-                    NSMutableArray *newEventArray = [NSMutableArray array];
-                    NSArray *oldEventArray = [eventDict valueForKey:event];
-                    if (oldEventArray) {
-                        [newEventArray addObjectsFromArray:oldEventArray];
-                    }
-                    NSURL *eventURL = [self urlWithCleanString:urlString];
-                    if (eventURL) {
-                        [newEventArray addObject:[self urlWithCleanString:urlString]];
-                        [eventDict setValue:newEventArray forKey:event];
-                    }
-                }
-            }
-        }
-    }
-    [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"VAST Model returning event dictionary with %lu event(s)", (unsigned long)[eventDict count]]];
-    for (NSString *event in [eventDict allKeys]) {
-        NSArray *array = (NSArray *)[eventDict valueForKey:event];
-        [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"VAST Model %@ has %lu URL(s)", event, (unsigned long)[array count]]];
-    }
-    
-    return eventDict;
+    return self.trackingEventDictionary;
 }
 
-- (NSArray *)mediaFiles; {
-    NSMutableArray *mediaFileArray;
-    NSString *query = @"//MediaFile";
-    
-    for (NSData *document in self.vastDocumentArray) {
-        NSArray *results = performXMLXPathQuery(document, query);
-        for (NSDictionary *result in results) {
-            
-            // use lazy initialization
-            if (!mediaFileArray) {
-                mediaFileArray = [NSMutableArray array];
-            }
-            
-            NSString *id_;
-            NSString *delivery;
-            NSString *type;
-            NSString *bitrate;
-            NSString *width;
-            NSString *height;
-            NSString *scalable;
-            NSString *maintainAspectRatio;
-            NSString *apiFramework;
-            
-            NSArray *attributes = result[@"nodeAttributeArray"];
-            for (NSDictionary *attribute in attributes) {
-                NSString *name = attribute[@"attributeName"];
-                NSString *content = attribute[@"nodeContent"];
-                if ([name isEqualToString:@"id"]) {
-                    id_ = content;
-                } else  if ([name isEqualToString:@"delivery"]) {
-                    delivery = content;
-                } else  if ([name isEqualToString:@"type"]) {
-                    type = content;
-                } else  if ([name isEqualToString:@"bitrate"]) {
-                    bitrate = content;
-                } else  if ([name isEqualToString:@"width"]) {
-                    width = content;
-                } else  if ([name isEqualToString:@"height"]) {
-                    height = content;
-                } else  if ([name isEqualToString:@"scalable"]) {
-                    scalable = content;
-                } else  if ([name isEqualToString:@"maintainAspectRatio"]) {
-                    maintainAspectRatio = content;
-                } else  if ([name isEqualToString:@"apiFramework"]) {
-                    apiFramework = content;
-                }
-            }
-            NSString *urlString = [self content:result];
-            if (urlString != nil) {
-                urlString = [[self urlWithCleanString:urlString] absoluteString];
-            }
-            
-            PNLiteVASTMediaFile *mediaFile = [[PNLiteVASTMediaFile alloc]
-                                              initWithId:id_
-                                              delivery:delivery
-                                              type:type
-                                              bitrate:bitrate
-                                              width:width
-                                              height:height
-                                              scalable:scalable
-                                              maintainAspectRatio:maintainAspectRatio
-                                              apiFramework:apiFramework
-                                              url:urlString];
-            
-            [mediaFileArray addObject:mediaFile];
-        }
-    }
-    
-    return mediaFileArray;
+- (NSArray *)mediaFiles {
+    return self.mediaFileArray;
 }
 
 #pragma mark - helper methods
 
-- (NSArray *)resultsForQuery:(NSString *)query {
-    NSMutableArray *array;
-    NSString *elementName = [query stringByReplacingOccurrencesOfString:@"/" withString:@""];
-    
-    for (NSData *document in self.vastDocumentArray) {
-        NSArray *results = performXMLXPathQuery(document, query);
-        for (NSDictionary *result in results) {
-            if (!array) {
-                array = [NSMutableArray array];
-            }
-            NSString *urlString = [self content:result];
-            if(urlString != nil) {
-                [array addObject:urlString];
-            }
+- (NSMutableArray<NSString *> *)array:(NSMutableArray<NSString *> *)array byAddingString:(NSString *)string {
+    if (string != nil) {
+        // use lazy initialization
+        if (!array) {
+            array = [NSMutableArray array];
         }
+        [array addObject:string];
     }
-    [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"VAST Model returning %@ array with %lu element(s)", elementName, (unsigned long)[array count]]];
     return array;
 }
 
-- (NSString *)content:(NSDictionary *)node {
-    // this is for string data
-    if ([node[@"nodeContent"] length] > 0) {
-        return node[@"nodeContent"];
+- (void)addTrackingEvent:(NSString *)event withURLString:(NSString *)urlString {
+    NSURL *eventURL = [self urlWithCleanString:urlString];
+    if (!event || !eventURL) {
+        return;
+    }
+    // use lazy initialization
+    if (!self.trackingEventDictionary) {
+        self.trackingEventDictionary = [NSMutableDictionary dictionary];
+    }
+    NSMutableArray *eventArray = self.trackingEventDictionary[event];
+    if (!eventArray) {
+        eventArray = [NSMutableArray array];
+        self.trackingEventDictionary[event] = eventArray;
+    }
+    [eventArray addObject:eventURL];
+}
+
+- (void)addMediaFile:(PNLiteVASTMediaFileRecord)record fromDocument:(PNLiteVASTParsedDocument *)parsedDocument {
+    // use lazy initialization
+    if (!self.mediaFileArray) {
+        self.mediaFileArray = [NSMutableArray array];
     }
     
-    // this is for CDATA
-    NSArray *childArray = node[@"nodeChildArray"];
-    if ([childArray count] > 0) {
-        // return the first array element that is not a comment
-        for (NSDictionary *childNode in childArray) {
-            if ([childNode[@"nodeName"] isEqualToString:@"comment"]) {
-                continue;
-            }
-            return childNode[@"nodeContent"];
-        }
+    NSString *urlString = [parsedDocument stringForString:record.url];
+    if (urlString != nil) {
+        urlString = [[self urlWithCleanString:urlString] absoluteString];
     }
     
-    return nil;
+    PNLiteVASTMediaFile *mediaFile = [[PNLiteVASTMediaFile alloc]
+                                      initWithId:[parsedDocument stringForString:record.identifier]
+                                      delivery:[parsedDocument stringForString:record.delivery]
+                                      type:[parsedDocument stringForString:record.type]
+                                      bitrate:[parsedDocument stringForString:record.bitrate]
+                                      width:[parsedDocument stringForString:record.width]
+                                      height:[parsedDocument stringForString:record.height]
+                                      scalable:[parsedDocument stringForString:record.scalable]
+                                      maintainAspectRatio:[parsedDocument stringForString:record.maintainAspectRatio]
+                                      apiFramework:[parsedDocument stringForString:record.apiFramework]
+                                      url:urlString];
+    
+    [self.mediaFileArray addObject:mediaFile];
 }
 
 - (NSURL*)urlWithCleanString:(NSString *)string {
     NSString *cleanUrlString = [string stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];  // remove leading, trailing \n or space
     cleanUrlString = [cleanUrlString stringByReplacingOccurrencesOfString:@"|" withString:@"%7c"];
+    // keeps macros like [CACHEBUSTING] in a valid URL until they are expanded
+    cleanUrlString = [cleanUrlString stringByReplacingOccurrencesOfString:@"[" withString:@"%5B"];
+    cleanUrlString = [cleanUrlString stringByReplacingOccurrencesOfString:@"]" withString:@"%5D"];
     return [NSURL URLWithString:cleanUrlString];                                                                            // return the resulting URL
 }
 
@@ -0,0 +1,44 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import "PNLiteVASTStreamParser.h"
+
+/**
+ One VAST document read by the stream parser. It is immutable once created, so a wrapper hop can be cached and merged into any number of models.
+ */
+@interface PNLiteVASTParsedDocument : NSObject
+
+@property (nonatomic, readonly) const PNLiteVASTDocument *document;
+@property (nonatomic, readonly) NSString *adTagURI;
+
+/**
+ Returns nil when the data is not a readable VAST document. The handler is called as soon as a wrapper's ad tag URI is known, while the rest of the document is still being read.
+ */
+- (instancetype)initWithData:(NSData *)data adTagURIHandler:(void (^)(NSString *adTagURI))handler;
+
+/**
+ Text of a string recorded by the parser, nil when it is empty.
+ */
+- (NSString *)stringForString:(PNLiteVASTString)string;
+
+@end
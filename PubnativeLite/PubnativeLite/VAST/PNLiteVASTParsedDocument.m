@@ -0,0 +1,90 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteVASTParsedDocument.h"
+#import "HyBidLogger.h"
+
+static void PNLiteVASTParsedDocumentAdTagURIFound(void *context, const char *adTagURI) {
+    void (^handler)(NSString *) = (__bridge void (^)(NSString *))context;
+    NSString *url = [[NSString stringWithUTF8String:adTagURI] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    if (url.length > 0) {
+        handler(url);
+    }
+}
+
+@interface PNLiteVASTParsedDocument ()
+
+@property (nonatomic, assign) PNLiteVASTDocument *parsedDocument;
+@property (nonatomic, strong) NSString *adTagURI;
+
+@end
+
+@implementation PNLiteVASTParsedDocument
+
+- (void)dealloc {
+    if (self.parsedDocument) {
+        PNLiteVASTDocumentFree(self.parsedDocument);
+        free(self.parsedDocument);
+        self.parsedDocument = NULL;
+    }
+    self.adTagURI = nil;
+}
+
+- (instancetype)initWithData:(NSData *)data adTagURIHandler:(void (^)(NSString *adTagURI))handler {
+    self = [super init];
+    if (self) {
+        PNLiteVASTDocument *document = malloc(sizeof(PNLiteVASTDocument));
+        if (!document) {
+            return nil;
+        }
+        PNLiteVASTDocumentInit(document);
+        if (handler) {
+            document->adTagURIHandler = PNLiteVASTParsedDocumentAdTagURIFound;
+            document->adTagURIHandlerContext = (__bridge void *)handler;
+        }
+        PNLiteVASTParseResult result = PNLiteVASTDocumentParse(document, [data bytes], [data length]);
+        // The handler only lives for the duration of the parse
+        document->adTagURIHandler = NULL;
+        document->adTagURIHandlerContext = NULL;
+        self.parsedDocument = document;
+        if (result != PNLiteVASTParseResultOK) {
+            [HyBidLogger errorLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"VAST document could not be read (%d): %s", result, document->errorMessage]];
+            return nil;
+        }
+        if (document->truncated) {
+            [HyBidLogger warningLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:@"VAST document exceeds the parser limits, extra elements were dropped."];
+        }
+        self.adTagURI = [[self stringForString:document->adTagURI] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    }
+    return self;
+}
+
+- (const PNLiteVASTDocument *)document {
+    return self.parsedDocument;
+}
+
+- (NSString *)stringForString:(PNLiteVASTString)string {
+    const char *text = PNLiteVASTDocumentString(self.parsedDocument, string);
+    return text ? [[NSString alloc] initWithBytes:text length:string.length encoding:NSUTF8StringEncoding] : nil;
+}
+
+@end
@@ -29,7 +29,8 @@ typedef enum : NSInteger {
     PNLiteVASTParserError_TooManyWrappers,
     PNLiteVASTParserError_NoCompatibleMediaFile,
     PNLiteVASTParserError_NoInternetConnection,
-    PNLiteVASTParserError_MovieTooShort
+    PNLiteVASTParserError_MovieTooShort,
+    PNLiteVASTParserError_Timeout
 } PNLiteVASTParserError;
 
 @class PNLiteVASTModel;
@@ -40,4 +41,9 @@ typedef void (^vastParserCompletionBlock)(PNLiteVASTModel *, PNLiteVASTParserErr
 - (void)parseWithUrl:(NSURL *)url completion:(vastParserCompletionBlock)block;
 - (void)parseWithData:(NSData *)vastData completion:(vastParserCompletionBlock)block;
 
+/**
+ Stops resolving the wrapper chain, the completion block of the current parse isn't called.
+ */
+- (void)cancel;
+
 @end
@@ -23,22 +23,33 @@
 #import "PNLiteVASTParser.h"
 #import "PNLiteVASTXMLUtil.h"
 #import "PNLiteVASTModel.h"
-#import "PNLiteVASTSchema.h"
+#import "PNLiteVASTParsedDocument.h"
+#import "PNLiteVASTWrapperCache.h"
+#import "PNLiteHttpRequest.h"
+#import "HyBidLogger.h"
+#import "HyBidSettings.h"
 
 NSInteger const PNLiteVASTModel_MaxRecursiveDepth = 5;
-BOOL const PNLiteVASTModel_ValidateWithSchema = NO;
+NSTimeInterval const PNLiteVASTParserHopTimeout = 5;
+NSTimeInterval const PNLiteVASTParserTotalTimeout = 15;
 
 @interface PNLiteVASTModel (private)
 
-- (void)addVASTDocument:(NSData *)vastDocument;
+- (void)addParsedDocument:(PNLiteVASTParsedDocument *)parsedDocument;
 
 @end
 
-@interface PNLiteVASTParser ()
+@interface PNLiteVASTParser () <PNLiteHttpRequestDelegate>
 
 @property (nonatomic, strong) PNLiteVASTModel *vastModel;
-
-- (PNLiteVASTParserError)parseRecursivelyWithData:(NSData *)vastData depth:(int)depth;
+@property (nonatomic, copy) vastParserCompletionBlock completion;
+@property (nonatomic, strong) PNLiteHttpRequest *hopRequest;
+@property (nonatomic, assign) NSInteger hopDepth;
+@property (nonatomic, strong) NSString *hopURLString;
+@property (nonatomic, assign) NSTimeInterval deadline;
+// Bumped whenever a parse finishes or is cancelled, so late callbacks of that parse are ignored
+@property (nonatomic, assign) NSUInteger generation;
+@property (nonatomic, strong) dispatch_queue_t parseQueue;
 
 @end
 
@@ -47,108 +58,240 @@ BOOL const PNLiteVASTModel_ValidateWithSchema = NO;
 - (id)init {
     self = [super init];
     if (self) {
-        self.vastModel = [[PNLiteVASTModel alloc] init];
+        // Serial, so the documents of a chain are merged in order even while the next hop is fetched
+        self.parseQueue = dispatch_queue_create("net.pubnative.hybid.vast.parser", DISPATCH_QUEUE_SERIAL);
     }
     return self;
 }
 
 - (void)dealloc {
+    [self.hopRequest cancel];
+    self.hopRequest = nil;
+    self.hopURLString = nil;
+    self.completion = nil;
     self.vastModel = nil;
 }
 
 #pragma mark - "public" methods
 
 - (void)parseWithUrl:(NSURL *)url completion:(vastParserCompletionBlock)block {
-    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-        NSData *vastData = [NSData dataWithContentsOfURL:url];
-        PNLiteVASTParserError vastError = [self parseRecursivelyWithData:vastData depth:0];
-        dispatch_async(dispatch_get_main_queue(), ^{
-            block(self.vastModel, vastError);
-        });
-    });
+    [self performOnMainThread:^{
+        [self startWithCompletion:block];
+        [self fetchHopWithURLString:url.absoluteString depth:0];
+    }];
 }
 
 - (void)parseWithData:(NSData *)vastData completion:(vastParserCompletionBlock)block {
-    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-        PNLiteVASTParserError vastError = [self parseRecursivelyWithData:vastData depth:0];
-        dispatch_async(dispatch_get_main_queue(), ^{
-            block(self.vastModel, vastError);
-        });
-    });
+    [self performOnMainThread:^{
+        [self startWithCompletion:block];
+        [self parseHopWithData:vastData depth:0 adTagURI:nil lifetime:0];
+    }];
+}
+
+- (void)cancel {
+    [self performOnMainThread:^{
+        self.generation++;
+        self.completion = nil;
+        [self.hopRequest cancel];
+        self.hopRequest = nil;
+    }];
 }
 
 #pragma mark - "private" method
 
-- (PNLiteVASTParserError)parseRecursivelyWithData:(NSData *)vastData depth:(int)depth {
-    if (depth >= PNLiteVASTModel_MaxRecursiveDepth) {
-        self.vastModel = nil;
-        return PNLiteVASTParserError_TooManyWrappers;
+- (void)performOnMainThread:(dispatch_block_t)block {
+    if ([NSThread isMainThread]) {
+        block();
+    } else {
+        dispatch_async(dispatch_get_main_queue(), block);
     }
+}
+
+- (void)startWithCompletion:(vastParserCompletionBlock)block {
+    [self cancel];
+    self.completion = block;
+    // Every parse builds a fresh model, documents from a previous ad must not leak into this one
+    self.vastModel = [[PNLiteVASTModel alloc] init];
+    self.deadline = [NSDate timeIntervalSinceReferenceDate] + PNLiteVASTParserTotalTimeout;
     
-    // sanity check
-    __unused NSString *content = [[NSString alloc] initWithData:vastData encoding:NSUTF8StringEncoding];
+    NSUInteger generation = self.generation;
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(PNLiteVASTParserTotalTimeout * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        if (weakSelf.generation == generation) {
+            [HyBidLogger warningLogFromClass:NSStringFromClass([weakSelf class]) fromMethod:NSStringFromSelector(_cmd) withMessage:@"VAST wrapper chain took too long to resolve."];
+            [weakSelf finishWithError:PNLiteVASTParserError_Timeout generation:generation];
+        }
+    });
+}
 
-    // Validate the basic XML syntax of the VAST document.
-    BOOL isValid;
-    isValid = validateXMLDocSyntax(vastData);
-    if (!isValid) {
+- (void)finishWithError:(PNLiteVASTParserError)error generation:(NSUInteger)generation {
+    if (generation != self.generation) {
+        return;
+    }
+    vastParserCompletionBlock completion = self.completion;
+    PNLiteVASTModel *model = error == PNLiteVASTParserError_None ? self.vastModel : nil;
+    self.generation++;
+    self.completion = nil;
+    [self.hopRequest cancel];
+    self.hopRequest = nil;
+    if (error != PNLiteVASTParserError_None) {
         self.vastModel = nil;
-        return PNLiteVASTParserError_XMLParse;
     }
+    if (completion) {
+        // Always asynchronous, callers may release the parser from inside the completion
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completion(model, error);
+        });
+    }
+}
 
-    if (PNLiteVASTModel_ValidateWithSchema) {
-        
-        // Using header data
-        NSData *PNLiteVASTSchemaData = [NSData dataWithBytesNoCopy:pubnative_lite_vast_2_0_1_xsd
-                                                        length:pubnative_lite_vast_2_0_1_xsd_len
-                                                freeWhenDone:NO];
-        isValid = validateXMLDocAgainstSchema(vastData, PNLiteVASTSchemaData);
-        if (!isValid) {
-            self.vastModel = nil;
-            return PNLiteVASTParserError_SchemaValidation;
+// Called on the main thread
+- (void)fetchHopWithURLString:(NSString *)urlString depth:(NSInteger)depth {
+    NSUInteger generation = self.generation;
+    if (depth >= PNLiteVASTModel_MaxRecursiveDepth) {
+        [self finishWithError:PNLiteVASTParserError_TooManyWrappers generation:generation];
+        return;
+    }
+    NSTimeInterval remaining = self.deadline - [NSDate timeIntervalSinceReferenceDate];
+    NSTimeInterval timeout = MIN(PNLiteVASTParserHopTimeout, remaining);
+    if (timeout <= 0) {
+        [self finishWithError:PNLiteVASTParserError_Timeout generation:generation];
+        return;
+    }
+    
+    PNLiteVASTParsedDocument *cachedDocument = [[PNLiteVASTWrapperCache sharedInstance] documentForAdTagURI:urlString];
+    if (cachedDocument) {
+        [self addCachedDocument:cachedDocument depth:depth];
+        return;
+    }
+    
+    PNLiteHttpRequest *request = [[PNLiteHttpRequest alloc] init];
+    request.timeout = timeout;
+    self.hopRequest = request;
+    self.hopDepth = depth;
+    self.hopURLString = urlString;
+    
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(timeout * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        if (weakSelf.hopRequest == request) {
+            [HyBidLogger warningLogFromClass:NSStringFromClass([weakSelf class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"VAST wrapper hop %ld timed out.", (long)depth]];
+            [weakSelf finishWithError:PNLiteVASTParserError_Timeout generation:generation];
         }
+    });
+    [request startWithUrlString:urlString withMethod:@"GET" delegate:self];
+}
+
+- (BOOL)shouldValidateWithSchema {
+    double sampleRate = [HyBidSettings sharedInstance].vastSchemaValidationSampleRate;
+    if (sampleRate <= 0) {
+        return NO;
+    } else if (sampleRate >= 1) {
+        return YES;
     }
+    return arc4random_uniform(10000) < (uint32_t)(sampleRate * 10000);
+}
 
-    [self.vastModel addVASTDocument:vastData];
-    
-    // Check to see whether this is a wrapper ad. If so, process it.
-    NSString *query = @"//VASTAdTagURI";
-    NSArray *results = performXMLXPathQuery(vastData, query);
-    if ([results count] > 0) {
-        NSString *url;
-        NSDictionary *node = results[0];
-        if ([node[@"nodeContent"] length] > 0) {
-            // this is for string data
-            url =  node[@"nodeContent"];
-        } else {
-            // this is for CDATA
-            NSArray *childArray = node[@"nodeChildArray"];
-            if ([childArray count] > 0) {
-                // we assume that there's only one element in the array
-                url = ((NSDictionary *)childArray[0])[@"nodeContent"];
+// Called on the main thread, a repeated wrapper hop is merged without a network round-trip
+- (void)addCachedDocument:(PNLiteVASTParsedDocument *)document depth:(NSInteger)depth {
+    [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"VAST wrapper hop %ld served from cache.", (long)depth]];
+    NSUInteger generation = self.generation;
+    PNLiteVASTModel *model = self.vastModel;
+    __weak typeof(self) weakSelf = self;
+    // Through the parse queue, so the document is merged after the previous hop of the chain
+    dispatch_async(self.parseQueue, ^{
+        [model addParsedDocument:document];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (weakSelf.generation == generation) {
+                [weakSelf fetchHopWithURLString:document.adTagURI depth:depth + 1];
+            }
+        });
+    });
+}
+
+// Called on the main thread, the document itself is read on the parse queue.
+// Wrapper documents fetched from adTagURI are cached for the given lifetime when it isn't 0.
+- (void)parseHopWithData:(NSData *)vastData depth:(NSInteger)depth adTagURI:(NSString *)adTagURI lifetime:(NSTimeInterval)lifetime {
+    NSUInteger generation = self.generation;
+    BOOL shouldValidate = [self shouldValidateWithSchema];
+    BOOL isStrict = [HyBidSettings sharedInstance].vastSchemaValidationStrict;
+    PNLiteVASTModel *model = self.vastModel;
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(self.parseQueue, ^{
+        PNLiteVASTParserError error = PNLiteVASTParserError_None;
+        if (shouldValidate) {
+            // The schema is compiled once per process, so a sampled document only pays for the validation itself.
+            // The schema is VAST 2.0.1, so valid VAST 3 and 4 documents fail it too: sampling only measures, strict mode rejects.
+            if (!validateXMLDocAgainstVASTSchema(vastData)) {
+                [HyBidLogger warningLogFromClass:NSStringFromClass([PNLiteVASTParser class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"VAST document at hop %ld failed schema validation%@.", (long)depth, isStrict ? @", rejecting it" : @""]];
+                if (isStrict) {
+                    error = PNLiteVASTParserError_SchemaValidation;
+                }
             }
         }
-        vastData = [NSData dataWithContentsOfURL:[NSURL URLWithString:url]];
-        return [self parseRecursivelyWithData:vastData depth:(depth + 1)];
-    }
-    
-    return PNLiteVASTParserError_None;
+        
+        __block BOOL isWrapper = NO;
+        if (error == PNLiteVASTParserError_None) {
+            // Reading the document also validates its basic XML syntax.
+            PNLiteVASTParsedDocument *document = [[PNLiteVASTParsedDocument alloc] initWithData:vastData adTagURIHandler:^(NSString *nextAdTagURI) {
+                // This is a wrapper ad, start fetching the next hop while the rest of this document is read
+                isWrapper = YES;
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    if (weakSelf.generation == generation) {
+                        [weakSelf fetchHopWithURLString:nextAdTagURI depth:depth + 1];
+                    }
+                });
+            }];
+            if (!document) {
+                error = PNLiteVASTParserError_XMLParse;
+            } else {
+                [model addParsedDocument:document];
+                // Only wrappers are shared, inline documents carry the creative and its impression URLs
+                if (isWrapper && !document.document->truncated && lifetime > 0) {
+                    [[PNLiteVASTWrapperCache sharedInstance] setDocument:document forAdTagURI:adTagURI lifetime:lifetime];
+                }
+            }
+        }
+        
+        if (error != PNLiteVASTParserError_None || !isWrapper) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [weakSelf finishWithError:error generation:generation];
+            });
+        }
+    });
 }
 
-- (NSString *)content:(NSDictionary *)node {
-    // this is for string data
-    if ([node[@"nodeContent"] length] > 0) {
-        return node[@"nodeContent"];
+#pragma mark PNLiteHttpRequestDelegate
+
+- (void)request:(PNLiteHttpRequest *)request didFinishWithData:(NSData *)data statusCode:(NSInteger)statusCode {
+    if (request != self.hopRequest) {
+        return;
     }
-    
-    // this is for CDATA
-    NSArray *childArray = node[@"nodeChildArray"];
-    if ([childArray count] > 0) {
-        // we assume that there's only one element in the array
-        return ((NSDictionary *)childArray[0])[@"nodeContent"];
+    self.hopRequest = nil;
+    NSString *adTagURI = self.hopURLString;
+    self.hopURLString = nil;
+    if (statusCode < 200 || statusCode >= 300) {
+        [HyBidLogger errorLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"VAST wrapper hop %ld failed with status code %ld.", (long)self.hopDepth, (long)statusCode]];
+        [self finishWithError:PNLiteVASTParserError_XMLParse generation:self.generation];
+    } else {
+        NSTimeInterval lifetime = [PNLiteVASTWrapperCache lifetimeForResponse:request.response];
+        [self parseHopWithData:data depth:self.hopDepth adTagURI:adTagURI lifetime:lifetime];
     }
-    
-    return nil;
+}
+
+- (void)request:(PNLiteHttpRequest *)request didFailWithError:(NSError *)error {
+    [self performOnMainThread:^{
+        if (request != self.hopRequest) {
+            return;
+        }
+        self.hopRequest = nil;
+        PNLiteVASTParserError parserError = PNLiteVASTParserError_XMLParse;
+        if (error.code == NSURLErrorTimedOut) {
+            parserError = PNLiteVASTParserError_Timeout;
+        } else if (error.code == NSURLErrorNotConnectedToInternet) {
+            parserError = PNLiteVASTParserError_NoInternetConnection;
+        }
+        [self finishWithError:parserError generation:self.generation];
+    }];
 }
 
 @end
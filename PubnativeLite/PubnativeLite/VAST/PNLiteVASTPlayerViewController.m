@@ -24,8 +24,10 @@
 #import "PNLiteVASTParser.h"
 #import "PNLiteVASTModel.h"
 #import "PNLiteVASTMediaFilePicker.h"
+#import "PNLiteThroughputEstimator.h"
 #import "PNLiteVASTEventProcessor.h"
 #import "PNLiteProgressLabel.h"
+#import "PNLiteVisibilityScheduler.h"
 #import "UIApplication+PNLiteTopViewController.h"
 #import "HyBidLogger.h"
 
@@ -39,7 +41,10 @@ NSString * const PNLiteVASTPlayerCloseImageName        = @"PNLiteClose";
 
 
 NSTimeInterval const PNLiteVASTPlayerDefaultLoadTimeout        = 20.0f;
-NSTimeInterval const PNLiteVASTPlayerDefaultPlaybackInterval   = 0.25f;
+// Boundary observers can fire a hair before the exact offset, a quartile counts as reached within this margin
+NSTimeInterval const PNLiteVASTPlayerQuartileTolerance         = 0.1f;
+// Smallest progress change worth redrawing the progress ring for
+CGFloat const PNLiteVASTPlayerProgressRedrawThreshold          = 0.005f;
 CGFloat const PNLiteVASTPlayerViewProgressBottomConstant       = 10.0f;
 CGFloat const PNLiteVASTPlayerViewProgressLeadingConstant      = 10.0f;
 
@@ -58,7 +63,7 @@ typedef enum : NSUInteger {
     PNLiteVASTPlaybackState_FourthQuartile = 1 << 3
 }PNLiteVASTPlaybackState;
 
-@interface PNLiteVASTPlayerViewController ()<PNLiteVASTEventProcessorDelegate, HyBidContentInfoViewDelegate>
+@interface PNLiteVASTPlayerViewController ()<PNLiteVASTEventProcessorDelegate, HyBidContentInfoViewDelegate, PNLiteVisibilitySchedulerObserver>
 
 @property (nonatomic, assign) BOOL shown;
 @property (nonatomic, assign) BOOL wantsToPlay;
@@ -76,6 +81,8 @@ typedef enum : NSUInteger {
 
 @property (nonatomic, strong) NSTimer *loadTimer;
 @property (nonatomic, strong) id playbackToken;
+@property (nonatomic, assign) Float64 displayedProgress;
+@property (nonatomic, assign) NSInteger displayedRemainingTime;
 // Fullscreen
 @property (nonatomic, strong) UIView *viewContainer;
 // Player
@@ -205,11 +212,13 @@ typedef enum : NSUInteger {
 - (void)close {
     @synchronized (self) {
         [self removeObservers];
+        [[PNLiteVisibilityScheduler sharedInstance] removeObserver:self];
         [self stopLoadTimeoutTimer];
         if(self.shown) {
             [self.eventProcessor trackEvent:PNLiteVASTEvent_Close];
         }
         [self.player pause];
+        [self addThroughputSampleFromPlayerItem:self.playerItem];
         [self.layer removeFromSuperlayer];
         [self.progressLabel removeFromSuperview];
         self.progressLabel = nil;
@@ -219,6 +228,7 @@ typedef enum : NSUInteger {
         self.vastUrl = nil;
         self.vastString = nil;
         self.vastModel = nil;
+        [self.parser cancel];
         self.parser = nil;
         self.eventProcessor = nil;
         self.viewContainer = nil;
@@ -226,6 +236,14 @@ typedef enum : NSUInteger {
     }
 }
 
+// What the video download achieved is the best hint for the next ad's media file
+- (void)addThroughputSampleFromPlayerItem:(AVPlayerItem *)playerItem {
+    AVPlayerItemAccessLogEvent *event = playerItem.accessLog.events.lastObject;
+    if (event && event.numberOfBytesTransferred > 0 && event.transferDuration > 0) {
+        [[PNLiteThroughputEstimator sharedInstance] addSampleWithBytes:event.numberOfBytesTransferred duration:event.transferDuration];
+    }
+}
+
 - (UIImage*)bundledImageNamed:(NSString*)name {
     NSBundle *bundle = [self getBundle];
     // Try getting the regular PNG
@@ -260,13 +278,24 @@ typedef enum : NSUInteger {
     self.player = [AVPlayer playerWithPlayerItem:self.playerItem];
     self.player.volume = 0;
     self.player.actionAtItemEnd = AVPlayerActionAtItemEndNone;
+}
+
+// The duration is only known once the item is ready, quartiles are then observed at their exact offsets
+- (void)addQuartileObserver {
+    Float64 duration = [self duration];
+    if (self.playbackToken || !isfinite(duration) || duration <= 0) {
+        return;
+    }
+    NSMutableArray<NSValue *> *times = [NSMutableArray arrayWithCapacity:3];
+    for (NSNumber *quartile in @[@0.25, @0.5, @0.75]) {
+        [times addObject:[NSValue valueWithCMTime:CMTimeMakeWithSeconds(duration * quartile.doubleValue, NSEC_PER_SEC)]];
+    }
     __weak typeof(self) weakSelf = self;
-    CMTime interval = CMTimeMakeWithSeconds(PNLiteVASTPlayerDefaultPlaybackInterval, NSEC_PER_SEC);
-    self.playbackToken = [self.player addPeriodicTimeObserverForInterval:interval
-                                                                   queue:nil
-                                                              usingBlock:^(CMTime time) {
-                                                                  [weakSelf onPlaybackProgressTick];
-                                                              }];
+    self.playbackToken = [self.player addBoundaryTimeObserverForTimes:times
+                                                                queue:nil
+                                                           usingBlock:^{
+                                                               [weakSelf trackReachedQuartilesWithEvent:nil];
+                                                           }];
 }
 
 - (void)observeValueForKeyPath:(NSString *)keyPath
@@ -291,6 +320,7 @@ typedef enum : NSUInteger {
             case AVPlayerItemStatusReadyToPlay:
                 // Ready to Play
                 [self setState:PNLiteVASTPlayerState_READY];
+                [self addQuartileObserver];
                 [self invokeDidFinishLoading];
                 break;
             case AVPlayerItemStatusFailed:
@@ -304,40 +334,77 @@ typedef enum : NSUInteger {
     }
 }
 
-- (void)onPlaybackProgressTick {
+#pragma mark PNLiteVisibilitySchedulerObserver
+
+// Progress rides the shared display link while playing, so it adds no wake-ups of its own
+- (void)visibilitySchedulerDidTick:(PNLiteVisibilityScheduler *)scheduler {
+    [self updateProgress];
+}
+
+- (void)updateProgress {
     Float64 currentDuration = [self duration];
     Float64 currentPlaybackTime = [self currentPlaybackTime];
+    if (!isfinite(currentDuration) || currentDuration <= 0) {
+        return;
+    }
     Float64 currentPlayedPercent = currentPlaybackTime / currentDuration;
+    NSInteger remainingTime = (NSInteger)round(currentDuration - currentPlaybackTime);
     
-    [self.progressLabel setProgress:currentPlayedPercent];
-    self.progressLabel.text = [NSString stringWithFormat:@"%.f", currentDuration - currentPlaybackTime];
-    
-    switch (self.playback) {
-        case PNLiteVASTPlaybackState_FirstQuartile:
-        {
-            if (currentPlayedPercent>0.25f) {
-                [self.eventProcessor trackEvent:PNLiteVASTEvent_FirstQuartile];
-                self.playback = PNLiteVASTPlaybackState_SecondQuartile;
+    // Only redraw when something visible changed
+    if (fabs(currentPlayedPercent - self.displayedProgress) >= PNLiteVASTPlayerProgressRedrawThreshold) {
+        self.displayedProgress = currentPlayedPercent;
+        [self.progressLabel setProgress:currentPlayedPercent];
+    }
+    if (remainingTime != self.displayedRemainingTime) {
+        self.displayedRemainingTime = remainingTime;
+        self.progressLabel.text = [NSString stringWithFormat:@"%ld", (long)remainingTime];
+    }
+}
+
+// Quartiles passed together, after a stall or at the end of the video, are sent in one batch along with the given event
+- (void)trackReachedQuartilesWithEvent:(NSNumber *)event {
+    Float64 currentDuration = [self duration];
+    Float64 currentPlaybackTime = event ? currentDuration : [self currentPlaybackTime] + PNLiteVASTPlayerQuartileTolerance;
+    NSMutableArray<NSNumber *> *events = [NSMutableArray array];
+    BOOL reached = YES;
+    while (reached) {
+        reached = NO;
+        switch (self.playback) {
+            case PNLiteVASTPlaybackState_FirstQuartile:
+            {
+                if (currentPlaybackTime >= currentDuration * 0.25f) {
+                    [events addObject:@(PNLiteVASTEvent_FirstQuartile)];
+                    self.playback = PNLiteVASTPlaybackState_SecondQuartile;
+                    reached = YES;
+                }
             }
-        }
-            break;
-        case PNLiteVASTPlaybackState_SecondQuartile:
-        {
-            if (currentPlayedPercent>0.50f) {
-                [self.eventProcessor trackEvent:PNLiteVASTEvent_Midpoint];
-                self.playback = PNLiteVASTPlaybackState_ThirdQuartile;
+                break;
+            case PNLiteVASTPlaybackState_SecondQuartile:
+            {
+                if (currentPlaybackTime >= currentDuration * 0.50f) {
+                    [events addObject:@(PNLiteVASTEvent_Midpoint)];
+                    self.playback = PNLiteVASTPlaybackState_ThirdQuartile;
+                    reached = YES;
+                }
             }
-        }
-            break;
-        case PNLiteVASTPlaybackState_ThirdQuartile:
-        {
-            if (currentPlayedPercent>0.75f) {
-                [self.eventProcessor trackEvent:PNLiteVASTEvent_ThirdQuartile];
-                self.playback = PNLiteVASTPlaybackState_FourthQuartile;
+                break;
+            case PNLiteVASTPlaybackState_ThirdQuartile:
+            {
+                if (currentPlaybackTime >= currentDuration * 0.75f) {
+                    [events addObject:@(PNLiteVASTEvent_ThirdQuartile)];
+                    self.playback = PNLiteVASTPlaybackState_FourthQuartile;
+                    reached = YES;
+                }
             }
+                break;
+            default: break;
         }
-            break;
-        default: break;
+    }
+    if (event) {
+        [events addObject:event];
+    }
+    if (events.count > 0) {
+        [self.eventProcessor trackEvents:events];
     }
 }
 
@@ -500,7 +567,10 @@ typedef enum : NSUInteger {
 - (void)removeObservers {
     if(self.player != nil) {
         [self.playerItem removeObserver:self forKeyPath:PNLiteVASTPlayerStatusKeyPath];
-        [self.player removeTimeObserver:self.playbackToken];
+        if (self.playbackToken) {
+            [self.player removeTimeObserver:self.playbackToken];
+            self.playbackToken = nil;
+        }
     }
     
     [[NSNotificationCenter defaultCenter] removeObserver:self];;
@@ -513,7 +583,7 @@ typedef enum : NSUInteger {
 }
 
 - (void)moviePlayBackDidFinish:(NSNotification*)notification {
-    [self.eventProcessor trackEvent:PNLiteVASTEvent_Complete];
+    [self trackReachedQuartilesWithEvent:@(PNLiteVASTEvent_Complete)];
     if(self.fullScreen) {
         [self btnFullscreenPush:self.btnFullscreen];
     }
@@ -673,6 +743,9 @@ typedef enum : NSUInteger {
         [self.viewProgress addSubview:self.progressLabel];
     }
     self.progressLabel.text = @"0";
+    // Forces the first progress update after the player starts
+    self.displayedRemainingTime = -1;
+    [[PNLiteVisibilityScheduler sharedInstance] removeObserver:self];
 }
 
 - (void)setPlayState {
@@ -691,6 +764,7 @@ typedef enum : NSUInteger {
     
     // Start playback
     [self.player play];
+    [[PNLiteVisibilityScheduler sharedInstance] addObserver:self];
     if([self currentPlaybackTime]  > 0) {
         [self.eventProcessor trackEvent:PNLiteVASTEvent_Resume];
     } else {
@@ -713,6 +787,7 @@ typedef enum : NSUInteger {
     [self.loadingSpin stopAnimating];
     
     [self.player pause];
+    [[PNLiteVisibilityScheduler sharedInstance] removeObserver:self];
     [self.eventProcessor trackEvent:PNLiteVASTEvent_Pause];
     [self invokeDidPause];
 }
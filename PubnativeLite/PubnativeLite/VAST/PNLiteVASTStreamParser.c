@@ -0,0 +1,339 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "PNLiteVASTStreamParser.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libxml/parser.h>
+#include <libxml/xmlreader.h>
+
+#define PNLITE_VAST_INITIAL_TEXT_CAPACITY 1024
+
+static pthread_once_t PNLiteVASTParserInitOnce = PTHREAD_ONCE_INIT;
+
+static void PNLiteVASTParserInit(void) {
+    xmlInitParser();
+}
+
+// Subtrees that never hold anything the SDK reads, the reader steps over them without building them
+static int PNLiteVASTIsSkippedElement(const char *name) {
+    return strcmp(name, "CompanionAds") == 0
+        || strcmp(name, "NonLinearAds") == 0
+        || strcmp(name, "Extensions") == 0
+        || strcmp(name, "CreativeExtensions") == 0
+        || strcmp(name, "AdParameters") == 0
+        || strcmp(name, "Icons") == 0;
+}
+
+static int PNLiteVASTIsWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static int PNLiteVASTReserve(PNLiteVASTDocument *document, size_t length) {
+    size_t required = document->textLength + length + 1;
+    if (required > PNLITE_VAST_MAX_TEXT_LENGTH) {
+        document->truncated = 1;
+        return 0;
+    }
+    if (required > document->textCapacity) {
+        size_t capacity = document->textCapacity > 0 ? document->textCapacity : PNLITE_VAST_INITIAL_TEXT_CAPACITY;
+        while (capacity < required) {
+            capacity *= 2;
+        }
+        if (capacity > PNLITE_VAST_MAX_TEXT_LENGTH) {
+            capacity = PNLITE_VAST_MAX_TEXT_LENGTH;
+        }
+        char *text = realloc(document->text, capacity);
+        if (!text) {
+            return -1;
+        }
+        document->text = text;
+        document->textCapacity = capacity;
+    }
+    return 1;
+}
+
+static int PNLiteVASTAppend(PNLiteVASTDocument *document, const char *value) {
+    size_t length = strlen(value);
+    int reserved = PNLiteVASTReserve(document, length);
+    if (reserved <= 0) {
+        return reserved;
+    }
+    memcpy(document->text + document->textLength, value, length);
+    document->textLength += length;
+    document->text[document->textLength] = '\0';
+    return 1;
+}
+
+// Trims the text appended since `start` in place and terminates it
+static PNLiteVASTString PNLiteVASTFinishString(PNLiteVASTDocument *document, size_t start) {
+    PNLiteVASTString string = {0, 0};
+    size_t origin = start;
+    size_t end = document->textLength;
+    while (start < end && PNLiteVASTIsWhitespace(document->text[start])) {
+        start++;
+    }
+    while (end > start && PNLiteVASTIsWhitespace(document->text[end - 1])) {
+        end--;
+    }
+    if (end > start) {
+        document->text[end] = '\0';
+        string.offset = (uint32_t)start;
+        string.length = (uint32_t)(end - start);
+        document->textLength = end + 1;
+    } else {
+        // Nothing but whitespace, give the space back
+        document->textLength = origin;
+    }
+    return string;
+}
+
+static int PNLiteVASTCopyString(PNLiteVASTDocument *document, const xmlChar *value, PNLiteVASTString *string) {
+    size_t start = document->textLength;
+    int appended = value ? PNLiteVASTAppend(document, (const char *)value) : 1;
+    if (appended > 0) {
+        *string = PNLiteVASTFinishString(document, start);
+    } else {
+        document->textLength = start;
+    }
+    return appended;
+}
+
+// Copies one attribute of the current element without allocating, leaves the reader on the element
+static int PNLiteVASTCopyAttribute(xmlTextReaderPtr reader, PNLiteVASTDocument *document, const char *attribute, PNLiteVASTString *string) {
+    int result = 1;
+    while (xmlTextReaderMoveToNextAttribute(reader) == 1) {
+        if (strcmp((const char *)xmlTextReaderConstLocalName(reader), attribute) == 0) {
+            result = PNLiteVASTCopyString(document, xmlTextReaderConstValue(reader), string);
+            break;
+        }
+    }
+    xmlTextReaderMoveToElement(reader);
+    return result;
+}
+
+// Reads the text and CDATA content of the current element, leaves the reader on its end tag
+static int PNLiteVASTReadText(xmlTextReaderPtr reader, PNLiteVASTDocument *document, PNLiteVASTString *string, int *status) {
+    size_t start = document->textLength;
+    int appended = 1;
+    if (!xmlTextReaderIsEmptyElement(reader)) {
+        int depth = xmlTextReaderDepth(reader);
+        while ((*status = xmlTextReaderRead(reader)) == 1) {
+            int type = xmlTextReaderNodeType(reader);
+            if (type == XML_READER_TYPE_END_ELEMENT && xmlTextReaderDepth(reader) == depth) {
+                break;
+            }
+            if (appended > 0 && (type == XML_READER_TYPE_TEXT || type == XML_READER_TYPE_CDATA || type == XML_READER_TYPE_SIGNIFICANT_WHITESPACE)) {
+                const xmlChar *value = xmlTextReaderConstValue(reader);
+                if (value) {
+                    appended = PNLiteVASTAppend(document, (const char *)value);
+                }
+            }
+        }
+    }
+    if (appended > 0) {
+        *string = PNLiteVASTFinishString(document, start);
+    } else {
+        // Out of room, drop what was copied so far
+        document->textLength = start;
+        string->offset = 0;
+        string->length = 0;
+    }
+    return appended;
+}
+
+static PNLiteVASTURL *PNLiteVASTNextURL(PNLiteVASTDocument *document) {
+    if (document->urlCount >= PNLITE_VAST_MAX_URLS) {
+        document->truncated = 1;
+        return NULL;
+    }
+    return &document->urls[document->urlCount];
+}
+
+static int PNLiteVASTReadURL(xmlTextReaderPtr reader, PNLiteVASTDocument *document, PNLiteVASTURLKind kind, int *status) {
+    size_t start = document->textLength;
+    PNLiteVASTURL *url = PNLiteVASTNextURL(document);
+    PNLiteVASTString event = {0, 0};
+    if (url && kind == PNLiteVASTURLKindTracking && PNLiteVASTCopyAttribute(reader, document, "event", &event) < 0) {
+        return -1;
+    }
+    PNLiteVASTString string = {0, 0};
+    if (PNLiteVASTReadText(reader, document, &string, status) < 0) {
+        return -1;
+    }
+    if (url && string.length > 0 && (kind != PNLiteVASTURLKindTracking || event.length > 0)) {
+        url->kind = kind;
+        url->event = event;
+        url->url = string;
+        document->urlCount++;
+    } else {
+        document->textLength = start;
+    }
+    return 1;
+}
+
+static int PNLiteVASTReadMediaFile(xmlTextReaderPtr reader, PNLiteVASTDocument *document, int *status) {
+    size_t start = document->textLength;
+    PNLiteVASTMediaFileRecord record;
+    memset(&record, 0, sizeof(record));
+    int room = document->mediaFileCount < PNLITE_VAST_MAX_MEDIA_FILES;
+    if (!room) {
+        document->truncated = 1;
+    }
+    while (room && xmlTextReaderMoveToNextAttribute(reader) == 1) {
+        const char *name = (const char *)xmlTextReaderConstLocalName(reader);
+        const xmlChar *value = xmlTextReaderConstValue(reader);
+        PNLiteVASTString *field = NULL;
+        if (strcmp(name, "id") == 0) {
+            field = &record.identifier;
+        } else if (strcmp(name, "delivery") == 0) {
+            field = &record.delivery;
+        } else if (strcmp(name, "type") == 0) {
+            field = &record.type;
+        } else if (strcmp(name, "bitrate") == 0) {
+            field = &record.bitrate;
+        } else if (strcmp(name, "width") == 0) {
+            field = &record.width;
+        } else if (strcmp(name, "height") == 0) {
+            field = &record.height;
+        } else if (strcmp(name, "scalable") == 0) {
+            field = &record.scalable;
+        } else if (strcmp(name, "maintainAspectRatio") == 0) {
+            field = &record.maintainAspectRatio;
+        } else if (strcmp(name, "apiFramework") == 0) {
+            field = &record.apiFramework;
+        }
+        if (field && PNLiteVASTCopyString(document, value, field) < 0) {
+            return -1;
+        }
+    }
+    xmlTextReaderMoveToElement(reader);
+    if (PNLiteVASTReadText(reader, document, &record.url, status) < 0) {
+        return -1;
+    }
+    if (room) {
+        document->mediaFiles[document->mediaFileCount++] = record;
+    } else {
+        document->textLength = start;
+    }
+    return 1;
+}
+
+static void PNLiteVASTReaderError(void *context, const char *message, xmlParserSeverities severity, xmlTextReaderLocatorPtr locator) {
+    PNLiteVASTDocument *document = context;
+    (void)severity;
+    if (document->errorMessage[0] == '\0' && message) {
+        snprintf(document->errorMessage, sizeof(document->errorMessage), "line %d: %s", xmlTextReaderLocatorLineNumber(locator), message);
+    }
+}
+
+void PNLiteVASTDocumentInit(PNLiteVASTDocument *document) {
+    memset(document, 0, sizeof(PNLiteVASTDocument));
+}
+
+void PNLiteVASTDocumentFree(PNLiteVASTDocument *document) {
+    free(document->text);
+    document->text = NULL;
+    document->textLength = 0;
+    document->textCapacity = 0;
+}
+
+const char *PNLiteVASTDocumentString(const PNLiteVASTDocument *document, PNLiteVASTString string) {
+    if (string.length == 0 || !document->text) {
+        return NULL;
+    }
+    return document->text + string.offset;
+}
+
+PNLiteVASTParseResult PNLiteVASTDocumentParse(PNLiteVASTDocument *document, const char *bytes, size_t length) {
+    if (!bytes || length == 0 || length > INT32_MAX) {
+        return PNLiteVASTParseResultEmpty;
+    }
+    pthread_once(&PNLiteVASTParserInitOnce, PNLiteVASTParserInit);
+    
+    // No network access and no entity expansion, a VAST response must be self contained
+    xmlTextReaderPtr reader = xmlReaderForMemory(bytes, (int)length, NULL, NULL, XML_PARSE_NONET | XML_PARSE_NOCDATA);
+    if (!reader) {
+        return PNLiteVASTParseResultOutOfMemory;
+    }
+    xmlTextReaderSetErrorHandler(reader, PNLiteVASTReaderError, document);
+    
+    int result = 1;
+    int linearDepth = -1;
+    int status = xmlTextReaderRead(reader);
+    while (status == 1 && result > 0) {
+        int type = xmlTextReaderNodeType(reader);
+        if (type == XML_READER_TYPE_ELEMENT) {
+            const char *name = (const char *)xmlTextReaderConstLocalName(reader);
+            int depth = xmlTextReaderDepth(reader);
+            if (PNLiteVASTIsSkippedElement(name)) {
+                status = xmlTextReaderNext(reader);
+                continue;
+            } else if (depth == 0 && strcmp(name, "VAST") == 0) {
+                // Running out of text room only truncates the document, it keeps being read
+                if (PNLiteVASTCopyAttribute(reader, document, "version", &document->version) < 0) {
+                    result = -1;
+                }
+            } else if (strcmp(name, "Linear") == 0 && !xmlTextReaderIsEmptyElement(reader)) {
+                linearDepth = depth;
+            } else if (strcmp(name, "VASTAdTagURI") == 0) {
+                PNLiteVASTString adTagURI = {0, 0};
+                if (PNLiteVASTReadText(reader, document, &adTagURI, &status) < 0) {
+                    result = -1;
+                }
+                if (document->adTagURI.length == 0 && adTagURI.length > 0) {
+                    document->adTagURI = adTagURI;
+                    if (document->adTagURIHandler) {
+                        // Lets the caller fetch the next hop while the rest of this one is parsed
+                        document->adTagURIHandler(document->adTagURIHandlerContext, PNLiteVASTDocumentString(document, adTagURI));
+                    }
+                }
+            } else if (strcmp(name, "Error") == 0) {
+                result = PNLiteVASTReadURL(reader, document, PNLiteVASTURLKindError, &status);
+            } else if (strcmp(name, "Impression") == 0) {
+                result = PNLiteVASTReadURL(reader, document, PNLiteVASTURLKindImpression, &status);
+            } else if (strcmp(name, "ClickThrough") == 0) {
+                result = PNLiteVASTReadURL(reader, document, PNLiteVASTURLKindClickThrough, &status);
+            } else if (strcmp(name, "ClickTracking") == 0) {
+                result = PNLiteVASTReadURL(reader, document, PNLiteVASTURLKindClickTracking, &status);
+            } else if (strcmp(name, "Tracking") == 0 && linearDepth >= 0) {
+                result = PNLiteVASTReadURL(reader, document, PNLiteVASTURLKindTracking, &status);
+            } else if (strcmp(name, "MediaFile") == 0) {
+                result = PNLiteVASTReadMediaFile(reader, document, &status);
+            }
+        } else if (type == XML_READER_TYPE_END_ELEMENT && xmlTextReaderDepth(reader) == linearDepth) {
+            linearDepth = -1;
+        }
+        if (status == 1) {
+            status = xmlTextReaderRead(reader);
+        }
+    }
+    xmlFreeTextReader(reader);
+    
+    if (result < 0) {
+        return PNLiteVASTParseResultOutOfMemory;
+    }
+    return status == 0 ? PNLiteVASTParseResultOK : PNLiteVASTParseResultXMLError;
+}
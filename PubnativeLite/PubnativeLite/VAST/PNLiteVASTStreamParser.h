@@ -0,0 +1,123 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+// Portable C (C99 + libxml2) so it can be built, fuzzed and benchmarked outside of Xcode.
+
+#ifndef PNLiteVASTStreamParser_h
+#define PNLiteVASTStreamParser_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bounds on what a single document may keep, anything beyond is dropped and flagged as truncated
+#define PNLITE_VAST_MAX_URLS 256
+#define PNLITE_VAST_MAX_MEDIA_FILES 32
+#define PNLITE_VAST_MAX_TEXT_LENGTH (64 * 1024)
+
+// A string kept in the document's text buffer, NUL terminated. An empty string means absent.
+typedef struct {
+    uint32_t offset;
+    uint32_t length;
+} PNLiteVASTString;
+
+typedef enum {
+    PNLiteVASTURLKindError,
+    PNLiteVASTURLKindImpression,
+    PNLiteVASTURLKindClickThrough,
+    PNLiteVASTURLKindClickTracking,
+    PNLiteVASTURLKindTracking
+} PNLiteVASTURLKind;
+
+typedef struct {
+    PNLiteVASTURLKind kind;
+    PNLiteVASTString event; // only set for PNLiteVASTURLKindTracking
+    PNLiteVASTString url;
+} PNLiteVASTURL;
+
+typedef struct {
+    PNLiteVASTString url;
+    PNLiteVASTString identifier;
+    PNLiteVASTString delivery;
+    PNLiteVASTString type;
+    PNLiteVASTString bitrate;
+    PNLiteVASTString width;
+    PNLiteVASTString height;
+    PNLiteVASTString scalable;
+    PNLiteVASTString maintainAspectRatio;
+    PNLiteVASTString apiFramework;
+} PNLiteVASTMediaFileRecord;
+
+/**
+ Called as soon as a wrapper's VASTAdTagURI has been read, before the rest of the document is parsed.
+ */
+typedef void (*PNLiteVASTAdTagURIHandler)(void *context, const char *adTagURI);
+
+typedef struct {
+    PNLiteVASTString version;
+    PNLiteVASTString adTagURI;
+    PNLiteVASTURL urls[PNLITE_VAST_MAX_URLS];
+    size_t urlCount;
+    PNLiteVASTMediaFileRecord mediaFiles[PNLITE_VAST_MAX_MEDIA_FILES];
+    size_t mediaFileCount;
+    int truncated;
+    char errorMessage[256];
+    char *text;
+    size_t textLength;
+    size_t textCapacity;
+    PNLiteVASTAdTagURIHandler adTagURIHandler;
+    void *adTagURIHandlerContext;
+} PNLiteVASTDocument;
+
+typedef enum {
+    PNLiteVASTParseResultOK,
+    PNLiteVASTParseResultEmpty,
+    PNLiteVASTParseResultXMLError,
+    PNLiteVASTParseResultOutOfMemory
+} PNLiteVASTParseResult;
+
+void PNLiteVASTDocumentInit(PNLiteVASTDocument *document);
+
+/**
+ Releases the text buffer, the document can be parsed into again after PNLiteVASTDocumentInit.
+ */
+void PNLiteVASTDocumentFree(PNLiteVASTDocument *document);
+
+/**
+ Streams the document once with xmlTextReader, keeping only the elements the SDK uses and skipping
+ companion, non-linear and extension subtrees. Safe to call from several threads on different documents.
+ */
+PNLiteVASTParseResult PNLiteVASTDocumentParse(PNLiteVASTDocument *document, const char *bytes, size_t length);
+
+/**
+ Returns the NUL terminated string, or NULL when it is absent.
+ */
+const char *PNLiteVASTDocumentString(const PNLiteVASTDocument *document, PNLiteVASTString string);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PNLiteVASTStreamParser_h */
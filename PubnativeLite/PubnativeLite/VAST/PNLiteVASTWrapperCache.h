@@ -0,0 +1,53 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import "PNLiteVASTParsedDocument.h"
+
+extern NSTimeInterval const PNLiteVASTWrapperCacheMaxLifetime;
+extern NSUInteger const PNLiteVASTWrapperCacheCapacity;
+
+/**
+ Small in-memory cache of parsed wrapper documents, keyed by their normalized ad tag URI.
+ Only responses the server marks for shared caches are kept, and never longer than PNLiteVASTWrapperCacheMaxLifetime.
+ Per-impression macros in their beacons are expanded when they fire, see PNLiteVASTMacros.
+ */
+@interface PNLiteVASTWrapperCache : NSObject
+
++ (instancetype)sharedInstance;
+
+/**
+ Lower-cased scheme and host, no default port or fragment and sorted query items. Nil for anything that isn't an http(s) URL.
+ */
++ (NSString *)keyForAdTagURI:(NSString *)adTagURI;
+
+/**
+ Seconds the response may be shared between ads according to its Cache-Control, Expires and Age headers.
+ 0 unless Cache-Control has public or s-maxage, only those say the body is the same for every viewer.
+ */
++ (NSTimeInterval)lifetimeForResponse:(NSHTTPURLResponse *)response;
+
+- (PNLiteVASTParsedDocument *)documentForAdTagURI:(NSString *)adTagURI;
+- (void)setDocument:(PNLiteVASTParsedDocument *)document forAdTagURI:(NSString *)adTagURI lifetime:(NSTimeInterval)lifetime;
+- (void)removeAllDocuments;
+
+@end
@@ -0,0 +1,228 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import "PNLiteVASTWrapperCache.h"
+#import "PNLiteMonotonicClock.h"
+#import "HyBidLogger.h"
+
+NSTimeInterval const PNLiteVASTWrapperCacheMaxLifetime = 300;
+NSUInteger const PNLiteVASTWrapperCacheCapacity = 32;
+
+@interface PNLiteVASTWrapperCacheEntry : NSObject
+
+@property (nonatomic, strong) PNLiteVASTParsedDocument *document;
+// Monotonic uptime after which the entry is stale
+@property (nonatomic, assign) NSTimeInterval expiry;
+
+@end
+
+@implementation PNLiteVASTWrapperCacheEntry
+
+- (void)dealloc {
+    self.document = nil;
+}
+
+@end
+
+@interface PNLiteVASTWrapperCache ()
+
+@property (nonatomic, strong) NSMutableDictionary<NSString *, PNLiteVASTWrapperCacheEntry *> *entries;
+// Least recently used key first
+@property (nonatomic, strong) NSMutableArray<NSString *> *keys;
+
+@end
+
+@implementation PNLiteVASTWrapperCache
+
+- (void)dealloc {
+    self.entries = nil;
+    self.keys = nil;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        self.entries = [NSMutableDictionary dictionary];
+        self.keys = [NSMutableArray array];
+    }
+    return self;
+}
+
++ (instancetype)sharedInstance {
+    static PNLiteVASTWrapperCache *instance;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        instance = [[PNLiteVASTWrapperCache alloc] init];
+    });
+    return instance;
+}
+
+#pragma mark Keys
+
++ (NSString *)keyForAdTagURI:(NSString *)adTagURI {
+    if (adTagURI.length == 0) {
+        return nil;
+    }
+    NSURLComponents *components = [NSURLComponents componentsWithString:adTagURI];
+    NSString *scheme = [components.scheme lowercaseString];
+    if (!components.host || (![scheme isEqualToString:@"http"] && ![scheme isEqualToString:@"https"])) {
+        return nil;
+    }
+    components.scheme = scheme;
+    components.host = [components.host lowercaseString];
+    if ((components.port.integerValue == 80 && [scheme isEqualToString:@"http"]) || (components.port.integerValue == 443 && [scheme isEqualToString:@"https"])) {
+        components.port = nil;
+    }
+    if (components.path.length == 0) {
+        components.path = @"/";
+    }
+    components.fragment = nil;
+    if (components.queryItems.count > 1) {
+        // A stable sort keeps the order of repeated parameters
+        components.queryItems = [components.queryItems sortedArrayWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSURLQueryItem *item1, NSURLQueryItem *item2) {
+            return [item1.name compare:item2.name];
+        }];
+    }
+    return components.string;
+}
+
+#pragma mark HTTP Freshness
+
++ (NSString *)valueForHeader:(NSString *)header inResponse:(NSHTTPURLResponse *)response {
+    for (NSString *key in response.allHeaderFields) {
+        if ([key caseInsensitiveCompare:header] == NSOrderedSame) {
+            return [response.allHeaderFields[key] description];
+        }
+    }
+    return nil;
+}
+
++ (NSDate *)dateFromHTTPDateString:(NSString *)string {
+    static NSDateFormatter *formatter;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        formatter = [[NSDateFormatter alloc] init];
+        formatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        formatter.timeZone = [NSTimeZone timeZoneWithAbbreviation:@"GMT"];
+        formatter.dateFormat = @"EEE, dd MMM yyyy HH:mm:ss zzz";
+    });
+    if (string.length == 0) {
+        return nil;
+    }
+    @synchronized (formatter) {
+        return [formatter dateFromString:string];
+    }
+}
+
++ (NSTimeInterval)lifetimeForResponse:(NSHTTPURLResponse *)response {
+    if (response.statusCode != 200) {
+        return 0;
+    }
+    // Per-user responses can carry tracking URLs unique to this impression, those are never shared
+    if ([self valueForHeader:@"Set-Cookie" inResponse:response] || [[self valueForHeader:@"Vary" inResponse:response] containsString:@"*"]) {
+        return 0;
+    }
+    
+    BOOL isShared = NO;
+    NSTimeInterval lifetime = -1;
+    NSTimeInterval sharedLifetime = -1;
+    NSString *cacheControl = [self valueForHeader:@"Cache-Control" inResponse:response];
+    for (NSString *component in [cacheControl componentsSeparatedByString:@","]) {
+        NSString *directive = [[component stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]] lowercaseString];
+        if ([directive hasPrefix:@"no-store"] || [directive hasPrefix:@"no-cache"] || [directive hasPrefix:@"private"]) {
+            return 0;
+        } else if ([directive isEqualToString:@"public"]) {
+            isShared = YES;
+        } else if ([directive hasPrefix:@"s-maxage="]) {
+            isShared = YES;
+            sharedLifetime = [[directive substringFromIndex:@"s-maxage=".length] doubleValue];
+        } else if ([directive hasPrefix:@"max-age="]) {
+            lifetime = [[directive substringFromIndex:@"max-age=".length] doubleValue];
+        }
+    }
+    // A plain max-age only speaks for this viewer's own cache
+    if (!isShared) {
+        return 0;
+    }
+    if (sharedLifetime >= 0) {
+        lifetime = sharedLifetime;
+    } else if (lifetime < 0) {
+        NSDate *expires = [self dateFromHTTPDateString:[self valueForHeader:@"Expires" inResponse:response]];
+        NSDate *date = [self dateFromHTTPDateString:[self valueForHeader:@"Date" inResponse:response]] ?: [NSDate date];
+        lifetime = expires ? [expires timeIntervalSinceDate:date] : 0;
+    }
+    // Without explicit freshness information nothing is cached
+    lifetime -= MAX(0, [[self valueForHeader:@"Age" inResponse:response] doubleValue]);
+    return MAX(0, MIN(lifetime, PNLiteVASTWrapperCacheMaxLifetime));
+}
+
+#pragma mark Entries
+
+- (PNLiteVASTParsedDocument *)documentForAdTagURI:(NSString *)adTagURI {
+    NSString *key = [PNLiteVASTWrapperCache keyForAdTagURI:adTagURI];
+    if (!key) {
+        return nil;
+    }
+    @synchronized (self) {
+        PNLiteVASTWrapperCacheEntry *entry = self.entries[key];
+        if (!entry) {
+            return nil;
+        }
+        [self.keys removeObject:key];
+        if (entry.expiry <= [PNLiteMonotonicClock uptime]) {
+            [self.entries removeObjectForKey:key];
+            return nil;
+        }
+        [self.keys addObject:key];
+        return entry.document;
+    }
+}
+
+- (void)setDocument:(PNLiteVASTParsedDocument *)document forAdTagURI:(NSString *)adTagURI lifetime:(NSTimeInterval)lifetime {
+    NSString *key = [PNLiteVASTWrapperCache keyForAdTagURI:adTagURI];
+    lifetime = MIN(lifetime, PNLiteVASTWrapperCacheMaxLifetime);
+    if (!key || !document || lifetime <= 0) {
+        return;
+    }
+    PNLiteVASTWrapperCacheEntry *entry = [[PNLiteVASTWrapperCacheEntry alloc] init];
+    entry.document = document;
+    entry.expiry = [PNLiteMonotonicClock uptime] + lifetime;
+    @synchronized (self) {
+        [self.keys removeObject:key];
+        [self.keys addObject:key];
+        self.entries[key] = entry;
+        while (self.keys.count > PNLiteVASTWrapperCacheCapacity) {
+            [self.entries removeObjectForKey:self.keys.firstObject];
+            [self.keys removeObjectAtIndex:0];
+        }
+    }
+    [HyBidLogger debugLogFromClass:NSStringFromClass([self class]) fromMethod:NSStringFromSelector(_cmd) withMessage:[NSString stringWithFormat:@"VAST wrapper cached for %.0f seconds: %@", lifetime, key]];
+}
+
+- (void)removeAllDocuments {
+    @synchronized (self) {
+        [self.entries removeAllObjects];
+        [self.keys removeAllObjects];
+    }
+}
+
+@end
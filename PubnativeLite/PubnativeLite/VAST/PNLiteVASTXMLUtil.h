@@ -24,4 +24,5 @@
 
 BOOL validateXMLDocSyntax(NSData *document);                         // check for valid XML syntax using xmlReadMemory
 BOOL validateXMLDocAgainstSchema(NSData *document, NSData *schema);  // check for valid VAST 2.0 syntax using xmlSchemaValidateDoc & vast_2.0.1.xsd schema
-NSArray *performXMLXPathQuery(NSData *document, NSString *query);    // parse the document for the xpath in 'query' using xmlXPathEvalExpression
+BOOL validateXMLDocAgainstVASTSchema(NSData *document);              // same check against the embedded vast_2.0.1.xsd, compiled once per process
+NSArray *performXMLXPathQuery(NSData *document, NSString *query);    // parse the document for the xpath in 'query' using a precompiled xmlXPathCompExpr
@@ -21,71 +21,88 @@
 //
 
 #import "PNLiteVASTXMLUtil.h"
+#import "PNLiteVASTSchema.h"
 
+#import <libxml/parser.h>
 #import <libxml/tree.h>
 #import <libxml/xpath.h>
 #include <libxml/xmlschemastypes.h>
 
 #define LIBXML_SCHEMAS_ENABLED
 
+// Idle validation contexts kept around for reuse, one per concurrent validation is plenty
+NSUInteger const PNLiteVASTXMLUtilValidationContextPoolSize = 4;
+
+// libxml2 is set up once for the whole process and never torn down, other threads may be parsing at any time
+static void initializeXMLLibrary(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        xmlInitParser();
+    });
+}
+
 #pragma mark - error/warning callback functions
 
-void documentParserErrorCallback(void *ctx, const char *msg, ...) {
-    va_list args;
-    va_start (args, msg);
-    char *s = va_arg(args, char*);
-    NSString *errMsg;
-    if(s) {
-        errMsg = [[NSString stringWithCString:s encoding:NSUTF8StringEncoding] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+// Installed on each parser, schema and XPath context rather than process-wide, so concurrent parses don't share a handler
+void logStructuredError(NSString *stage, xmlErrorPtr error) {
+    if (!error || !error->message) {
+        return;
     }
+    NSString *errMsg = [[NSString stringWithCString:error->message encoding:NSUTF8StringEncoding] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
     if ([errMsg length] > 0) {
-        NSLog(@"VAST - XML Util: Document parser error: %@", errMsg);
+        NSLog(@"VAST - XML Util: %@ %@: %@", stage, error->level == XML_ERR_WARNING ? @"warning" : @"error", errMsg);
     }
-    va_end(args);
 }
 
-void schemaParserErrorCallback(void *ctx, const char *msg, ...) {
-    va_list args;
-	va_start (args, msg);
-    char *s = va_arg(args, char*);
-    NSString *errMsg = [[NSString stringWithCString:s encoding:NSUTF8StringEncoding] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-    if ([errMsg length] > 0) {
-        NSLog(@"VAST - XML Util: Schema parser error: %@", errMsg);
-    }
-    va_end(args);
+void documentParserErrorCallback(void *ctx, xmlErrorPtr error) {
+    logStructuredError(@"Document parser", error);
 }
 
-void schemaParserWarningCallback(void *ctx, const char *msg, ...) {
-    va_list args;
-	va_start (args, msg);
-    char *s = va_arg(args, char*);
-    NSString *errMsg = [[NSString stringWithCString:s encoding:NSUTF8StringEncoding] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-    if ([errMsg length] > 0) {
-        NSLog(@"VAST - XML Util: Schema parser warning: %@", errMsg);
-    }
-    va_end(args);
+void schemaParserErrorCallback(void *ctx, xmlErrorPtr error) {
+    logStructuredError(@"Schema parser", error);
 }
 
-void schemaValidationErrorCallback(void *ctx, const char *msg, ...) {
-    va_list args;
-	va_start (args, msg);
-    char *s = va_arg(args, char*);
-    NSString *errMsg = [[NSString stringWithCString:s encoding:NSUTF8StringEncoding] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-    if ([errMsg length] > 0) {
-        NSLog(@"VAST - XML Util: Schema validation error: %@", errMsg);
+void schemaValidationErrorCallback(void *ctx, xmlErrorPtr error) {
+    logStructuredError(@"Schema validation", error);
+}
+
+void xpathErrorCallback(void *ctx, xmlErrorPtr error) {
+    logStructuredError(@"XPath", error);
+}
+
+// Reads a document with its own parser context, so errors are reported to this parse only
+xmlDocPtr readXMLDocument(NSData *document) {
+    initializeXMLLibrary();
+    if ([document length] == 0 || [document length] > INT_MAX) {
+        return NULL;
     }
-    va_end(args);
+    xmlParserCtxtPtr parserCtxt = xmlNewParserCtxt();
+    if (parserCtxt == NULL) {
+        return NULL;
+    }
+    parserCtxt->sax->serror = documentParserErrorCallback;
+    xmlDocPtr doc = xmlCtxtReadMemory(parserCtxt, [document bytes], (int)[document length], "", NULL, XML_PARSE_NONET);
+    xmlFreeParserCtxt(parserCtxt);
+    return doc;
 }
 
-void schemaValidationWarningCallback(void *ctx, const char *msg, ...) {
-    va_list args;
-	va_start (args, msg);
-    char *s = va_arg(args, char*);
-    NSString *errMsg = [[NSString stringWithCString:s encoding:NSUTF8StringEncoding] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-    if ([errMsg length] > 0) {
-        NSLog(@"VAST - XML Util: Schema validation warning: %@", errMsg);
+// Every query is compiled on first use and shared afterwards, a compiled expression is read-only while evaluated
+xmlXPathCompExprPtr compiledXPathQuery(NSString *query) {
+    static NSMutableDictionary<NSString *, NSValue *> *compiledQueries;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        compiledQueries = [NSMutableDictionary dictionary];
+    });
+    @synchronized (compiledQueries) {
+        xmlXPathCompExprPtr compiledQuery = [compiledQueries[query] pointerValue];
+        if (compiledQuery == NULL) {
+            compiledQuery = xmlXPathCompile((xmlChar *)[query UTF8String]);
+            if (compiledQuery != NULL) {
+                compiledQueries[query] = [NSValue valueWithPointer:compiledQuery];
+            }
+        }
+        return compiledQuery;
     }
-    va_end(args);
 }
 
 #pragma mark - internal helper functions
@@ -166,37 +183,97 @@ NSDictionary *dictionaryForNode(xmlNodePtr currentNode, NSMutableDictionary *par
 	return resultForNode;
 }
 
+// The embedded VAST schema is parsed once and only read afterwards, so every validation context can share it
+xmlSchemaPtr compiledVASTSchema(void) {
+    static xmlSchemaPtr schema;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        initializeXMLLibrary();
+        xmlSchemaParserCtxtPtr parserCtxt = xmlSchemaNewMemParserCtxt((const char *)pubnative_lite_vast_2_0_1_xsd, (int)pubnative_lite_vast_2_0_1_xsd_len);
+        if (parserCtxt != NULL) {
+            xmlSchemaSetParserStructuredErrors(parserCtxt, schemaParserErrorCallback, NULL);
+            schema = xmlSchemaParse(parserCtxt);
+            xmlSchemaFreeParserCtxt(parserCtxt);
+        }
+        if (schema == NULL) {
+            NSLog(@"VAST - XML Util: Unable to parse schema.");
+        }
+    });
+    return schema;
+}
+
+NSMutableArray<NSValue *> *validationContextPool(void) {
+    static NSMutableArray<NSValue *> *pool;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pool = [NSMutableArray arrayWithCapacity:PNLiteVASTXMLUtilValidationContextPoolSize];
+    });
+    return pool;
+}
+
+xmlSchemaValidCtxtPtr dequeueValidationContext(xmlSchemaPtr schema) {
+    NSMutableArray<NSValue *> *pool = validationContextPool();
+    @synchronized (pool) {
+        if (pool.count > 0) {
+            xmlSchemaValidCtxtPtr validCtxt = [pool.lastObject pointerValue];
+            [pool removeLastObject];
+            return validCtxt;
+        }
+    }
+    xmlSchemaValidCtxtPtr validCtxt = xmlSchemaNewValidCtxt(schema);
+    if (validCtxt != NULL) {
+        xmlSchemaSetValidStructuredErrors(validCtxt, schemaValidationErrorCallback, NULL);
+    }
+    return validCtxt;
+}
+
+void enqueueValidationContext(xmlSchemaValidCtxtPtr validCtxt) {
+    NSMutableArray<NSValue *> *pool = validationContextPool();
+    @synchronized (pool) {
+        if (pool.count < PNLiteVASTXMLUtilValidationContextPoolSize) {
+            [pool addObject:[NSValue valueWithPointer:validCtxt]];
+            return;
+        }
+    }
+    xmlSchemaFreeValidCtxt(validCtxt);
+}
+
 NSArray *performXPathQuery(xmlDocPtr doc, NSString *query) {
-    xmlXPathContextPtr xpathCtx;
-    xmlXPathObjectPtr xpathObj;
+    xmlXPathCompExprPtr compiledQuery = compiledXPathQuery(query);
+    if (compiledQuery == NULL) {
+        NSLog(@"VAST - XML Util: Unable to compile XPath.");
+        return nil;
+    }
     
     // Create xpath evaluation context
-    xpathCtx = xmlXPathNewContext(doc);
+    xmlXPathContextPtr xpathCtx = xmlXPathNewContext(doc);
     if (xpathCtx == NULL) {
         NSLog(@"VAST - XML Util: Unable to create XPath context.");
-		return nil;
+        return nil;
     }
+    xpathCtx->error = xpathErrorCallback;
     
     // Evaluate xpath expression
-    xpathObj = xmlXPathEvalExpression((xmlChar *)[query cStringUsingEncoding:NSUTF8StringEncoding], xpathCtx);
+    xmlXPathObjectPtr xpathObj = xmlXPathCompiledEval(compiledQuery, xpathCtx);
     if (xpathObj == NULL) {
         NSLog(@"VAST - XML Util: Unable to evaluate XPath.");
-		return nil;
+        xmlXPathFreeContext(xpathCtx);
+        return nil;
     }
 	
+    NSMutableArray *resultNodes = nil;
 	xmlNodeSetPtr nodes = xpathObj->nodesetval;
 	if (!nodes) {
         NSLog(@"VAST - XML Util: Nodes was nil.");
-		return nil;
-	}
-	
-	NSMutableArray *resultNodes = [NSMutableArray array];
-	for (NSInteger i = 0; i < nodes->nodeNr; i++) {
-		NSDictionary *nodeDictionary = dictionaryForNode(nodes->nodeTab[i], nil);
-		if (nodeDictionary) {
-			[resultNodes addObject:nodeDictionary];
-		}
-	}
+	} else {
+        resultNodes = [NSMutableArray array];
+        for (NSInteger i = 0; i < nodes->nodeNr; i++) {
+            NSDictionary *nodeDictionary = dictionaryForNode(nodes->nodeTab[i], nil);
+            if (nodeDictionary) {
+                [resultNodes addObject:nodeDictionary];
+            }
+        }
+    }
     
     // Cleanup
     xmlXPathFreeObject(xpathObj);
@@ -208,49 +285,37 @@ NSArray *performXPathQuery(xmlDocPtr doc, NSString *query) {
 #pragma mark - "public" API
 
 BOOL validateXMLDocSyntax(NSData *document) {
-    BOOL retval = YES;
-    xmlSetGenericErrorFunc(NULL, (xmlGenericErrorFunc)documentParserErrorCallback);
-	xmlDocPtr doc = xmlReadMemory([document bytes], (int)[document length], "", NULL, 0); // XML_PARSE_RECOVER);
+	xmlDocPtr doc = readXMLDocument(document);
     if (doc == NULL) {
         NSLog(@"VAST - XML Util: Unable to parse.");
-		retval = NO;
-    } else {
-        xmlFreeDoc(doc);
+		return NO;
     }
-    xmlCleanupParser();
-    return retval;
+    xmlFreeDoc(doc);
+    return YES;
 }
 
 BOOL validateXMLDocAgainstSchema(NSData *document, NSData *schemaData) {
-    xmlSetGenericErrorFunc(NULL, (xmlGenericErrorFunc)documentParserErrorCallback);
-    
     // load XML document
-	xmlDocPtr doc = xmlReadMemory([document bytes], (int)[document length], "", NULL, 0); // XML_PARSE_RECOVER);
+	xmlDocPtr doc = readXMLDocument(document);
     if (doc == NULL) {
         NSLog(@"VAST - XML Util: Unable to parse.");
-        xmlCleanupParser();
 		return NO;
     }
     
-    xmlLineNumbersDefault(1);
-    
     xmlSchemaParserCtxtPtr parserCtxt = xmlSchemaNewMemParserCtxt([schemaData bytes], (int)[schemaData length]);
-    
-    xmlSchemaSetParserErrors(parserCtxt,
-                             (xmlSchemaValidityErrorFunc)schemaParserErrorCallback,
-                             (xmlSchemaValidityWarningFunc)schemaParserWarningCallback,
-                             NULL);
-    
+    xmlSchemaSetParserStructuredErrors(parserCtxt, schemaParserErrorCallback, NULL);
     xmlSchemaPtr schema = xmlSchemaParse(parserCtxt);
     xmlSchemaFreeParserCtxt(parserCtxt);
+    if (schema == NULL) {
+        NSLog(@"VAST - XML Util: Unable to parse schema.");
+        xmlFreeDoc(doc);
+        return NO;
+    }
     
     // xmlSchemaDump(stdout, schema); //To print schema dump
     
     xmlSchemaValidCtxtPtr validCtxt = xmlSchemaNewValidCtxt(schema);
-    xmlSchemaSetValidErrors(validCtxt,
-                            (xmlSchemaValidityErrorFunc)schemaValidationErrorCallback,
-                            (xmlSchemaValidityWarningFunc)schemaValidationWarningCallback,
-                            NULL);
+    xmlSchemaSetValidStructuredErrors(validCtxt, schemaValidationErrorCallback, NULL);
     int ret = xmlSchemaValidateDoc(validCtxt, doc);
     if (ret == 0) {
         NSLog(@"VAST - XML Util: document is valid");
@@ -260,26 +325,44 @@ BOOL validateXMLDocAgainstSchema(NSData *document, NSData *schemaData) {
         NSLog(@"VAST - XML Util: validation generated an internal error");
     }
     
+    // free the resources of this validation only, the library state stays for the next document
     xmlSchemaFreeValidCtxt(validCtxt);
+    xmlSchemaFree(schema);
     xmlFreeDoc(doc);
     
-    // free the resource
-    if (schema != NULL) {
-        xmlSchemaFree(schema);
+    return (ret == 0);
+}
+
+BOOL validateXMLDocAgainstVASTSchema(NSData *document) {
+    xmlSchemaPtr schema = compiledVASTSchema();
+    if (schema == NULL) {
+        return NO;
     }
-    
-    xmlSchemaCleanupTypes();
-    xmlCleanupParser();
-    xmlMemoryDump();
-    
+	xmlDocPtr doc = readXMLDocument(document);
+    if (doc == NULL) {
+        NSLog(@"VAST - XML Util: Unable to parse.");
+		return NO;
+    }
+    xmlSchemaValidCtxtPtr validCtxt = dequeueValidationContext(schema);
+    if (validCtxt == NULL) {
+        xmlFreeDoc(doc);
+        return NO;
+    }
+    int ret = xmlSchemaValidateDoc(validCtxt, doc);
+    if (ret > 0) {
+        NSLog(@"VAST - XML Util: document is invalid");
+    } else if (ret < 0) {
+        NSLog(@"VAST - XML Util: validation generated an internal error");
+    }
+    enqueueValidationContext(validCtxt);
+    xmlFreeDoc(doc);
     return (ret == 0);
 }
 
 NSArray *performXMLXPathQuery(NSData *document, NSString *query) {
-    xmlDocPtr doc;
-	doc = xmlReadMemory([document bytes], (int)[document length], "", NULL, 0); // XML_PARSE_RECOVER);
+	xmlDocPtr doc = readXMLDocument(document);
     if (doc == NULL) {
-        NSLog(@"VAST - XML UtilL Unable to parse.");
+        NSLog(@"VAST - XML Util: Unable to parse.");
 		return nil;
     }
 	NSArray *result = performXPathQuery(doc, query);
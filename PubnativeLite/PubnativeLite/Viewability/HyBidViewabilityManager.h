@@ -39,6 +39,8 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)fireOMIDImpressionOccuredEvent:(OMIDPubnativenetAdSession*)omidAdSession;
 - (void)addFriendlyObstruction:(UIView *) view toOMIDAdSession:(OMIDPubnativenetAdSession*)omidAdSession;
 - (NSString *)getOMIDJS;
+// omsdk.js as a document start user script, built once and shared by every web view that needs it
+- (nullable WKUserScript *)getOMIDUserScript;
 
 @end
 
@@ -32,6 +32,7 @@ static NSString *const HyBidOMIDSDKJSFilename = @"omsdk";
 
 @property (nonatomic, assign) BOOL isViewabilityMeasurementActivated;
 @property (nonatomic, readwrite, strong) NSString* omidJSString;
+@property (nonatomic, strong) WKUserScript *omidUserScript;
 @property (nonatomic, strong) OMIDPubnativenetPartner *partner;
 
 @end
@@ -77,8 +78,8 @@ static NSString *const HyBidOMIDSDKJSFilename = @"omsdk";
     if (!omSdkJSPath) {
         return;
     }
-    NSData *omSdkJsData = [NSData dataWithContentsOfFile:omSdkJSPath];
-    self.omidJSString = [[NSString alloc] initWithData:omSdkJsData encoding:NSUTF8StringEncoding];
+    // Decoded straight from the file, this string is the only copy of the script in the process
+    self.omidJSString = [[NSString alloc] initWithContentsOfFile:omSdkJSPath encoding:NSUTF8StringEncoding error:nil];
 }
 
 - (NSString *)getOMIDJS {
@@ -96,6 +97,20 @@ static NSString *const HyBidOMIDSDKJSFilename = @"omsdk";
     return scriptContent;
 }
 
+- (WKUserScript *)getOMIDUserScript {
+    if(!self.isViewabilityMeasurementActivated)
+        return nil;
+    
+    @synchronized (self) {
+        if (!self.omidUserScript && self.omidJSString) {
+            self.omidUserScript = [[WKUserScript alloc] initWithSource:self.omidJSString
+                                                         injectionTime:WKUserScriptInjectionTimeAtDocumentStart
+                                                      forMainFrameOnly:YES];
+        }
+        return self.omidUserScript;
+    }
+}
+
 - (OMIDPubnativenetAdSession *)createOMIDAdSessionforWebView:(WKWebView *)webView isVideoAd:(BOOL)videoAd {
     if(!self.isViewabilityMeasurementActivated)
         return nil;
@@ -24,6 +24,10 @@
 #import <OCHamcrestIOS/OCHamcrestIOS.h>
 #import <OCMockitoIOS/OCMockitoIOS.h>
 #import "HyBidAdTrackerRequest.h"
+#import "PNLiteTrackingManager.h"
+
+NSString *const kHyBidAdTrackerRequestTestURL = @"https://example.com/impression";
+NSString *const kHyBidAdTrackerRequestTestOtherURL = @"https://example.com/view";
 
 @interface HyBidAdTrackerRequest()
 
@@ -31,6 +35,30 @@
 - (void)invokeDidStart;
 - (void)invokeDidLoad;
 - (void)invokeDidFail:(NSError *)error;
+- (void)trackURL:(NSURL *)url completion:(PNLiteTrackingManagerCompletionBlock)completion;
+@end
+
+// Completes every URL straight away instead of going through the shared tracking manager
+@interface HyBidAdTrackerRequestTestDouble : HyBidAdTrackerRequest
+
+@property (nonatomic, strong) NSMutableArray<NSURL *> *trackedURLs;
+@property (nonatomic, strong) NSDictionary<NSString *, NSNumber *> *statusCodes;
+@property (nonatomic, strong) NSDictionary<NSString *, NSError *> *errors;
+
+@end
+
+@implementation HyBidAdTrackerRequestTestDouble
+
+- (void)trackURL:(NSURL *)url completion:(PNLiteTrackingManagerCompletionBlock)completion
+{
+    if (!self.trackedURLs) {
+        self.trackedURLs = [NSMutableArray array];
+    }
+    [self.trackedURLs addObject:url];
+    NSNumber *statusCode = self.statusCodes[url.absoluteString] ?: @200;
+    completion(statusCode.integerValue, self.errors[url.absoluteString]);
+}
+
 @end
 
 @interface HyBidAdTrackerRequestTest : XCTestCase
@@ -76,6 +104,69 @@
     [request trackAdWithDelegate:delegate withURL:@"validURL"];
 }
 
+- (void)waitForMainQueue
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"expectation"];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [expectation fulfill];
+    });
+    [self waitForExpectationsWithTimeout:5 handler:^(NSError *error) {
+        NSLog(@"error: %@", error);
+    }];
+}
+
+- (void)test_trackAdWithDelegate_withNilDelegateAndWithValidUrls_shouldNotTrack
+{
+    HyBidAdTrackerRequestTestDouble *request = [[HyBidAdTrackerRequestTestDouble alloc] init];
+    [request trackAdWithDelegate:nil withURLs:@[kHyBidAdTrackerRequestTestURL, kHyBidAdTrackerRequestTestOtherURL]];
+    [self waitForMainQueue];
+    XCTAssertEqual(request.trackedURLs.count, 0);
+}
+
+- (void)test_trackAdWithDelegate_withValidDelegateAndWithEmptyUrls_shouldNotTrack
+{
+    HyBidAdTrackerRequestTestDouble *request = [[HyBidAdTrackerRequestTestDouble alloc] init];
+    NSObject <HyBidAdTrackerRequestDelegate> *delegate = mockProtocol(@protocol(HyBidAdTrackerRequestDelegate));
+    [request trackAdWithDelegate:delegate withURLs:@[]];
+    [self waitForMainQueue];
+    XCTAssertEqual(request.trackedURLs.count, 0);
+    [verifyCount(delegate, never()) requestDidStart:anything()];
+}
+
+- (void)test_trackAdWithDelegate_withValidDelegateAndWithValidUrls_shouldReportEveryURL
+{
+    HyBidAdTrackerRequestTestDouble *request = [[HyBidAdTrackerRequestTestDouble alloc] init];
+    NSObject <HyBidAdTrackerRequestDelegate> *delegate = mockProtocol(@protocol(HyBidAdTrackerRequestDelegate));
+    NSArray<NSString *> *urls = @[kHyBidAdTrackerRequestTestURL, kHyBidAdTrackerRequestTestOtherURL];
+    [request trackAdWithDelegate:delegate withURLs:urls];
+    [self waitForMainQueue];
+    
+    XCTAssertEqualObjects(request.trackedURLs, (@[[NSURL URLWithString:kHyBidAdTrackerRequestTestURL], [NSURL URLWithString:kHyBidAdTrackerRequestTestOtherURL]]));
+    [verifyCount(delegate, times(1)) requestDidStart:request];
+    [verify(delegate) request:request didTrackURL:kHyBidAdTrackerRequestTestURL withError:nilValue()];
+    [verify(delegate) request:request didTrackURL:kHyBidAdTrackerRequestTestOtherURL withError:nilValue()];
+    [[verify(delegate) withMatcher:anything() forArgument:3] request:request didFinishTrackingURLs:urls withFailedURLs:@[] duration:0];
+    [verify(delegate) requestDidFinish:request];
+    [verifyCount(delegate, never()) request:anything() didFailWithError:anything()];
+}
+
+- (void)test_trackAdWithDelegate_withFailingUrls_shouldReportFailedURLs
+{
+    HyBidAdTrackerRequestTestDouble *request = [[HyBidAdTrackerRequestTestDouble alloc] init];
+    request.statusCodes = @{kHyBidAdTrackerRequestTestURL : @404};
+    request.errors = @{kHyBidAdTrackerRequestTestOtherURL : [NSError errorWithDomain:@"Internet is not available." code:0 userInfo:nil]};
+    NSObject <HyBidAdTrackerRequestDelegate> *delegate = mockProtocol(@protocol(HyBidAdTrackerRequestDelegate));
+    NSArray<NSString *> *urls = @[kHyBidAdTrackerRequestTestURL, kHyBidAdTrackerRequestTestOtherURL];
+    [request trackAdWithDelegate:delegate withURLs:urls];
+    [self waitForMainQueue];
+    
+    [verify(delegate) request:request didTrackURL:kHyBidAdTrackerRequestTestURL withError:notNilValue()];
+    [verify(delegate) request:request didTrackURL:kHyBidAdTrackerRequestTestOtherURL withError:notNilValue()];
+    [[verify(delegate) withMatcher:anything() forArgument:3] request:request didFinishTrackingURLs:urls withFailedURLs:urls duration:0];
+    [verify(delegate) request:request didFailWithError:instanceOf([NSError class])];
+    [verifyCount(delegate, never()) requestDidFinish:anything()];
+}
+
 - (void)test_invokeDidStart_withNilListener_shouldPass
 {
     HyBidAdTrackerRequest *request = [[HyBidAdTrackerRequest alloc] init];
@@ -28,7 +28,10 @@
 
 @interface HyBidAdTracker()
 
-@property (retain) HyBidAdTrackerRequest *adTrackerRequest;
+@property (retain) HyBidAdTrackerRequest *impressionTrackerRequest;
+@property (retain) HyBidAdTrackerRequest *clickTrackerRequest;
+
+- (void)request:(HyBidAdTrackerRequest *)request didFinishTrackingURLs:(NSArray<NSString *> *)urls withFailedURLs:(NSArray<NSString *> *)failedURLs duration:(NSTimeInterval)duration;
 
 @end
 
@@ -55,19 +58,30 @@
 - (void)test_trackImpression
 {
     HyBidAdTrackerRequest *adTrackerRequest = mock([HyBidAdTrackerRequest class]);
-    self.adTracker.adTrackerRequest = adTrackerRequest;
+    self.adTracker.impressionTrackerRequest = adTrackerRequest;
     [self.adTracker trackImpression];
     [self.adTracker trackImpression];
-    [verifyCount(self.adTracker.adTrackerRequest, times(1)) trackAdWithDelegate:((id<HyBidAdTrackerRequestDelegate>)self.adTracker) withURL:@"validImpressionURL"];
+    [verifyCount(self.adTracker.impressionTrackerRequest, times(1)) trackAdWithDelegate:((id<HyBidAdTrackerRequestDelegate>)self.adTracker) withURLs:@[@"validImpressionURL"]];
 }
 
 - (void)test_trackClick
 {
     HyBidAdTrackerRequest *adTrackerRequest = mock([HyBidAdTrackerRequest class]);
-    self.adTracker.adTrackerRequest = adTrackerRequest;
+    self.adTracker.clickTrackerRequest = adTrackerRequest;
     [self.adTracker trackClick];
     [self.adTracker trackClick];
-    [verifyCount(self.adTracker.adTrackerRequest, times(1)) trackAdWithDelegate:((id<HyBidAdTrackerRequestDelegate>)self.adTracker) withURL:@"validClickURL"];
+    [verifyCount(self.adTracker.clickTrackerRequest, times(1)) trackAdWithDelegate:((id<HyBidAdTrackerRequestDelegate>)self.adTracker) withURLs:@[@"validClickURL"]];
+}
+
+- (void)test_completion_withURLInBothSets_shouldReportTheTrackTypeOfTheRequest
+{
+    NSMutableArray<NSString *> *trackTypes = [NSMutableArray array];
+    self.adTracker.completion = ^(NSString *trackType, NSArray<NSString *> *failedURLs, NSTimeInterval duration) {
+        [trackTypes addObject:trackType];
+    };
+    [self.adTracker request:self.adTracker.impressionTrackerRequest didFinishTrackingURLs:@[@"sharedURL"] withFailedURLs:@[] duration:0];
+    [self.adTracker request:self.adTracker.clickTrackerRequest didFinishTrackingURLs:@[@"sharedURL"] withFailedURLs:@[] duration:0];
+    XCTAssertEqualObjects(trackTypes, (@[PNLiteAdTrackerImpression, PNLiteAdTrackerClick]));
 }
 
 @end
@@ -0,0 +1,92 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+#import "PNLiteMRAIDParser.h"
+
+@interface PNLiteMRAIDParserTest : XCTestCase
+
+@property (nonatomic, strong) PNLiteMRAIDParser *parser;
+
+@end
+
+@implementation PNLiteMRAIDParserTest
+
+- (void)setUp
+{
+    [super setUp];
+    self.parser = [[PNLiteMRAIDParser alloc] init];
+}
+
+- (void)tearDown
+{
+    self.parser = nil;
+    [super tearDown];
+}
+
+- (void)test_parseCommandUrl_withEncodedURL_shouldDecodeItOnce
+{
+    PNLiteMRAIDCommand *command = [self.parser parseCommandUrl:@"mraid://open?url=https%3A%2F%2Fexample.com%2Fclick%3Fa%3D1%26b%3D100%2525"];
+    XCTAssertEqual(command.type, PNLiteMRAIDCommandTypeOpen);
+    XCTAssertEqualObjects(command.parameter, @"https://example.com/click?a=1&b=100%25");
+}
+
+- (void)test_parseCommandUrl_withProperties_shouldReturnEveryParameter
+{
+    PNLiteMRAIDCommand *command = [self.parser parseCommandUrl:@"mraid://setResizeProperties?width=320&height=250&offsetX=0&offsetY=-10&customClosePosition=top-right&allowOffscreen=false"];
+    XCTAssertEqual(command.type, PNLiteMRAIDCommandTypeSetResizeProperties);
+    XCTAssertEqualObjects(command.parameter[@"offsetY"], @"-10");
+    XCTAssertEqualObjects(command.parameter[@"customClosePosition"], @"top-right");
+}
+
+- (void)test_parseCommandUrl_withCalendarEvent_shouldKeepTheWholeJSON
+{
+    PNLiteMRAIDCommand *command = [self.parser parseCommandUrl:@"mraid://createCalendarEvent?eventJSON=%7B%22description%22:%22a&b=c%22%7D"];
+    XCTAssertEqual(command.type, PNLiteMRAIDCommandTypeCreateCalendarEvent);
+    XCTAssertEqualObjects(command.parameter, @"{\"description\":\"a&b=c\"}");
+}
+
+- (void)test_parseCommandUrl_withOptionalParameter_shouldAcceptItMissing
+{
+    PNLiteMRAIDCommand *command = [self.parser parseCommandUrl:@"mraid://expand"];
+    XCTAssertEqual(command.type, PNLiteMRAIDCommandTypeExpand);
+    XCTAssertNil(command.parameter);
+    XCTAssertEqual([self.parser parseCommandUrl:@"mraid://close"].type, PNLiteMRAIDCommandTypeClose);
+}
+
+- (void)test_parseCommandUrl_withParameterWithoutValue_shouldNotCrash
+{
+    XCTAssertEqualObjects([self.parser parseCommandUrl:@"mraid://open?url"].parameter, @"");
+    XCTAssertEqualObjects([self.parser parseCommandUrl:@"mraid://setOrientationProperties?allowOrientationChange=true&forceOrientation"].parameter[@"forceOrientation"], @"");
+    XCTAssertEqualObjects([self.parser parseCommandUrl:@"mraid://useCustomClose?&useCustomClose=true&"].parameter, @"true");
+}
+
+- (void)test_parseCommandUrl_withInvalidCommand_shouldReturnNil
+{
+    XCTAssertNil([self.parser parseCommandUrl:@"mraid://closed"]);
+    XCTAssertNil([self.parser parseCommandUrl:@"mraid://resiz"]);
+    XCTAssertNil([self.parser parseCommandUrl:@"mraid:/"]);
+    XCTAssertNil([self.parser parseCommandUrl:@"https://example.com"]);
+    XCTAssertNil([self.parser parseCommandUrl:@"mraid://setResizeProperties?width=320&height=250"]);
+}
+
+@end
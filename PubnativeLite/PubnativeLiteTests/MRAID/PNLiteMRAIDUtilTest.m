@@ -0,0 +1,111 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+#import "PNLiteMRAIDUtil.h"
+
+// Shaped like the creatives the exchange serves: a full document, mraid.js tag in the head, an inline image and script
+static NSString *const kPNLiteMRAIDUtilCreative =
+@"<!DOCTYPE html>\n<html lang='en'>\n<head>\n<meta charset='utf-8'>\n"
+"<script type='text/javascript' src='mraid.js'></script>\n"
+"<style>#ad{width:320px;height:50px;background:url(data:image/png;base64,%@)}</style>\n"
+"</head>\n<body>\n<div id='ad' onclick=\"mraid.open('https://example.com/click')\"></div>\n"
+"<script>var assets='%@';function ready(){mraid.removeEventListener('ready',ready);}"
+"if(mraid.getState()==='loading'){mraid.addEventListener('ready',ready);}else{ready();}</script>\n"
+"</body>\n</html>";
+
+@interface PNLiteMRAIDUtilTest : XCTestCase
+
+@end
+
+@implementation PNLiteMRAIDUtilTest
+
+- (NSString *)creativeWithInlineAssetLength:(NSUInteger)length
+{
+    NSMutableString *asset = [NSMutableString stringWithCapacity:length];
+    while (asset.length < length) {
+        [asset appendString:@"iVBORw0KGgoAAAANSUhEUgAAAUAAAAAyCAYAAAAx8qzLAAAA"];
+    }
+    return [NSString stringWithFormat:kPNLiteMRAIDUtilCreative, asset, asset];
+}
+
+- (void)test_processRawHtml_withFragment_shouldWrapItInADocument
+{
+    NSString *html = [PNLiteMRAIDUtil processRawHtml:@"<script src='mraid.js'></script>\n<div>ad</div>"];
+    XCTAssertTrue([html hasPrefix:@"<html>\n<head>\n<meta name='viewport'"]);
+    XCTAssertTrue([html hasSuffix:@"<div align='center'>\n<div>ad</div></div>\n</body>\n</html>"]);
+    XCTAssertEqual([html rangeOfString:@"mraid.js"].location, NSNotFound);
+}
+
+- (void)test_processRawHtml_withDocument_shouldInjectAfterTheHeadTagOnce
+{
+    NSString *html = [PNLiteMRAIDUtil processRawHtml:@"<HTML><HEAD><title>t</title></HEAD><BODY><header>h</header>"
+                      "<SCRIPT  type = 'text/javascript'  SRC = \"MRAID.js\" > </script>\n</BODY></HTML>"];
+    XCTAssertTrue([html hasPrefix:@"<HTML><HEAD>\n<meta name='viewport'"]);
+    XCTAssertEqual([html componentsSeparatedByString:@"<meta name='viewport'"].count, 2);
+    XCTAssertTrue([html hasSuffix:@"</style><title>t</title></HEAD><BODY><header>h</header></BODY></HTML>"]);
+}
+
+- (void)test_processRawHtml_withoutHead_shouldAddOne
+{
+    NSString *html = [PNLiteMRAIDUtil processRawHtml:@"<html lang='en'><body>ad</body></html>"];
+    XCTAssertTrue([html hasPrefix:@"<html lang='en'>\n<head>\n<meta name='viewport'"]);
+    XCTAssertTrue([html hasSuffix:@"</style>\n</head><body>ad</body></html>"]);
+}
+
+- (void)test_processRawHtml_withOtherScripts_shouldKeepThem
+{
+    NSString *raw = @"<html><head><script src='mraid.json'></script><script data-src=\"x.js\"></script></head><body></body></html>";
+    NSString *html = [PNLiteMRAIDUtil processRawHtml:raw];
+    XCTAssertNotEqual([html rangeOfString:@"<script src='mraid.json'></script>"].location, NSNotFound);
+    XCTAssertNotEqual([html rangeOfString:@"<script data-src=\"x.js\"></script>"].location, NSNotFound);
+}
+
+- (void)test_processRawHtml_withInvalidStructure_shouldReturnNil
+{
+    XCTAssertNil([PNLiteMRAIDUtil processRawHtml:@"<html><head></head></html>"]);
+    XCTAssertNil([PNLiteMRAIDUtil processRawHtml:@"<body>ad</body>"]);
+    XCTAssertNil([PNLiteMRAIDUtil processRawHtml:nil]);
+}
+
+- (void)test_processRawHtml_withLargeCreative_shouldOnlyAddTheHeadContent
+{
+    NSString *empty = [PNLiteMRAIDUtil processRawHtml:@"<html><head></head><body></body></html>"];
+    // Whatever lands between <html><head> and </head><body></body></html>
+    NSString *headContent = [empty substringWithRange:NSMakeRange(12, empty.length - 12 - 27)];
+    NSString *raw = [self creativeWithInlineAssetLength:256 * 1024];
+    NSString *expected = [[raw stringByReplacingOccurrencesOfString:@"<script type='text/javascript' src='mraid.js'></script>\n" withString:@""]
+                          stringByReplacingOccurrencesOfString:@"<head>" withString:[@"<head>" stringByAppendingString:headContent]];
+    XCTAssertEqualObjects([PNLiteMRAIDUtil processRawHtml:raw], expected);
+}
+
+- (void)test_processRawHtml_performanceWithLargeCreative
+{
+    NSString *raw = [self creativeWithInlineAssetLength:300 * 1024];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 20; i++) {
+            XCTAssertNotNil([PNLiteMRAIDUtil processRawHtml:raw]);
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,86 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+#import "PNLiteMRAIDWebViewPool.h"
+
+@interface PNLiteMRAIDWebViewPoolTest : XCTestCase
+
+@property (nonatomic, strong) PNLiteMRAIDWebViewPool *pool;
+
+@end
+
+@implementation PNLiteMRAIDWebViewPoolTest
+
+- (void)setUp
+{
+    [super setUp];
+    self.pool = [[PNLiteMRAIDWebViewPool alloc] init];
+}
+
+- (void)tearDown
+{
+    [self.pool removeAllIdleWebViews];
+    self.pool = nil;
+    [super tearDown];
+}
+
+- (void)test_formatForSize_shouldMatchTheAdFormats
+{
+    XCTAssertEqual([PNLiteMRAIDWebViewPool formatForSize:CGSizeMake(320, 50) isInterstitial:NO], PNLiteMRAIDWebViewPoolFormatBanner);
+    XCTAssertEqual([PNLiteMRAIDWebViewPool formatForSize:CGSizeMake(300, 250) isInterstitial:NO], PNLiteMRAIDWebViewPoolFormatMRect);
+    XCTAssertEqual([PNLiteMRAIDWebViewPool formatForSize:CGSizeMake(728, 90) isInterstitial:NO], PNLiteMRAIDWebViewPoolFormatLeaderboard);
+    XCTAssertEqual([PNLiteMRAIDWebViewPool formatForSize:CGSizeMake(320, 50) isInterstitial:YES], PNLiteMRAIDWebViewPoolFormatInterstitial);
+}
+
+- (void)test_recycleWebView_shouldHandTheSameWebViewToTheNextAd
+{
+    WKWebView *webView = [self.pool dequeueWebViewWithFrame:CGRectMake(0, 0, 320, 50) forFormat:PNLiteMRAIDWebViewPoolFormatBanner];
+    UIView *container = [[UIView alloc] init];
+    [container addSubview:webView];
+    [self.pool recycleWebView:webView];
+    XCTAssertNil(webView.superview);
+    XCTAssertEqual(self.pool.idleCount, 1);
+    
+    WKWebView *reused = [self.pool dequeueWebViewWithFrame:CGRectMake(0, 0, 320, 50) forFormat:PNLiteMRAIDWebViewPoolFormatBanner];
+    XCTAssertEqual(reused, webView);
+    XCTAssertTrue(reused.configuration.allowsInlineMediaPlayback);
+}
+
+- (void)test_recycleWebView_withForeignWebView_shouldNotKeepIt
+{
+    [self.pool prewarmForFormat:PNLiteMRAIDWebViewPoolFormatBanner];
+    WKWebView *webView = [[WKWebView alloc] initWithFrame:CGRectZero configuration:[[WKWebViewConfiguration alloc] init]];
+    [self.pool recycleWebView:webView];
+    XCTAssertEqual(self.pool.idleCount, 0);
+}
+
+- (void)test_memoryWarning_shouldReleaseIdleWebViews
+{
+    WKWebView *webView = [self.pool dequeueWebViewWithFrame:CGRectMake(0, 0, 300, 250) forFormat:PNLiteMRAIDWebViewPoolFormatMRect];
+    [self.pool recycleWebView:webView];
+    XCTAssertEqual(self.pool.idleCount, 1);
+    [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    XCTAssertEqual(self.pool.idleCount, 0);
+}
+
+@end
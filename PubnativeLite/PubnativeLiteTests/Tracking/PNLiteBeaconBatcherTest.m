@@ -0,0 +1,223 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+#import <XCTest/XCTest.h>
+#import <OCHamcrestIOS/OCHamcrestIOS.h>
+#import <OCMockitoIOS/OCMockitoIOS.h>
+#import "PNLiteBeaconBatcher.h"
+#import "PNLiteHttpRequest.h"
+
+static NSString *const kPNLiteBeaconBatcherTestSuite = @"PNLiteBeaconBatcherTest";
+// Longer than the batch window
+NSTimeInterval const kPNLiteBeaconBatcherTestWindowWait = 0.7;
+
+@interface PNLiteBeaconBatch : NSObject
+
+@property (nonatomic, strong) NSMutableArray<NSURL *> *urls;
+
+@end
+
+@interface PNLiteBeaconBatcher (private) <PNLiteHttpRequestDelegate>
+
+@property (nonatomic, strong) NSMapTable<PNLiteHttpRequest *, PNLiteBeaconBatch *> *inFlightBatches;
+
+- (instancetype)initWithUserDefaults:(NSUserDefaults *)userDefaults;
+- (void)sendBatch:(PNLiteBeaconBatch *)batch withBody:(NSData *)body;
+
+@end
+
+// Records batches instead of posting them, each one gets an unstarted request to finish by hand
+@interface PNLiteBeaconBatcherTestDouble : PNLiteBeaconBatcher
+
+@property (nonatomic, strong) NSMutableArray<PNLiteBeaconBatch *> *sentBatches;
+@property (nonatomic, strong) NSMutableArray<PNLiteHttpRequest *> *requests;
+
+@end
+
+@implementation PNLiteBeaconBatcherTestDouble
+
+- (void)sendBatch:(PNLiteBeaconBatch *)batch withBody:(NSData *)body {
+    if (!self.sentBatches) {
+        self.sentBatches = [NSMutableArray array];
+        self.requests = [NSMutableArray array];
+    }
+    PNLiteHttpRequest *request = [[PNLiteHttpRequest alloc] init];
+    [self.inFlightBatches setObject:batch forKey:request];
+    [self.sentBatches addObject:batch];
+    [self.requests addObject:request];
+}
+
+@end
+
+@interface PNLiteBeaconBatcherTest : XCTestCase
+
+@property (nonatomic, strong) NSUserDefaults *userDefaults;
+@property (nonatomic, strong) PNLiteBeaconBatcherTestDouble *batcher;
+@property (nonatomic, strong) NSObject<PNLiteBeaconBatcherDelegate> *delegate;
+
+@end
+
+@implementation PNLiteBeaconBatcherTest
+
+- (void)setUp
+{
+    [super setUp];
+    [[NSUserDefaults standardUserDefaults] removePersistentDomainForName:kPNLiteBeaconBatcherTestSuite];
+    self.userDefaults = [[NSUserDefaults alloc] initWithSuiteName:kPNLiteBeaconBatcherTestSuite];
+    self.delegate = mockProtocol(@protocol(PNLiteBeaconBatcherDelegate));
+    self.batcher = [self batcherWithUserDefaults:self.userDefaults];
+}
+
+- (void)tearDown
+{
+    self.batcher = nil;
+    self.delegate = nil;
+    self.userDefaults = nil;
+    [[NSUserDefaults standardUserDefaults] removePersistentDomainForName:kPNLiteBeaconBatcherTestSuite];
+    [super tearDown];
+}
+
+- (PNLiteBeaconBatcherTestDouble *)batcherWithUserDefaults:(NSUserDefaults *)userDefaults
+{
+    PNLiteBeaconBatcherTestDouble *batcher = [[PNLiteBeaconBatcherTestDouble alloc] initWithUserDefaults:userDefaults];
+    batcher.delegate = self.delegate;
+    return batcher;
+}
+
+- (NSArray<NSURL *> *)beaconURLsWithCount:(NSUInteger)count
+{
+    NSMutableArray<NSURL *> *urls = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [urls addObject:[NSURL URLWithString:[NSString stringWithFormat:@"https://got.pubnative.net/impression?id=%lu", (unsigned long)i]]];
+    }
+    return urls;
+}
+
+- (void)addURLs:(NSArray<NSURL *> *)urls
+{
+    for (NSURL *url in urls) {
+        [self.batcher addURL:url];
+    }
+}
+
+- (void)waitForTimeInterval:(NSTimeInterval)interval
+{
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:interval]];
+}
+
+- (void)test_canBatchURL_withThirdPartyHost_shouldReturnNo
+{
+    XCTAssertTrue([self.batcher canBatchURL:[NSURL URLWithString:@"https://GOT.pubnative.net/click"]]);
+    XCTAssertFalse([self.batcher canBatchURL:[NSURL URLWithString:@"https://tracker.example.com/click"]]);
+}
+
+- (void)test_addURL_shouldFlushWhenWindowCloses
+{
+    NSArray<NSURL *> *urls = [self beaconURLsWithCount:3];
+    [self addURLs:urls];
+    XCTAssertEqual(self.batcher.sentBatches.count, 0);
+    XCTAssertTrue(self.batcher.hasUndeliveredURLs);
+    
+    [self waitForTimeInterval:kPNLiteBeaconBatcherTestWindowWait];
+    XCTAssertEqual(self.batcher.sentBatches.count, 1);
+    XCTAssertEqualObjects(self.batcher.sentBatches.firstObject.urls, urls);
+}
+
+- (void)test_addURL_overMaxBatchSize_shouldSplitBatches
+{
+    NSArray<NSURL *> *urls = [self beaconURLsWithCount:25];
+    [self addURLs:urls];
+    // A full batch goes out without waiting for the window
+    XCTAssertEqual(self.batcher.sentBatches.count, 1);
+    XCTAssertEqualObjects(self.batcher.sentBatches[0].urls, [urls subarrayWithRange:NSMakeRange(0, 20)]);
+    
+    [self waitForTimeInterval:kPNLiteBeaconBatcherTestWindowWait];
+    XCTAssertEqual(self.batcher.sentBatches.count, 2);
+    XCTAssertEqualObjects(self.batcher.sentBatches[1].urls, [urls subarrayWithRange:NSMakeRange(20, 5)]);
+}
+
+- (void)test_addURL_withSingleURLInWindow_shouldFallBackToGet
+{
+    NSArray<NSURL *> *urls = [self beaconURLsWithCount:1];
+    [self addURLs:urls];
+    [self waitForTimeInterval:kPNLiteBeaconBatcherTestWindowWait];
+    XCTAssertEqual(self.batcher.sentBatches.count, 0);
+    [verify(self.delegate) batcher:self.batcher didFailToDeliverURLs:urls];
+    XCTAssertFalse(self.batcher.hasUndeliveredURLs);
+}
+
+- (void)test_finishBatch_withSuccess_shouldForgetURLs
+{
+    NSArray<NSURL *> *urls = [self beaconURLsWithCount:2];
+    [self addURLs:urls];
+    [self waitForTimeInterval:kPNLiteBeaconBatcherTestWindowWait];
+    [self.batcher request:self.batcher.requests.firstObject didFinishWithData:nil statusCode:204];
+    [self waitForTimeInterval:0.1];
+    
+    [verify(self.delegate) batcher:self.batcher didDeliverURLs:urls];
+    [verifyCount(self.delegate, never()) batcher:anything() didFailToDeliverURLs:anything()];
+    XCTAssertFalse(self.batcher.hasUndeliveredURLs);
+    XCTAssertNil([self.userDefaults objectForKey:@"PNLiteBeaconBatcher.queue.key"]);
+}
+
+- (void)test_finishBatch_withUnsupportedEndpoint_shouldMarkHostUnavailable
+{
+    for (NSNumber *statusCode in @[@404, @405, @501]) {
+        self.batcher = [self batcherWithUserDefaults:self.userDefaults];
+        NSArray<NSURL *> *urls = [self beaconURLsWithCount:2];
+        [self addURLs:urls];
+        [self waitForTimeInterval:kPNLiteBeaconBatcherTestWindowWait];
+        [self.batcher request:self.batcher.requests.firstObject didFinishWithData:nil statusCode:statusCode.integerValue];
+        [self waitForTimeInterval:0.1];
+        
+        XCTAssertFalse([self.batcher canBatchURL:urls.firstObject], @"status code %@", statusCode);
+        [verify(self.delegate) batcher:self.batcher didFailToDeliverURLs:urls];
+    }
+}
+
+- (void)test_finishBatch_withServerError_shouldKeepHostAvailable
+{
+    NSArray<NSURL *> *urls = [self beaconURLsWithCount:2];
+    [self addURLs:urls];
+    [self waitForTimeInterval:kPNLiteBeaconBatcherTestWindowWait];
+    [self.batcher request:self.batcher.requests.firstObject didFinishWithData:nil statusCode:503];
+    [self waitForTimeInterval:0.1];
+    
+    XCTAssertTrue([self.batcher canBatchURL:urls.firstObject]);
+    [verify(self.delegate) batcher:self.batcher didFailToDeliverURLs:urls];
+}
+
+- (void)test_start_withURLsLeftByPreviousLaunch_shouldBatchThemAgain
+{
+    NSArray<NSURL *> *urls = [self beaconURLsWithCount:2];
+    [self addURLs:urls];
+    [self waitForTimeInterval:kPNLiteBeaconBatcherTestWindowWait];
+    // The app is killed while the POST is in flight
+    self.batcher = [self batcherWithUserDefaults:self.userDefaults];
+    [self.batcher start];
+    XCTAssertTrue(self.batcher.hasUndeliveredURLs);
+    
+    [self waitForTimeInterval:kPNLiteBeaconBatcherTestWindowWait];
+    XCTAssertEqual(self.batcher.sentBatches.count, 1);
+    XCTAssertEqualObjects(self.batcher.sentBatches.firstObject.urls, urls);
+}
+
+@end
@@ -0,0 +1,110 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+#import "PNLiteBeaconDeduplicator.h"
+
+static NSString *const kPNLiteBeaconDeduplicatorTestSuite = @"PNLiteBeaconDeduplicatorTest";
+
+@interface PNLiteBeaconDeduplicator (private)
+
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *firedBeacons;
+
+- (instancetype)initWithUserDefaults:(NSUserDefaults *)userDefaults;
+- (BOOL)registerBeaconWithURL:(NSString *)url forAdIdentifier:(NSString *)adIdentifier atTime:(NSTimeInterval)now;
+
+@end
+
+@interface PNLiteBeaconDeduplicatorTest : XCTestCase
+
+@property (nonatomic, strong) NSUserDefaults *userDefaults;
+@property (nonatomic, strong) PNLiteBeaconDeduplicator *deduplicator;
+
+@end
+
+@implementation PNLiteBeaconDeduplicatorTest
+
+- (void)setUp
+{
+    [super setUp];
+    [[NSUserDefaults standardUserDefaults] removePersistentDomainForName:kPNLiteBeaconDeduplicatorTestSuite];
+    self.userDefaults = [[NSUserDefaults alloc] initWithSuiteName:kPNLiteBeaconDeduplicatorTestSuite];
+    self.deduplicator = [[PNLiteBeaconDeduplicator alloc] initWithUserDefaults:self.userDefaults];
+}
+
+- (void)tearDown
+{
+    self.deduplicator = nil;
+    self.userDefaults = nil;
+    [[NSUserDefaults standardUserDefaults] removePersistentDomainForName:kPNLiteBeaconDeduplicatorTestSuite];
+    [super tearDown];
+}
+
+- (void)test_registerBeacon_withSameAd_shouldSuppressUntilExpired
+{
+    XCTAssertTrue([self.deduplicator registerBeaconWithURL:@"https://example.com/imp" forAdIdentifier:@"ad1" atTime:1000]);
+    XCTAssertFalse([self.deduplicator registerBeaconWithURL:@"https://example.com/imp" forAdIdentifier:@"ad1" atTime:2799]);
+    XCTAssertTrue([self.deduplicator registerBeaconWithURL:@"https://example.com/imp" forAdIdentifier:@"ad2" atTime:2799]);
+    XCTAssertTrue([self.deduplicator registerBeaconWithURL:@"https://example.com/imp" forAdIdentifier:@"ad1" atTime:2800]);
+}
+
+- (void)test_registerBeacon_withoutAdIdentifier_shouldNeverSuppress
+{
+    XCTAssertTrue([self.deduplicator registerBeaconWithURL:@"https://example.com/imp" forAdIdentifier:nil atTime:1000]);
+    XCTAssertTrue([self.deduplicator registerBeaconWithURL:@"https://example.com/imp" forAdIdentifier:nil atTime:1000]);
+    XCTAssertTrue([self.deduplicator registerBeaconWithURL:@"https://example.com/imp" forAdIdentifier:@"" atTime:1000]);
+    XCTAssertEqual(self.deduplicator.firedBeacons.count, 0);
+}
+
+- (void)test_registerBeacon_overCapacity_shouldForgetOldestLiveEntry
+{
+    for (NSUInteger i = 0; i < 1025; i++) {
+        NSString *url = [NSString stringWithFormat:@"https://example.com/imp/%lu", (unsigned long)i];
+        XCTAssertTrue([self.deduplicator registerBeaconWithURL:url forAdIdentifier:@"ad" atTime:1000 + i]);
+    }
+    XCTAssertEqual(self.deduplicator.firedBeacons.count, 1024);
+    XCTAssertFalse([self.deduplicator registerBeaconWithURL:@"https://example.com/imp/1024" forAdIdentifier:@"ad" atTime:2100]);
+    XCTAssertFalse([self.deduplicator registerBeaconWithURL:@"https://example.com/imp/1" forAdIdentifier:@"ad" atTime:2100]);
+    XCTAssertTrue([self.deduplicator registerBeaconWithURL:@"https://example.com/imp/0" forAdIdentifier:@"ad" atTime:2100]);
+}
+
+- (void)test_registerBeacon_overCapacity_shouldDropExpiredEntriesFirst
+{
+    [self.deduplicator registerBeaconWithURL:@"https://example.com/expired" forAdIdentifier:@"ad" atTime:0];
+    [self.deduplicator registerBeaconWithURL:@"https://example.com/live" forAdIdentifier:@"ad" atTime:1000];
+    for (NSUInteger i = 0; i < 1023; i++) {
+        NSString *url = [NSString stringWithFormat:@"https://example.com/imp/%lu", (unsigned long)i];
+        [self.deduplicator registerBeaconWithURL:url forAdIdentifier:@"ad" atTime:1900];
+    }
+    XCTAssertEqual(self.deduplicator.firedBeacons.count, 1024);
+    XCTAssertFalse([self.deduplicator registerBeaconWithURL:@"https://example.com/live" forAdIdentifier:@"ad" atTime:1900]);
+}
+
+- (void)test_registerBeacon_afterRelaunch_shouldStillSuppress
+{
+    [self.deduplicator registerBeaconWithURL:@"https://example.com/imp" forAdIdentifier:@"ad1" atTime:1000];
+    PNLiteBeaconDeduplicator *relaunched = [[PNLiteBeaconDeduplicator alloc] initWithUserDefaults:self.userDefaults];
+    XCTAssertFalse([relaunched registerBeaconWithURL:@"https://example.com/imp" forAdIdentifier:@"ad1" atTime:1500]);
+    XCTAssertTrue([relaunched registerBeaconWithURL:@"https://example.com/other" forAdIdentifier:@"ad1" atTime:1500]);
+}
+
+@end
@@ -0,0 +1,128 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+#import "PNLiteImpressionTrackerItem.h"
+
+@interface PNLiteImpressionTrackerItemTest : XCTestCase
+
+@end
+
+@implementation PNLiteImpressionTrackerItemTest
+
+- (PNLiteImpressionTrackerItem *)itemWithMode:(PNLiteImpressionRuleMode)mode
+{
+    PNLiteImpressionTrackerItem *item = [[PNLiteImpressionTrackerItem alloc] init];
+    item.rule = [PNLiteImpressionRule ruleWithMinVisibility:0.5f minExposureTime:1 mode:mode];
+    return item;
+}
+
+- (void)test_continuous_withUninterruptedExposure_shouldMeetRule
+{
+    PNLiteImpressionTrackerItem *item = [self itemWithMode:PNLiteImpressionRuleModeContinuous];
+    [item markVisibleAtUptime:100];
+    [item markVisibleAtUptime:100.5];
+    XCTAssertEqualWithAccuracy([item exposureAtUptime:100.9], 0.9, 0.0001);
+    XCTAssertFalse([item meetsRuleAtUptime:100.9]);
+    XCTAssertTrue([item meetsRuleAtUptime:101]);
+}
+
+- (void)test_continuous_withExposureLoss_shouldResetExposure
+{
+    PNLiteImpressionTrackerItem *item = [self itemWithMode:PNLiteImpressionRuleModeContinuous];
+    [item markVisibleAtUptime:100];
+    [item markInvisibleAtUptime:100.8];
+    XCTAssertEqual([item exposureAtUptime:100.9], 0);
+    XCTAssertEqual(item.accumulatedExposure, 0);
+    [item markVisibleAtUptime:101];
+    XCTAssertEqualWithAccuracy([item exposureAtUptime:101.8], 0.8, 0.0001);
+    XCTAssertFalse([item meetsRuleAtUptime:101.8]);
+    XCTAssertTrue([item meetsRuleAtUptime:102]);
+}
+
+- (void)test_cumulative_withExposureLoss_shouldAddUpVisiblePeriods
+{
+    PNLiteImpressionTrackerItem *item = [self itemWithMode:PNLiteImpressionRuleModeCumulative];
+    [item markVisibleAtUptime:100];
+    [item markInvisibleAtUptime:100.6];
+    XCTAssertEqualWithAccuracy([item exposureAtUptime:105], 0.6, 0.0001);
+    XCTAssertFalse([item meetsRuleAtUptime:105]);
+    [item markVisibleAtUptime:105];
+    XCTAssertFalse([item meetsRuleAtUptime:105.3]);
+    XCTAssertTrue([item meetsRuleAtUptime:105.4]);
+}
+
+- (void)test_markInvisible_whenNotVisible_shouldNotAccumulate
+{
+    PNLiteImpressionTrackerItem *item = [self itemWithMode:PNLiteImpressionRuleModeCumulative];
+    [item markInvisibleAtUptime:100];
+    XCTAssertEqual(item.accumulatedExposure, 0);
+    XCTAssertEqual(item.visibleSince, 0);
+}
+
+- (void)test_ruleForAdSize_shouldPickLargeFormatFrom242500Points
+{
+    XCTAssertEqualWithAccuracy([PNLiteImpressionRule ruleForAdSize:CGSizeMake(320, 50)].minVisibility, 0.5, 0.0001);
+    XCTAssertEqualWithAccuracy([PNLiteImpressionRule ruleForAdSize:CGSizeMake(969, 250)].minVisibility, 0.5, 0.0001);
+    XCTAssertEqualWithAccuracy([PNLiteImpressionRule ruleForAdSize:CGSizeMake(970, 250)].minVisibility, 0.3, 0.0001);
+    XCTAssertEqual([PNLiteImpressionRule ruleForAdSize:CGSizeMake(970, 250)].minExposureTime, 1);
+}
+
+- (void)test_videoRule_shouldNeedTwoContinuousSeconds
+{
+    PNLiteImpressionRule *rule = [PNLiteImpressionRule videoRule];
+    XCTAssertEqualWithAccuracy(rule.minVisibility, 0.5, 0.0001);
+    XCTAssertEqual(rule.minExposureTime, 2);
+    XCTAssertEqual(rule.mode, PNLiteImpressionRuleModeContinuous);
+}
+
+- (void)test_resolveRuleFromViewSize_shouldWaitForNonZeroBounds
+{
+    UIView *view = [[UIView alloc] initWithFrame:CGRectZero];
+    PNLiteImpressionTrackerItem *item = [[PNLiteImpressionTrackerItem alloc] init];
+    item.view = view;
+    item.rule = [PNLiteImpressionRule displayRule];
+    item.resolvesRuleFromViewSize = YES;
+    
+    XCTAssertFalse([item resolveRuleFromViewSize]);
+    XCTAssertEqualWithAccuracy(item.rule.minVisibility, 0.5, 0.0001);
+    
+    view.frame = CGRectMake(0, 0, 970, 250);
+    XCTAssertTrue([item resolveRuleFromViewSize]);
+    XCTAssertEqualWithAccuracy(item.rule.minVisibility, 0.3, 0.0001);
+    XCTAssertFalse(item.resolvesRuleFromViewSize);
+    
+    view.frame = CGRectMake(0, 0, 320, 50);
+    XCTAssertFalse([item resolveRuleFromViewSize]);
+    XCTAssertEqualWithAccuracy(item.rule.minVisibility, 0.3, 0.0001);
+}
+
+- (void)test_resolveRuleFromViewSize_withFixedRule_shouldKeepIt
+{
+    PNLiteImpressionTrackerItem *item = [[PNLiteImpressionTrackerItem alloc] init];
+    item.view = [[UIView alloc] initWithFrame:CGRectMake(0, 0, 970, 250)];
+    item.rule = [PNLiteImpressionRule videoRule];
+    XCTAssertFalse([item resolveRuleFromViewSize]);
+    XCTAssertEqual(item.rule.minExposureTime, 2);
+}
+
+@end
@@ -0,0 +1,199 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+#import <WebKit/WebKit.h>
+#import <OCHamcrestIOS/OCHamcrestIOS.h>
+#import <OCMockitoIOS/OCMockitoIOS.h>
+#import "PNLiteJSBeaconEngine.h"
+
+@interface PNLiteJSBeaconEngine (private) <WKNavigationDelegate, WKScriptMessageHandler>
+
+@property (nonatomic, strong) NSMutableArray *pool;
+@property (nonatomic, assign) NSTimeInterval scriptTimeout;
+
+- (WKWebView *)createWebView;
+
+@end
+
+// Hands out mocked web views, so no web content process is involved
+@interface PNLiteJSBeaconEngineWithMockedWebViews : PNLiteJSBeaconEngine
+
+@property (nonatomic, strong) NSMutableArray<WKWebView *> *createdWebViews;
+@property (nonatomic, strong) WKNavigation *navigation;
+
+@end
+
+@implementation PNLiteJSBeaconEngineWithMockedWebViews
+
+- (WKWebView *)createWebView
+{
+    if (!self.createdWebViews) {
+        self.createdWebViews = [NSMutableArray array];
+    }
+    WKWebView *webView = mock([WKWebView class]);
+    [given([webView loadHTMLString:anything() baseURL:anything()]) willReturn:self.navigation];
+    [self.createdWebViews addObject:webView];
+    return webView;
+}
+
+@end
+
+@interface PNLiteJSBeaconEngineTest : XCTestCase
+
+@property (nonatomic, strong) PNLiteJSBeaconEngineWithMockedWebViews *engine;
+
+@end
+
+@implementation PNLiteJSBeaconEngineTest
+
+- (void)setUp
+{
+    [super setUp];
+    self.engine = [[PNLiteJSBeaconEngineWithMockedWebViews alloc] init];
+    self.engine.navigation = mock([WKNavigation class]);
+}
+
+- (void)tearDown
+{
+    self.engine = nil;
+    [super tearDown];
+}
+
+- (void)drainMainQueue
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"main queue"];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [expectation fulfill];
+    });
+    [self waitForExpectationsWithTimeout:1 handler:nil];
+}
+
+- (id)slot
+{
+    return self.engine.pool.firstObject;
+}
+
+- (void)postSettleMessageForSlot:(id)slot generation:(NSUInteger)generation
+{
+    WKScriptMessage *message = mock([WKScriptMessage class]);
+    [given([message webView]) willReturn:[slot valueForKey:@"webView"]];
+    [given([message body]) willReturn:@(generation)];
+    [self.engine userContentController:mock([WKUserContentController class]) didReceiveScriptMessage:message];
+}
+
+- (void)test_evaluateBeaconScript_shouldLoadFreshDocumentBeforeRunningScript
+{
+    [self.engine evaluateBeaconScript:@"beacon()" completion:nil];
+    [self drainMainQueue];
+    WKWebView *webView = [[self slot] valueForKey:@"webView"];
+    [verify(webView) loadHTMLString:anything() baseURL:anything()];
+    [verifyCount(webView, never()) evaluateJavaScript:anything() completionHandler:anything()];
+    
+    [self.engine webView:webView didFinishNavigation:mock([WKNavigation class])];
+    [verifyCount(webView, never()) evaluateJavaScript:anything() completionHandler:anything()];
+    
+    [self.engine webView:webView didFinishNavigation:self.engine.navigation];
+    [verify(webView) evaluateJavaScript:@"beacon()" completionHandler:anything()];
+}
+
+- (void)test_evaluateBeaconScript_shouldCompleteOnSettleMessageOnly
+{
+    __block NSUInteger completions = 0;
+    __block NSError *completionError = nil;
+    [self.engine evaluateBeaconScript:@"beacon()" completion:^(NSError *error) {
+        completions++;
+        completionError = error;
+    }];
+    [self drainMainQueue];
+    id slot = [self slot];
+    NSUInteger generation = [[slot valueForKey:@"jobGeneration"] unsignedIntegerValue];
+    
+    [self postSettleMessageForSlot:slot generation:generation - 1];
+    XCTAssertEqual(completions, 0);
+    XCTAssertNotNil([slot valueForKey:@"currentJob"]);
+    
+    [self postSettleMessageForSlot:slot generation:generation];
+    XCTAssertEqual(completions, 1);
+    XCTAssertNil(completionError);
+    XCTAssertNil([slot valueForKey:@"currentJob"]);
+    
+    [self postSettleMessageForSlot:slot generation:generation];
+    XCTAssertEqual(completions, 1);
+}
+
+- (void)test_evaluateBeaconScript_withHungScript_shouldTimeOutAndReplaceWebView
+{
+    self.engine.scriptTimeout = 0.1;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"timeout"];
+    __block NSError *completionError = nil;
+    [self.engine evaluateBeaconScript:@"while (true) {}" completion:^(NSError *error) {
+        completionError = error;
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    
+    XCTAssertNotNil(completionError);
+    XCTAssertEqual(self.engine.createdWebViews.count, 2);
+    id slot = [self slot];
+    XCTAssertEqual([slot valueForKey:@"webView"], self.engine.createdWebViews.lastObject);
+    XCTAssertEqual([[slot valueForKey:@"evaluatedScripts"] unsignedIntegerValue], 0);
+    XCTAssertNil([slot valueForKey:@"currentJob"]);
+    [verify(self.engine.createdWebViews.firstObject) stopLoading];
+}
+
+- (void)test_evaluateBeaconScript_afterTwentyScripts_shouldRecycleWebView
+{
+    __block NSUInteger completions = 0;
+    for (NSUInteger i = 0; i < 20; i++) {
+        [self.engine evaluateBeaconScript:@"beacon()" completion:^(NSError *error) {
+            XCTAssertNil(error);
+            completions++;
+        }];
+        [self drainMainQueue];
+        id slot = [self slot];
+        XCTAssertEqual([slot valueForKey:@"webView"], self.engine.createdWebViews.firstObject);
+        [self postSettleMessageForSlot:slot generation:[[slot valueForKey:@"jobGeneration"] unsignedIntegerValue]];
+    }
+    
+    XCTAssertEqual(completions, 20);
+    XCTAssertEqual(self.engine.pool.count, 1);
+    XCTAssertEqual(self.engine.createdWebViews.count, 2);
+    XCTAssertEqual([[self slot] valueForKey:@"webView"], self.engine.createdWebViews.lastObject);
+    XCTAssertEqual([[[self slot] valueForKey:@"evaluatedScripts"] unsignedIntegerValue], 0);
+}
+
+- (void)test_evaluateBeaconScript_withFailedNavigation_shouldCompleteWithError
+{
+    __block NSError *completionError = nil;
+    [self.engine evaluateBeaconScript:@"beacon()" completion:^(NSError *error) {
+        completionError = error;
+    }];
+    [self drainMainQueue];
+    WKWebView *webView = [[self slot] valueForKey:@"webView"];
+    NSError *error = [NSError errorWithDomain:@"navigation failed" code:0 userInfo:nil];
+    [self.engine webView:webView didFailProvisionalNavigation:self.engine.navigation withError:error];
+    XCTAssertEqual(completionError, error);
+    [verifyCount(webView, never()) evaluateJavaScript:anything() completionHandler:anything()];
+}
+
+@end
@@ -0,0 +1,135 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+#import <XCTest/XCTest.h>
+#import <OCHamcrestIOS/OCHamcrestIOS.h>
+#import <OCMockitoIOS/OCMockitoIOS.h>
+#import "PNLiteTrackingRetryScheduler.h"
+#import "PNLiteMonotonicClock.h"
+#import "PNLiteReachability.h"
+
+static NSString *const kPNLiteTrackingRetrySchedulerTestQueueKey = @"PNLiteTrackingRetrySchedulerTest.queue.key";
+NSTimeInterval const kPNLiteTrackingRetrySchedulerTestValidTime = 1800;
+
+@interface PNLiteTrackingRetryScheduler (private)
+
+@property (nonatomic, strong) PNLiteReachability *reachability;
+@property (nonatomic, assign) BOOL isOffline;
+
+- (NSMutableArray *)queue;
+- (void)reachabilityChanged:(NSNotification *)notification;
+
+@end
+
+@interface PNLiteTrackingRetrySchedulerTest : XCTestCase
+
+@property (nonatomic, strong) PNLiteTrackingRetryScheduler *scheduler;
+@property (nonatomic, strong) NSObject<PNLiteTrackingRetrySchedulerDelegate> *delegate;
+
+@end
+
+@implementation PNLiteTrackingRetrySchedulerTest
+
+- (void)setUp
+{
+    [super setUp];
+    [[NSUserDefaults standardUserDefaults] removeObjectForKey:kPNLiteTrackingRetrySchedulerTestQueueKey];
+    self.delegate = mockProtocol(@protocol(PNLiteTrackingRetrySchedulerDelegate));
+    self.scheduler = [[PNLiteTrackingRetryScheduler alloc] initWithQueueKey:kPNLiteTrackingRetrySchedulerTestQueueKey
+                                                                  validTime:kPNLiteTrackingRetrySchedulerTestValidTime];
+    self.scheduler.delegate = self.delegate;
+}
+
+- (void)tearDown
+{
+    self.scheduler = nil;
+    self.delegate = nil;
+    [[NSUserDefaults standardUserDefaults] removeObjectForKey:kPNLiteTrackingRetrySchedulerTestQueueKey];
+    [super tearDown];
+}
+
+- (PNLiteTrackingManagerItem *)itemWithAttempts:(NSInteger)attempts
+{
+    PNLiteTrackingManagerItem *item = [[PNLiteTrackingManagerItem alloc] initWithURL:[NSURL URLWithString:@"https://example.com/impression"]];
+    item.attempts = @(attempts);
+    return item;
+}
+
+- (PNLiteTrackingManagerItem *)queuedItemAtIndex:(NSUInteger)index
+{
+    return [[PNLiteTrackingManagerItem alloc] initWithDictionary:[self.scheduler queue][index]];
+}
+
+- (void)test_scheduleItem_afterEachFailure_shouldDoubleTheDelay
+{
+    // Equal jitter keeps the delay between half and all of 5s, 10s, 20s and 40s
+    NSTimeInterval expectedDelay = 5;
+    for (NSInteger attempts = 0; attempts < 4; attempts++) {
+        NSTimeInterval now = [PNLiteMonotonicClock uptime];
+        [self.scheduler scheduleItem:[self itemWithAttempts:attempts]];
+        PNLiteTrackingManagerItem *item = [self queuedItemAtIndex:attempts];
+        NSTimeInterval delay = [item.nextAttemptUptime doubleValue] - now;
+        
+        XCTAssertEqual([item.attempts integerValue], attempts + 1);
+        XCTAssertGreaterThanOrEqual(delay, expectedDelay / 2, @"attempt %ld", (long)attempts + 1);
+        XCTAssertLessThanOrEqual(delay, expectedDelay + 1, @"attempt %ld", (long)attempts + 1);
+        expectedDelay *= 2;
+    }
+}
+
+- (void)test_scheduleItem_afterFifthAttempt_shouldDropItem
+{
+    [self.scheduler scheduleItem:[self itemWithAttempts:3]];
+    XCTAssertEqual([self.scheduler queue].count, 1);
+    
+    [self.scheduler scheduleItem:[self itemWithAttempts:4]];
+    XCTAssertEqual([self.scheduler queue].count, 1);
+}
+
+- (void)test_scheduleItem_whileOffline_shouldNotCountAttempt
+{
+    self.scheduler.isOffline = YES;
+    [self.scheduler scheduleItem:[self itemWithAttempts:4]];
+    
+    XCTAssertEqual([self.scheduler queue].count, 1);
+    XCTAssertEqual([[self queuedItemAtIndex:0].attempts integerValue], 4);
+}
+
+- (void)test_reachabilityChanged_whenBackOnline_shouldReleaseWaitingItems
+{
+    PNLiteReachability *reachability = mock([PNLiteReachability class]);
+    [given([reachability currentReachabilityStatus]) willReturnInteger:PNLiteNetworkStatus_NotReachable];
+    self.scheduler.reachability = reachability;
+    self.scheduler.isOffline = YES;
+    [self.scheduler scheduleItem:[self itemWithAttempts:0]];
+    [self.scheduler scheduleItem:[self itemWithAttempts:2]];
+    [verifyCount(self.delegate, never()) retryScheduler:anything() didReleaseItems:anything()];
+    
+    [given([reachability currentReachabilityStatus]) willReturnInteger:PNLiteNetworkStatus_ReachableViaWiFi];
+    [self.scheduler reachabilityChanged:nil];
+    
+    HCArgumentCaptor *items = [[HCArgumentCaptor alloc] init];
+    [verify(self.delegate) retryScheduler:self.scheduler didReleaseItems:(id)items];
+    XCTAssertEqual([items.value count], 2);
+    XCTAssertEqual([self.scheduler queue].count, 0);
+}
+
+@end
@@ -0,0 +1,387 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+#import <malloc/malloc.h>
+#import <mach/mach.h>
+#import <stdatomic.h>
+#import "HyBidVisibilityTracker.h"
+#import "PNLiteImpressionTracker.h"
+#import "PNLiteVisibilityScheduler.h"
+#import "PNLiteMonotonicClock.h"
+
+// Thresholds are relative to the feed size or the scheduler rate, so they hold on any machine
+double const kPNLiteBenchmarkMaxScalingFactor = 3; // per view tick time of a 1,000 ad feed vs a single ad
+double const kPNLiteBenchmarkMaxAllocationsPerViewAndTick = 2; // malloc blocks, a tick shouldn't allocate per view state
+NSInteger const kPNLiteBenchmarkSchedulerJitter = 2; // display link fires allowed above the scheduler rate
+NSUInteger const kPNLiteBenchmarkTicks = 20;
+NSUInteger const kPNLiteBenchmarkDefaultDepth = 5;
+CGFloat const kPNLiteBenchmarkCellHeight = 250;
+
+#pragma mark Allocation counting
+
+static atomic_ullong PNLiteBenchmarkAllocations;
+static void *(*PNLiteBenchmarkOriginalMalloc)(struct _malloc_zone_t *zone, size_t size);
+static void *(*PNLiteBenchmarkOriginalCalloc)(struct _malloc_zone_t *zone, size_t count, size_t size);
+static void *(*PNLiteBenchmarkOriginalRealloc)(struct _malloc_zone_t *zone, void *pointer, size_t size);
+
+static void *PNLiteBenchmarkMalloc(struct _malloc_zone_t *zone, size_t size)
+{
+    atomic_fetch_add(&PNLiteBenchmarkAllocations, 1);
+    return PNLiteBenchmarkOriginalMalloc(zone, size);
+}
+
+static void *PNLiteBenchmarkCalloc(struct _malloc_zone_t *zone, size_t count, size_t size)
+{
+    atomic_fetch_add(&PNLiteBenchmarkAllocations, 1);
+    return PNLiteBenchmarkOriginalCalloc(zone, count, size);
+}
+
+static void *PNLiteBenchmarkRealloc(struct _malloc_zone_t *zone, void *pointer, size_t size)
+{
+    atomic_fetch_add(&PNLiteBenchmarkAllocations, 1);
+    return PNLiteBenchmarkOriginalRealloc(zone, pointer, size);
+}
+
+// Swaps the default zone's allocation functions for counting ones, the zone is read only outside of the swap
+static void PNLiteBenchmarkSetAllocationCounting(BOOL enabled)
+{
+    malloc_zone_t *zone = malloc_default_zone();
+    vm_protect(mach_task_self(), (vm_address_t)zone, sizeof(malloc_zone_t), 0, VM_PROT_READ | VM_PROT_WRITE);
+    if (enabled && !PNLiteBenchmarkOriginalMalloc) {
+        PNLiteBenchmarkOriginalMalloc = zone->malloc;
+        PNLiteBenchmarkOriginalCalloc = zone->calloc;
+        PNLiteBenchmarkOriginalRealloc = zone->realloc;
+        zone->malloc = PNLiteBenchmarkMalloc;
+        zone->calloc = PNLiteBenchmarkCalloc;
+        zone->realloc = PNLiteBenchmarkRealloc;
+    } else if (!enabled && PNLiteBenchmarkOriginalMalloc) {
+        zone->malloc = PNLiteBenchmarkOriginalMalloc;
+        zone->calloc = PNLiteBenchmarkOriginalCalloc;
+        zone->realloc = PNLiteBenchmarkOriginalRealloc;
+        PNLiteBenchmarkOriginalMalloc = NULL;
+        PNLiteBenchmarkOriginalCalloc = NULL;
+        PNLiteBenchmarkOriginalRealloc = NULL;
+    }
+    vm_protect(mach_task_self(), (vm_address_t)zone, sizeof(malloc_zone_t), 0, VM_PROT_READ);
+}
+
+@interface HyBidVisibilityTracker () <PNLiteVisibilitySchedulerObserver>
+
+- (void)checkVisibility;
+
+@end
+
+@interface PNLiteImpressionTracker () <HyBidVisibilityTrackerDelegate, PNLiteVisibilitySchedulerObserver>
+
+- (void)checkVisibility;
+
+@end
+
+@interface PNLiteVisibilityBenchmarkDelegate : NSObject <HyBidVisibilityTrackerDelegate, PNLiteImpressionTrackerDelegate>
+
+@property (nonatomic, assign) NSUInteger callbacks;
+
+@end
+
+@implementation PNLiteVisibilityBenchmarkDelegate
+
+- (void)checkVisibilityWithVisibleViews:(NSArray<UIView *> *)visibleViews andWithInvisibleViews:(NSArray<UIView *> *)invisibleViews {
+    self.callbacks++;
+}
+
+- (void)impressionDetectedWithView:(UIView *)view {
+    
+}
+
+@end
+
+@interface PNLiteVisibilityBenchmarkCounter : NSObject <PNLiteVisibilitySchedulerObserver>
+
+@property (nonatomic, assign) NSUInteger ticks;
+
+@end
+
+@implementation PNLiteVisibilityBenchmarkCounter
+
+- (void)visibilitySchedulerDidTick:(PNLiteVisibilityScheduler *)scheduler {
+    self.ticks++;
+}
+
+@end
+
+// Shared feed and tick helpers, the test cases below split the cheap runs from the 1,000 ad ones
+@interface PNLiteVisibilityBenchmarkTestCase : XCTestCase
+
+@property (nonatomic, strong) UIWindow *window;
+@property (nonatomic, strong) UIScrollView *feed;
+
+@end
+
+@implementation PNLiteVisibilityBenchmarkTestCase
+
+- (void)setUp
+{
+    [super setUp];
+    self.window = [[UIWindow alloc] initWithFrame:CGRectMake(0, 0, 375, 667)];
+    self.window.hidden = NO;
+}
+
+- (void)tearDown
+{
+    PNLiteBenchmarkSetAllocationCounting(NO);
+    [self.feed removeFromSuperview];
+    self.feed = nil;
+    self.window.hidden = YES;
+    self.window = nil;
+    [super tearDown];
+}
+
+#pragma mark Synthetic hierarchy
+
+// A scrolling feed of ads, each nested `depth` containers deep with an opaque badge over every other one
+- (NSArray<UIView *> *)buildFeedWithAdCount:(NSUInteger)count depth:(NSUInteger)depth
+{
+    [self.feed removeFromSuperview];
+    self.feed = [[UIScrollView alloc] initWithFrame:self.window.bounds];
+    self.feed.contentSize = CGSizeMake(CGRectGetWidth(self.window.bounds), kPNLiteBenchmarkCellHeight * count);
+    [self.window addSubview:self.feed];
+    
+    NSMutableArray<UIView *> *ads = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        UIView *container = [[UIView alloc] initWithFrame:CGRectMake(0, kPNLiteBenchmarkCellHeight * i, CGRectGetWidth(self.window.bounds), kPNLiteBenchmarkCellHeight)];
+        [self.feed addSubview:container];
+        for (NSUInteger level = 0; level < depth; level++) {
+            UIView *child = [[UIView alloc] initWithFrame:CGRectInset(container.bounds, 2, 2)];
+            child.clipsToBounds = level % 2 == 0;
+            [container addSubview:child];
+            container = child;
+        }
+        UIView *ad = [[UIView alloc] initWithFrame:container.bounds];
+        [container addSubview:ad];
+        if (i % 2 == 0) {
+            UIView *badge = [[UIView alloc] initWithFrame:CGRectMake(0, 0, 40, 20)];
+            badge.backgroundColor = [UIColor blackColor];
+            [container addSubview:badge];
+        }
+        [ads addObject:ad];
+    }
+    return ads;
+}
+
+- (void)scrollFeedForTick:(NSUInteger)tick
+{
+    CGFloat maxOffset = MAX(self.feed.contentSize.height - CGRectGetHeight(self.feed.bounds), 0);
+    self.feed.contentOffset = CGPointMake(0, fmod(tick * kPNLiteBenchmarkCellHeight * 0.5, maxOffset + 1));
+}
+
+- (HyBidVisibilityTracker *)trackerForAds:(NSArray<UIView *> *)ads withDelegate:(PNLiteVisibilityBenchmarkDelegate *)delegate
+{
+    HyBidVisibilityTracker *tracker = [[HyBidVisibilityTracker alloc] init];
+    tracker.delegate = delegate;
+    for (UIView *ad in ads) {
+        [tracker addView:ad withMinVisibility:0.5f];
+    }
+    // Ticks are driven by hand, so the display link doesn't add noise
+    [[PNLiteVisibilityScheduler sharedInstance] removeObserver:tracker];
+    return tracker;
+}
+
+- (void)waitForDelegate:(PNLiteVisibilityBenchmarkDelegate *)delegate toReceiveCallbacks:(NSUInteger)callbacks
+{
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5];
+    while (delegate.callbacks < callbacks && [deadline timeIntervalSinceNow] > 0) {
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.001]];
+    }
+    XCTAssertGreaterThanOrEqual(delegate.callbacks, callbacks);
+}
+
+- (void)runTicks:(NSUInteger)ticks onTracker:(HyBidVisibilityTracker *)tracker withDelegate:(PNLiteVisibilityBenchmarkDelegate *)delegate scrolling:(BOOL)scrolling
+{
+    for (NSUInteger tick = 0; tick < ticks; tick++) {
+        if (scrolling) {
+            [self scrollFeedForTick:tick];
+        }
+        [tracker checkVisibility];
+        [self waitForDelegate:delegate toReceiveCallbacks:delegate.callbacks + 1];
+    }
+}
+
+// Median main thread time of a tick, the part that competes with scrolling
+- (NSTimeInterval)mainThreadTickTimeWithAdCount:(NSUInteger)count depth:(NSUInteger)depth
+{
+    PNLiteVisibilityBenchmarkDelegate *delegate = [[PNLiteVisibilityBenchmarkDelegate alloc] init];
+    HyBidVisibilityTracker *tracker = [self trackerForAds:[self buildFeedWithAdCount:count depth:depth] withDelegate:delegate];
+    // Warm up once so lazily created state isn't timed
+    [self runTicks:1 onTracker:tracker withDelegate:delegate scrolling:NO];
+    
+    NSMutableArray<NSNumber *> *tickTimes = [NSMutableArray arrayWithCapacity:kPNLiteBenchmarkTicks];
+    for (NSUInteger tick = 0; tick < kPNLiteBenchmarkTicks; tick++) {
+        NSTimeInterval start = [PNLiteMonotonicClock uptime];
+        [tracker checkVisibility];
+        [tickTimes addObject:@([PNLiteMonotonicClock uptime] - start)];
+        [self waitForDelegate:delegate toReceiveCallbacks:delegate.callbacks + 1];
+    }
+    [tracker clear];
+    [tickTimes sortUsingSelector:@selector(compare:)];
+    return tickTimes[tickTimes.count / 2].doubleValue;
+}
+
+- (void)measureTicks:(dispatch_block_t)ticks
+{
+    if (@available(iOS 13.0, *)) {
+        [self measureWithMetrics:@[[[XCTCPUMetric alloc] init], [[XCTMemoryMetric alloc] init], [[XCTClockMetric alloc] init]] block:ticks];
+    } else {
+        [self measureBlock:ticks];
+    }
+}
+
+- (void)measureVisibilityTicksWithAdCount:(NSUInteger)count depth:(NSUInteger)depth scrolling:(BOOL)scrolling
+{
+    PNLiteVisibilityBenchmarkDelegate *delegate = [[PNLiteVisibilityBenchmarkDelegate alloc] init];
+    HyBidVisibilityTracker *tracker = [self trackerForAds:[self buildFeedWithAdCount:count depth:depth] withDelegate:delegate];
+    [self measureTicks:^{
+        [self runTicks:kPNLiteBenchmarkTicks onTracker:tracker withDelegate:delegate scrolling:scrolling];
+    }];
+    [tracker clear];
+}
+
+@end
+
+// Runs in the default scheme
+@interface PNLiteVisibilityBenchmarkTest : PNLiteVisibilityBenchmarkTestCase
+
+@end
+
+@implementation PNLiteVisibilityBenchmarkTest
+
+#pragma mark Visibility tracker
+
+- (void)test_visibilityTick_withSmallFeed_performance
+{
+    [self measureVisibilityTicksWithAdCount:10 depth:kPNLiteBenchmarkDefaultDepth scrolling:NO];
+}
+
+- (void)test_visibilityTick_withDeepHierarchy_performance
+{
+    [self measureVisibilityTicksWithAdCount:100 depth:20 scrolling:NO];
+}
+
+- (void)test_visibilityTick_whileScrolling_performance
+{
+    [self measureVisibilityTicksWithAdCount:100 depth:kPNLiteBenchmarkDefaultDepth scrolling:YES];
+}
+
+- (void)test_visibilityTick_whileScrolling_shouldNotAllocatePerView
+{
+    NSUInteger const count = 100;
+    PNLiteVisibilityBenchmarkDelegate *delegate = [[PNLiteVisibilityBenchmarkDelegate alloc] init];
+    HyBidVisibilityTracker *tracker = [self trackerForAds:[self buildFeedWithAdCount:count depth:kPNLiteBenchmarkDefaultDepth] withDelegate:delegate];
+    // Warm up once so lazily created state isn't counted
+    [self runTicks:1 onTracker:tracker withDelegate:delegate scrolling:YES];
+    
+    atomic_store(&PNLiteBenchmarkAllocations, 0);
+    PNLiteBenchmarkSetAllocationCounting(YES);
+    [self runTicks:kPNLiteBenchmarkTicks onTracker:tracker withDelegate:delegate scrolling:YES];
+    PNLiteBenchmarkSetAllocationCounting(NO);
+    
+    double allocationsPerTick = (double)atomic_load(&PNLiteBenchmarkAllocations) / kPNLiteBenchmarkTicks;
+    XCTAssertLessThan(allocationsPerTick, kPNLiteBenchmarkMaxAllocationsPerViewAndTick * count);
+    [tracker clear];
+}
+
+#pragma mark Scheduler
+
+- (void)test_scheduler_withTrackerPerAd_shouldNotFireMoreOften
+{
+    NSArray<UIView *> *ads = [self buildFeedWithAdCount:100 depth:kPNLiteBenchmarkDefaultDepth];
+    NSMutableArray<HyBidVisibilityTracker *> *trackers = [NSMutableArray arrayWithCapacity:ads.count];
+    for (UIView *ad in ads) {
+        HyBidVisibilityTracker *tracker = [[HyBidVisibilityTracker alloc] init];
+        [tracker addView:ad withMinVisibility:0.5f];
+        [trackers addObject:tracker];
+    }
+    PNLiteVisibilityBenchmarkCounter *counter = [[PNLiteVisibilityBenchmarkCounter alloc] init];
+    [[PNLiteVisibilityScheduler sharedInstance] addObserver:counter];
+    
+    NSTimeInterval start = [PNLiteMonotonicClock uptime];
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:1]];
+    NSTimeInterval elapsed = [PNLiteMonotonicClock uptime] - start;
+    
+    [[PNLiteVisibilityScheduler sharedInstance] removeObserver:counter];
+    for (HyBidVisibilityTracker *tracker in trackers) {
+        [tracker clear];
+    }
+    // Every tracker shares the same display link, 100 trackers fire it as often as one
+    XCTAssertLessThanOrEqual(counter.ticks / elapsed, PNLiteVisibilitySchedulerFramesPerSecond + kPNLiteBenchmarkSchedulerJitter);
+}
+
+@end
+
+// 1,000 ad feeds take too long for every unit test run, these run from the HyBidBenchmarks scheme
+@interface PNLiteVisibilityLargeFeedBenchmarkTest : PNLiteVisibilityBenchmarkTestCase
+
+@end
+
+@implementation PNLiteVisibilityLargeFeedBenchmarkTest
+
+#pragma mark Visibility tracker
+
+- (void)test_visibilityTick_withGrowingFeed_shouldScaleLinearly
+{
+    NSTimeInterval singleAd = [self mainThreadTickTimeWithAdCount:1 depth:kPNLiteBenchmarkDefaultDepth];
+    NSTimeInterval perViewInLargeFeed = [self mainThreadTickTimeWithAdCount:1000 depth:kPNLiteBenchmarkDefaultDepth] / 1000;
+    XCTAssertLessThan(perViewInLargeFeed, singleAd * kPNLiteBenchmarkMaxScalingFactor);
+}
+
+- (void)test_visibilityTick_withLargeFeed_performance
+{
+    [self measureVisibilityTicksWithAdCount:1000 depth:kPNLiteBenchmarkDefaultDepth scrolling:NO];
+}
+
+- (void)test_visibilityTick_withLargeFeedWhileScrolling_performance
+{
+    [self measureVisibilityTicksWithAdCount:1000 depth:kPNLiteBenchmarkDefaultDepth scrolling:YES];
+}
+
+#pragma mark Impression tracker
+
+- (void)test_impressionTick_withLargeFeed_performance
+{
+    NSArray<UIView *> *ads = [self buildFeedWithAdCount:1000 depth:kPNLiteBenchmarkDefaultDepth];
+    PNLiteVisibilityBenchmarkDelegate *delegate = [[PNLiteVisibilityBenchmarkDelegate alloc] init];
+    // Long enough that no impression fires and every view stays pending
+    PNLiteImpressionTracker *tracker = [[PNLiteImpressionTracker alloc] initWithRule:[PNLiteImpressionRule ruleWithMinVisibility:0.5f minExposureTime:3600 mode:PNLiteImpressionRuleModeCumulative]];
+    tracker.delegate = delegate;
+    for (UIView *ad in ads) {
+        [tracker addView:ad];
+    }
+    [tracker checkVisibilityWithVisibleViews:ads andWithInvisibleViews:@[]];
+    [self measureTicks:^{
+        for (NSUInteger tick = 0; tick < kPNLiteBenchmarkTicks; tick++) {
+            [tracker checkVisibility];
+        }
+    }];
+    [tracker clear];
+}
+
+@end
@@ -0,0 +1,248 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+#import "PNLiteVisibilityGeometry.h"
+
+@interface PNLiteVisibilityGeometryTest : XCTestCase
+
+@property (nonatomic, strong) UIWindow *window;
+@property (nonatomic, strong) UIView *adView;
+
+@end
+
+@implementation PNLiteVisibilityGeometryTest
+
+- (void)setUp
+{
+    [super setUp];
+    self.window = [[UIWindow alloc] initWithFrame:CGRectMake(0, 0, 320, 480)];
+    self.window.hidden = NO;
+    self.adView = [[UIView alloc] initWithFrame:CGRectMake(10, 10, 100, 100)];
+    [self.window addSubview:self.adView];
+}
+
+- (void)tearDown
+{
+    [self.adView removeFromSuperview];
+    self.adView = nil;
+    self.window.hidden = YES;
+    self.window = nil;
+    [super tearDown];
+}
+
+- (UIView *)addViewWithFrame:(CGRect)frame color:(UIColor *)color toView:(UIView *)superview
+{
+    UIView *view = [[UIView alloc] initWithFrame:frame];
+    view.backgroundColor = color;
+    [superview addSubview:view];
+    return view;
+}
+
+- (PNLiteVisibilitySnapshot)snapshot
+{
+    return [PNLiteVisibilityGeometry snapshotForView:self.adView withMinVisibility:0.5f];
+}
+
+- (PNLiteVisibilitySnapshot)attachedSnapshotWithClipRect:(CGRect)clipRect occluders:(NSArray<NSValue *> *)occluders
+{
+    PNLiteVisibilitySnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.isAttached = YES;
+    snapshot.hasWindow = YES;
+    snapshot.clipRect = clipRect;
+    snapshot.frameInWindow = clipRect;
+    snapshot.area = CGRectGetWidth(clipRect) * CGRectGetHeight(clipRect);
+    for (NSValue *occluder in occluders) {
+        snapshot.occluders[snapshot.occluderCount++] = occluder.CGRectValue;
+    }
+    return snapshot;
+}
+
+#pragma mark - Occluder union
+
+- (void)test_exposedArea_withOverlappingOccluders_shouldCountOverlapOnce
+{
+    PNLiteVisibilitySnapshot snapshot = [self attachedSnapshotWithClipRect:CGRectMake(0, 0, 100, 100)
+                                                                 occluders:@[[NSValue valueWithCGRect:CGRectMake(0, 0, 50, 50)],
+                                                                             [NSValue valueWithCGRect:CGRectMake(25, 25, 50, 50)]]];
+    XCTAssertEqualWithAccuracy([PNLiteVisibilityGeometry exposedAreaForSnapshot:snapshot], 10000 - 4375, 0.001);
+}
+
+- (void)test_exposedArea_withNestedAndDuplicateOccluders_shouldCountOuterRectOnce
+{
+    PNLiteVisibilitySnapshot snapshot = [self attachedSnapshotWithClipRect:CGRectMake(0, 0, 100, 100)
+                                                                 occluders:@[[NSValue valueWithCGRect:CGRectMake(0, 0, 60, 60)],
+                                                                             [NSValue valueWithCGRect:CGRectMake(10, 10, 20, 20)],
+                                                                             [NSValue valueWithCGRect:CGRectMake(0, 0, 60, 60)]]];
+    XCTAssertEqualWithAccuracy([PNLiteVisibilityGeometry exposedAreaForSnapshot:snapshot], 10000 - 3600, 0.001);
+}
+
+- (void)test_exposedArea_withDisjointOccluders_shouldAddThemUp
+{
+    PNLiteVisibilitySnapshot snapshot = [self attachedSnapshotWithClipRect:CGRectMake(0, 0, 100, 100)
+                                                                 occluders:@[[NSValue valueWithCGRect:CGRectMake(0, 0, 10, 100)],
+                                                                             [NSValue valueWithCGRect:CGRectMake(50, 0, 10, 50)],
+                                                                             [NSValue valueWithCGRect:CGRectMake(50, 60, 10, 40)]]];
+    XCTAssertEqualWithAccuracy([PNLiteVisibilityGeometry exposedAreaForSnapshot:snapshot], 10000 - 1000 - 500 - 400, 0.001);
+}
+
+#pragma mark - Hierarchy
+
+- (void)test_snapshot_withUncoveredView_shouldBeFullyExposed
+{
+    PNLiteVisibilitySnapshot snapshot = [self snapshot];
+    XCTAssertTrue(snapshot.hasWindow);
+    XCTAssertEqual(snapshot.occluderCount, 0);
+    XCTAssertEqualWithAccuracy(snapshot.area, 10000, 0.001);
+    XCTAssertEqualWithAccuracy([PNLiteVisibilityGeometry exposedAreaForSnapshot:snapshot], 10000, 0.001);
+    XCTAssertTrue([PNLiteVisibilityGeometry isVisibleSnapshot:snapshot]);
+}
+
+- (void)test_snapshot_withOverlappingOpaqueSiblings_shouldSubtractTheirUnion
+{
+    [self addViewWithFrame:CGRectMake(10, 10, 50, 50) color:[UIColor blackColor] toView:self.window];
+    [self addViewWithFrame:CGRectMake(35, 35, 50, 50) color:[UIColor blackColor] toView:self.window];
+    PNLiteVisibilitySnapshot snapshot = [self snapshot];
+    XCTAssertEqual(snapshot.occluderCount, 2);
+    XCTAssertEqualWithAccuracy([PNLiteVisibilityGeometry exposedAreaForSnapshot:snapshot], 10000 - 4375, 0.001);
+    XCTAssertTrue([PNLiteVisibilityGeometry isVisibleSnapshot:snapshot]);
+    
+    [self addViewWithFrame:CGRectMake(60, 10, 50, 100) color:[UIColor blackColor] toView:self.window];
+    XCTAssertFalse([PNLiteVisibilityGeometry isVisibleSnapshot:[self snapshot]]);
+}
+
+- (void)test_snapshot_withSiblingBelowView_shouldIgnoreIt
+{
+    UIView *below = [[UIView alloc] initWithFrame:CGRectMake(0, 0, 320, 480)];
+    below.backgroundColor = [UIColor blackColor];
+    [self.window insertSubview:below belowSubview:self.adView];
+    XCTAssertEqual([self snapshot].occluderCount, 0);
+}
+
+- (void)test_snapshot_withOccluderAboveAncestor_shouldCountIt
+{
+    UIView *container = [self addViewWithFrame:CGRectMake(0, 0, 320, 480) color:nil toView:self.window];
+    [self.adView removeFromSuperview];
+    [container addSubview:self.adView];
+    [self addViewWithFrame:CGRectMake(10, 10, 100, 30) color:[UIColor blackColor] toView:self.window];
+    XCTAssertEqualWithAccuracy([PNLiteVisibilityGeometry exposedAreaForSnapshot:[self snapshot]], 7000, 0.001);
+}
+
+- (void)test_snapshot_withClippingAncestors_shouldClipToTheirIntersection
+{
+    UIView *outer = [self addViewWithFrame:CGRectMake(0, 0, 60, 480) color:nil toView:self.window];
+    outer.clipsToBounds = YES;
+    UIView *inner = [self addViewWithFrame:CGRectMake(0, 0, 320, 40) color:nil toView:outer];
+    inner.clipsToBounds = YES;
+    [self.adView removeFromSuperview];
+    [inner addSubview:self.adView];
+    
+    PNLiteVisibilitySnapshot snapshot = [self snapshot];
+    XCTAssertTrue(CGRectEqualToRect(snapshot.clipRect, CGRectMake(10, 10, 50, 30)));
+    XCTAssertEqualWithAccuracy([PNLiteVisibilityGeometry exposedAreaForSnapshot:snapshot], 1500, 0.001);
+    XCTAssertFalse([PNLiteVisibilityGeometry isVisibleSnapshot:snapshot]);
+}
+
+- (void)test_snapshot_withNonClippingAncestor_shouldNotClip
+{
+    UIView *container = [self addViewWithFrame:CGRectMake(0, 0, 20, 20) color:nil toView:self.window];
+    [self.adView removeFromSuperview];
+    [container addSubview:self.adView];
+    XCTAssertEqualWithAccuracy([PNLiteVisibilityGeometry exposedAreaForSnapshot:[self snapshot]], 10000, 0.001);
+}
+
+- (void)test_snapshot_withScrolledClippingAncestor_shouldClipToVisibleBounds
+{
+    UIScrollView *scrollView = [[UIScrollView alloc] initWithFrame:CGRectMake(0, 0, 320, 100)];
+    scrollView.contentSize = CGSizeMake(320, 1000);
+    scrollView.showsVerticalScrollIndicator = NO;
+    [self.window addSubview:scrollView];
+    [self.adView removeFromSuperview];
+    [scrollView addSubview:self.adView];
+    scrollView.contentOffset = CGPointMake(0, 60);
+    XCTAssertEqualWithAccuracy([PNLiteVisibilityGeometry exposedAreaForSnapshot:[self snapshot]], 5000, 0.001);
+}
+
+- (void)test_snapshot_withHiddenOrTransparentSiblings_shouldIgnoreThem
+{
+    UIView *hidden = [self addViewWithFrame:self.adView.frame color:[UIColor blackColor] toView:self.window];
+    hidden.hidden = YES;
+    UIView *transparent = [self addViewWithFrame:self.adView.frame color:[UIColor blackColor] toView:self.window];
+    transparent.alpha = 0;
+    [self addViewWithFrame:self.adView.frame color:[UIColor clearColor] toView:self.window];
+    [self addViewWithFrame:self.adView.frame color:[[UIColor blackColor] colorWithAlphaComponent:0.5f] toView:self.window];
+    UIView *translucent = [self addViewWithFrame:self.adView.frame color:[UIColor blackColor] toView:self.window];
+    translucent.alpha = 0.5f;
+    
+    PNLiteVisibilitySnapshot snapshot = [self snapshot];
+    XCTAssertEqual(snapshot.occluderCount, 0);
+    XCTAssertEqualWithAccuracy([PNLiteVisibilityGeometry exposedAreaForSnapshot:snapshot], 10000, 0.001);
+}
+
+- (void)test_snapshot_withOpaqueChildOfTransparentSibling_shouldCountChild
+{
+    UIView *container = [self addViewWithFrame:CGRectMake(0, 0, 320, 480) color:[UIColor clearColor] toView:self.window];
+    [self addViewWithFrame:CGRectMake(10, 10, 100, 20) color:[UIColor blackColor] toView:container];
+    PNLiteVisibilitySnapshot snapshot = [self snapshot];
+    XCTAssertEqual(snapshot.occluderCount, 1);
+    XCTAssertEqualWithAccuracy([PNLiteVisibilityGeometry exposedAreaForSnapshot:snapshot], 8000, 0.001);
+}
+
+- (void)test_snapshot_withChildOfHiddenSibling_shouldIgnoreChild
+{
+    UIView *container = [self addViewWithFrame:CGRectMake(0, 0, 320, 480) color:nil toView:self.window];
+    container.hidden = YES;
+    [self addViewWithFrame:self.adView.frame color:[UIColor blackColor] toView:container];
+    XCTAssertEqual([self snapshot].occluderCount, 0);
+}
+
+- (void)test_snapshot_withHiddenAncestor_shouldNotBeVisible
+{
+    UIView *container = [self addViewWithFrame:CGRectMake(0, 0, 320, 480) color:nil toView:self.window];
+    [self.adView removeFromSuperview];
+    [container addSubview:self.adView];
+    container.alpha = 0;
+    
+    PNLiteVisibilitySnapshot snapshot = [self snapshot];
+    XCTAssertTrue(snapshot.isHidden);
+    XCTAssertEqual([PNLiteVisibilityGeometry exposedAreaForSnapshot:snapshot], 0);
+    XCTAssertFalse([PNLiteVisibilityGeometry isVisibleSnapshot:snapshot]);
+}
+
+- (void)test_snapshot_withDetachedView_shouldNotBeVisible
+{
+    [self.adView removeFromSuperview];
+    PNLiteVisibilitySnapshot snapshot = [self snapshot];
+    XCTAssertFalse(snapshot.isAttached);
+    XCTAssertFalse([PNLiteVisibilityGeometry isVisibleSnapshot:snapshot]);
+}
+
+- (void)test_snapshot_withManyOccluders_shouldStopAtLimit
+{
+    for (NSUInteger i = 0; i < PNLiteVisibilityMaxOccluders + 4; i++) {
+        [self addViewWithFrame:CGRectMake(10 + i * 5, 10, 5, 5) color:[UIColor blackColor] toView:self.window];
+    }
+    XCTAssertEqual([self snapshot].occluderCount, PNLiteVisibilityMaxOccluders);
+}
+
+@end
@@ -0,0 +1,147 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+// Parse time and allocations per document for the corpus and the generated documents (make bench).
+// libxml2's allocations are counted through xmlMemSetup, the parser's own through the linker's --wrap of malloc.
+
+#include "PNLiteVASTHarness.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libxml/parser.h>
+#include <libxml/xmlmemory.h>
+
+// Each document is parsed for at least this long, so fast documents get enough iterations to time reliably
+#define PNLITE_VAST_BENCH_MIN_SECONDS 0.25
+#define PNLITE_VAST_BENCH_MIN_ITERATIONS 5
+
+static int counting = 0;
+static size_t allocationCount = 0;
+static size_t allocatedBytes = 0;
+
+static void countAllocation(size_t size) {
+    if (counting) {
+        allocationCount++;
+        allocatedBytes += size;
+    }
+}
+
+void *__real_malloc(size_t size);
+void *__real_realloc(void *pointer, size_t size);
+void *__real_calloc(size_t count, size_t size);
+
+void *__wrap_malloc(size_t size);
+void *__wrap_realloc(void *pointer, size_t size);
+void *__wrap_calloc(size_t count, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    countAllocation(size);
+    return __real_malloc(size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    countAllocation(size);
+    return __real_realloc(pointer, size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    countAllocation(count * size);
+    return __real_calloc(count, size);
+}
+
+static void *xmlCountingMalloc(size_t size) {
+    countAllocation(size);
+    return __real_malloc(size);
+}
+
+static void *xmlCountingRealloc(void *pointer, size_t size) {
+    countAllocation(size);
+    return __real_realloc(pointer, size);
+}
+
+static char *xmlCountingStrdup(const char *string) {
+    size_t size = strlen(string) + 1;
+    char *copy = xmlCountingMalloc(size);
+    if (copy) {
+        memcpy(copy, string, size);
+    }
+    return copy;
+}
+
+static void benchmarkDocument(PNLiteVASTDocument *document, const char *name, const char *bytes, size_t length) {
+    size_t iterations = 0;
+    PNLiteVASTParseResult result = PNLiteVASTParseResultOK;
+    allocationCount = 0;
+    allocatedBytes = 0;
+    double start = PNLiteVASTHarnessNow();
+    double elapsed = 0;
+    do {
+        PNLiteVASTDocumentInit(document);
+        counting = 1;
+        result = PNLiteVASTDocumentParse(document, bytes, length);
+        PNLiteVASTDocumentFree(document);
+        counting = 0;
+        iterations++;
+        elapsed = PNLiteVASTHarnessNow() - start;
+    } while (elapsed < PNLITE_VAST_BENCH_MIN_SECONDS || iterations < PNLITE_VAST_BENCH_MIN_ITERATIONS);
+
+    double perDocument = elapsed / (double)iterations;
+    printf("%-36s %-13s %10zu %8zu %12.1f %10.1f %10.1f %12.1f\n", name, PNLiteVASTHarnessResultName(result), length, iterations,
+           perDocument * 1e6, (double)length / perDocument / (1024.0 * 1024.0),
+           (double)allocationCount / (double)iterations, (double)allocatedBytes / (double)iterations / 1024.0);
+}
+
+int main(int argc, char **argv) {
+    // Has to be in place before libxml2 allocates anything
+    xmlMemSetup(free, xmlCountingMalloc, xmlCountingRealloc, xmlCountingStrdup);
+    xmlInitParser();
+
+    PNLiteVASTDocument *document = malloc(sizeof(PNLiteVASTDocument));
+    if (!document) {
+        return EXIT_FAILURE;
+    }
+    printf("%-36s %-13s %10s %8s %12s %10s %10s %12s\n", "document", "result", "bytes", "runs", "us/doc", "MB/s", "allocs/doc", "KB alloc/doc");
+    for (int i = 1; i < argc; i++) {
+        size_t length = 0;
+        char *bytes = PNLiteVASTHarnessReadFile(argv[i], &length);
+        if (!bytes) {
+            fprintf(stderr, "can't read %s\n", argv[i]);
+            continue;
+        }
+        benchmarkDocument(document, PNLiteVASTHarnessBaseName(argv[i]), bytes, length);
+        free(bytes);
+    }
+    for (size_t i = 0; i < PNLiteVASTHarnessGeneratedDocumentCount; i++) {
+        const PNLiteVASTHarnessGeneratedDocument *generated = &PNLiteVASTHarnessGeneratedDocuments[i];
+        size_t length = 0;
+        char *bytes = PNLiteVASTHarnessGenerate(generated->shape, generated->size, &length);
+        if (!bytes) {
+            continue;
+        }
+        benchmarkDocument(document, generated->name, bytes, length);
+        free(bytes);
+    }
+    free(document);
+    xmlCleanupParser();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+// Parses every corpus file and the generated pathological documents, failing on any unexpected result.
+// valid-* must parse, malformed-* must be rejected, hostile-* may go either way but must stay fast and contained.
+
+#include "PNLiteVASTHarness.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Pathological input must be bounded in time, a hostile document that takes longer is a regression
+#define PNLITE_VAST_CHECK_MAX_SECONDS 1.0
+
+typedef struct {
+    const char *name;
+    PNLiteVASTParseResult result;
+    size_t urlCount;
+    size_t mediaFileCount;
+    int hasAdTagURI;
+    int truncated;
+} PNLiteVASTCheckExpectation;
+
+// Counts the corpus is known to produce, so a parser change that silently drops elements shows up here
+static const PNLiteVASTCheckExpectation expectations[] = {
+    {"generated-huge", PNLiteVASTParseResultOK, PNLITE_VAST_MAX_URLS, PNLITE_VAST_MAX_MEDIA_FILES, 0, 1},
+    {"generated-deeply-nested", PNLiteVASTParseResultXMLError, 1, 0, 0, 0}, // stops at libxml2's depth limit, past the first impression
+    {"generated-nested-within-limit", PNLiteVASTParseResultOK, 2, 0, 0, 0},
+    {"generated-cdata-heavy", PNLiteVASTParseResultOK, 32, 0, 0, 0},
+    {"generated-long-text", PNLiteVASTParseResultOK, 1, 0, 0, 1},
+    {"generated-budget-spent", PNLiteVASTParseResultOK, 66, 0, 0, 1} // the ad tag URI no longer fits, the short impression after it still does
+};
+
+static const PNLiteVASTCheckExpectation *expectationForName(const char *name) {
+    for (size_t i = 0; i < sizeof(expectations) / sizeof(expectations[0]); i++) {
+        if (strcmp(expectations[i].name, name) == 0) {
+            return &expectations[i];
+        }
+    }
+    return NULL;
+}
+
+static int hasPrefix(const char *string, const char *prefix) {
+    return strncmp(string, prefix, strlen(prefix)) == 0;
+}
+
+static int checkDocument(const char *name, const char *bytes, size_t length) {
+    PNLiteVASTDocument *document = malloc(sizeof(PNLiteVASTDocument));
+    if (!document) {
+        fprintf(stderr, "FAIL %s: out of memory\n", name);
+        return 0;
+    }
+    PNLiteVASTDocumentInit(document);
+    double start = PNLiteVASTHarnessNow();
+    PNLiteVASTParseResult result = PNLiteVASTDocumentParse(document, bytes, length);
+    double elapsed = PNLiteVASTHarnessNow() - start;
+
+    const char *problem = PNLiteVASTHarnessCheckDocument(document);
+    const PNLiteVASTCheckExpectation *expectation = expectationForName(name);
+    if (!problem && elapsed > PNLITE_VAST_CHECK_MAX_SECONDS) {
+        problem = "took too long";
+    } else if (!problem && expectation) {
+        if (result != expectation->result) {
+            problem = "unexpected result";
+        } else if (document->urlCount != expectation->urlCount) {
+            problem = "unexpected URL count";
+        } else if (document->mediaFileCount != expectation->mediaFileCount) {
+            problem = "unexpected media file count";
+        } else if ((document->adTagURI.length != 0) != expectation->hasAdTagURI) {
+            problem = "unexpected ad tag URI";
+        } else if ((document->truncated != 0) != expectation->truncated) {
+            problem = "unexpected truncation";
+        }
+    } else if (!problem && hasPrefix(name, "valid-")) {
+        if (result != PNLiteVASTParseResultOK) {
+            problem = "valid document rejected";
+        } else if (strstr(name, "wrapper") && document->adTagURI.length == 0) {
+            problem = "wrapper without an ad tag URI";
+        } else if (strstr(name, "inline") && document->mediaFileCount == 0) {
+            problem = "inline ad without media files";
+        }
+    } else if (!problem && hasPrefix(name, "malformed-")) {
+        if (result == PNLiteVASTParseResultOK) {
+            problem = "malformed document accepted";
+        }
+    } else if (!problem && hasPrefix(name, "hostile-")) {
+        if (document->textLength > PNLITE_VAST_MAX_TEXT_LENGTH / 2) {
+            problem = "entity expansion reached the document";
+        } else if (document->text && memmem(document->text, document->textLength, "root:", 5)) {
+            problem = "external entity was resolved";
+        }
+    }
+
+    printf("%s %-36s %-13s urls=%-3zu media=%-2zu text=%-6zu %8.3fms%s%s\n", problem ? "FAIL" : "ok  ", name,
+           PNLiteVASTHarnessResultName(result), document->urlCount, document->mediaFileCount, document->textLength,
+           elapsed * 1000.0, problem ? "  " : "", problem ? problem : "");
+    PNLiteVASTDocumentFree(document);
+    free(document);
+    return problem == NULL;
+}
+
+int main(int argc, char **argv) {
+    int failures = 0;
+    for (int i = 1; i < argc; i++) {
+        size_t length = 0;
+        char *bytes = PNLiteVASTHarnessReadFile(argv[i], &length);
+        if (!bytes) {
+            fprintf(stderr, "FAIL %s: can't read file\n", argv[i]);
+            failures++;
+            continue;
+        }
+        failures += !checkDocument(PNLiteVASTHarnessBaseName(argv[i]), bytes, length);
+        free(bytes);
+    }
+    for (size_t i = 0; i < PNLiteVASTHarnessGeneratedDocumentCount; i++) {
+        const PNLiteVASTHarnessGeneratedDocument *generated = &PNLiteVASTHarnessGeneratedDocuments[i];
+        size_t length = 0;
+        char *bytes = PNLiteVASTHarnessGenerate(generated->shape, generated->size, &length);
+        if (!bytes) {
+            fprintf(stderr, "FAIL %s: can't generate document\n", generated->name);
+            failures++;
+            continue;
+        }
+        failures += !checkDocument(generated->name, bytes, length);
+        free(bytes);
+    }
+    if (failures) {
+        fprintf(stderr, "%d document(s) failed\n", failures);
+    }
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,191 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+// libFuzzer entry point for the VAST XML layer (make fuzz, needs clang). Built with -DPNLITE_VAST_FUZZ_STANDALONE
+// it gets its own driver that replays the corpus and runs seeded mutations of it, so gcc with ASan/UBSan can fuzz too.
+
+#include "PNLiteVASTHarness.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void handleAdTagURI(void *context, const char *adTagURI) {
+    // The handler sees the URI mid-parse, it has to be a complete C string already
+    size_t *length = context;
+    *length += strlen(adTagURI);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static PNLiteVASTDocument document;
+    size_t adTagURILength = 0;
+    PNLiteVASTDocumentInit(&document);
+    document.adTagURIHandler = handleAdTagURI;
+    document.adTagURIHandlerContext = &adTagURILength;
+    PNLiteVASTParseResult result = PNLiteVASTDocumentParse(&document, (const char *)data, size);
+    const char *problem = PNLiteVASTHarnessCheckDocument(&document);
+    if (problem) {
+        fprintf(stderr, "%s after a %s parse\n", problem, PNLiteVASTHarnessResultName(result));
+        abort();
+    }
+    PNLiteVASTDocumentFree(&document);
+    return 0;
+}
+
+#ifdef PNLITE_VAST_FUZZ_STANDALONE
+
+#define PNLITE_VAST_FUZZ_MAX_INPUT (256 * 1024)
+
+// Fragments a VAST document is made of, the same list as vast.dict for libFuzzer
+static const char *const tokens[] = {
+    "<VAST version=\"2.0\">", "<VAST version=\"4.1\">", "</VAST>", "<Ad id=\"1\">", "</Ad>", "<InLine>", "</InLine>",
+    "<Wrapper>", "</Wrapper>", "<VASTAdTagURI>", "</VASTAdTagURI>", "<Impression>", "</Impression>", "<Error>",
+    "<Linear>", "</Linear>", "<Tracking event=\"start\">", "</Tracking>", "<ClickThrough>", "<ClickTracking>",
+    "<MediaFiles>", "<MediaFile delivery=\"progressive\" type=\"video/mp4\" bitrate=\"500\" width=\"640\" height=\"360\">",
+    "</MediaFile>", "<Extensions>", "<CompanionAds>", "<![CDATA[", "]]>", "&amp;", "&#x41;", "&lt;", "<!--", "-->",
+    "<!DOCTYPE VAST [<!ENTITY a \"aaaaaaaaaa\">]>", "&a;", "<?xml version=\"1.0\" encoding=\"UTF-8\"?>",
+    "https://example.com/", "\xef\xbb\xbf", "\0", "\xff\xfe"
+};
+
+static uint64_t randomState = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t nextRandom(void) {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+    return randomState;
+}
+
+static size_t mutate(uint8_t *data, size_t size, size_t capacity) {
+    size_t mutations = 1 + nextRandom() % 4;
+    for (size_t i = 0; i < mutations; i++) {
+        size_t position = size ? nextRandom() % (size + 1) : 0;
+        switch (nextRandom() % 5) {
+            case 0:
+                if (position < size) {
+                    data[position] ^= (uint8_t)(1u << (nextRandom() % 8));
+                }
+                break;
+            case 1:
+                if (position < size) {
+                    data[position] = (uint8_t)nextRandom();
+                }
+                break;
+            case 2: {
+                size_t length = size ? 1 + nextRandom() % 64 : 0;
+                if (position + length > size) {
+                    length = size - position;
+                }
+                memmove(data + position, data + position + length, size - position - length);
+                size -= length;
+                break;
+            }
+            case 3: {
+                const char *token = tokens[nextRandom() % (sizeof(tokens) / sizeof(tokens[0]))];
+                size_t length = token[0] ? strlen(token) : 1;
+                if (size + length <= capacity) {
+                    memmove(data + position + length, data + position, size - position);
+                    memcpy(data + position, token, length);
+                    size += length;
+                }
+                break;
+            }
+            case 4: {
+                // Duplicate a chunk of the input, which is how deep nesting and long pods come about
+                if (size == 0) {
+                    break;
+                }
+                size_t source = nextRandom() % size;
+                size_t length = 1 + nextRandom() % 256;
+                if (source + length > size) {
+                    length = size - source;
+                }
+                if (size + length <= capacity) {
+                    memmove(data + position + length, data + position, size - position);
+                    memmove(data + position, data + (source >= position ? source + length : source), length);
+                    size += length;
+                }
+                break;
+            }
+        }
+    }
+    return size;
+}
+
+int main(int argc, char **argv) {
+    unsigned long runs = 10000;
+    char **inputs = calloc((size_t)argc, sizeof(char *));
+    size_t inputCount = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "-runs=", 6) == 0) {
+            runs = strtoul(argv[i] + 6, NULL, 10);
+        } else if (strncmp(argv[i], "-seed=", 6) == 0) {
+            randomState = strtoull(argv[i] + 6, NULL, 10) | 1;
+        } else {
+            inputs[inputCount++] = argv[i];
+        }
+    }
+    if (!inputs || inputCount == 0) {
+        fprintf(stderr, "usage: %s [-runs=N] [-seed=N] corpus-file...\n", argv[0]);
+        free(inputs);
+        return EXIT_FAILURE;
+    }
+
+    uint8_t *buffer = malloc(PNLITE_VAST_FUZZ_MAX_INPUT);
+    for (size_t i = 0; i < inputCount; i++) {
+        size_t length = 0;
+        char *bytes = PNLiteVASTHarnessReadFile(inputs[i], &length);
+        if (!bytes) {
+            fprintf(stderr, "can't read %s\n", inputs[i]);
+            continue;
+        }
+        LLVMFuzzerTestOneInput((const uint8_t *)bytes, length);
+        free(bytes);
+    }
+    printf("replayed %zu corpus file(s)\n", inputCount);
+
+    double start = PNLiteVASTHarnessNow();
+    for (unsigned long run = 0; run < runs; run++) {
+        const char *input = inputs[nextRandom() % inputCount];
+        size_t length = 0;
+        char *bytes = PNLiteVASTHarnessReadFile(input, &length);
+        if (!bytes) {
+            continue;
+        }
+        if (length > PNLITE_VAST_FUZZ_MAX_INPUT) {
+            length = PNLITE_VAST_FUZZ_MAX_INPUT;
+        }
+        memcpy(buffer, bytes, length);
+        free(bytes);
+        length = mutate(buffer, length, PNLITE_VAST_FUZZ_MAX_INPUT);
+        LLVMFuzzerTestOneInput(buffer, length);
+    }
+    printf("ran %lu mutation(s) in %.2fs\n", runs, PNLiteVASTHarnessNow() - start);
+    free(buffer);
+    free(inputs);
+    return EXIT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,242 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "PNLiteVASTHarness.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+const PNLiteVASTHarnessGeneratedDocument PNLiteVASTHarnessGeneratedDocuments[] = {
+    {"generated-huge", PNLiteVASTHarnessShapeHuge, 2000},
+    {"generated-deeply-nested", PNLiteVASTHarnessShapeDeeplyNested, 5000},
+    {"generated-nested-within-limit", PNLiteVASTHarnessShapeDeeplyNested, 200},
+    {"generated-cdata-heavy", PNLiteVASTHarnessShapeCDATAHeavy, 200},
+    {"generated-long-text", PNLiteVASTHarnessShapeLongText, 128 * 1024},
+    {"generated-budget-spent", PNLiteVASTHarnessShapeBudgetSpent, 80}
+};
+const size_t PNLiteVASTHarnessGeneratedDocumentCount = sizeof(PNLiteVASTHarnessGeneratedDocuments) / sizeof(PNLiteVASTHarnessGeneratedDocuments[0]);
+
+typedef struct {
+    char *bytes;
+    size_t length;
+    size_t capacity;
+    int failed;
+} PNLiteVASTHarnessBuffer;
+
+static void PNLiteVASTHarnessAppend(PNLiteVASTHarnessBuffer *buffer, const char *format, ...) {
+    if (buffer->failed) {
+        return;
+    }
+    for (;;) {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(buffer->bytes + buffer->length, buffer->capacity - buffer->length, format, args);
+        va_end(args);
+        if (written < 0) {
+            buffer->failed = 1;
+            return;
+        }
+        if ((size_t)written < buffer->capacity - buffer->length) {
+            buffer->length += (size_t)written;
+            return;
+        }
+        size_t capacity = (buffer->capacity + (size_t)written + 1) * 2;
+        char *bytes = realloc(buffer->bytes, capacity);
+        if (!bytes) {
+            buffer->failed = 1;
+            return;
+        }
+        buffer->bytes = bytes;
+        buffer->capacity = capacity;
+    }
+}
+
+char *PNLiteVASTHarnessReadFile(const char *path, size_t *length) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    char *bytes = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        size = ftell(file);
+    }
+    if (size >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+        bytes = malloc((size_t)size + 1);
+        if (bytes && fread(bytes, 1, (size_t)size, file) != (size_t)size) {
+            free(bytes);
+            bytes = NULL;
+        }
+    }
+    fclose(file);
+    if (bytes) {
+        bytes[size] = '\0';
+        *length = (size_t)size;
+    }
+    return bytes;
+}
+
+char *PNLiteVASTHarnessGenerate(PNLiteVASTHarnessShape shape, size_t size, size_t *length) {
+    PNLiteVASTHarnessBuffer buffer = {malloc(4096), 0, 4096, 0};
+    if (!buffer.bytes) {
+        return NULL;
+    }
+    PNLiteVASTHarnessAppend(&buffer, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<VAST version=\"3.0\">");
+    switch (shape) {
+        case PNLiteVASTHarnessShapeHuge:
+            for (size_t i = 0; i < size; i++) {
+                PNLiteVASTHarnessAppend(&buffer, "<Ad id=\"%zu\" sequence=\"%zu\"><InLine><AdSystem>Huge</AdSystem>"
+                                        "<Impression><![CDATA[https://huge.example.com/imp?ad=%zu]]></Impression>"
+                                        "<Creatives><Creative><Linear><Duration>00:00:15</Duration><TrackingEvents>"
+                                        "<Tracking event=\"start\">https://huge.example.com/ev?ad=%zu&amp;e=start</Tracking>"
+                                        "<Tracking event=\"complete\">https://huge.example.com/ev?ad=%zu&amp;e=complete</Tracking>"
+                                        "</TrackingEvents><MediaFiles>"
+                                        "<MediaFile delivery=\"progressive\" type=\"video/mp4\" bitrate=\"800\" width=\"640\" height=\"360\">https://huge.example.com/%zu.mp4</MediaFile>"
+                                        "</MediaFiles></Linear></Creative>"
+                                        "<Creative><CompanionAds><Companion width=\"300\" height=\"250\"><HTMLResource><![CDATA[<div>%zu</div>]]></HTMLResource></Companion></CompanionAds></Creative>"
+                                        "</Creatives></InLine></Ad>", i, i, i, i, i, i, i);
+            }
+            break;
+        case PNLiteVASTHarnessShapeDeeplyNested:
+            PNLiteVASTHarnessAppend(&buffer, "<Ad id=\"deep\"><InLine><AdSystem>Deep</AdSystem><Impression>https://deep.example.com/imp</Impression>");
+            for (size_t i = 0; i < size; i++) {
+                PNLiteVASTHarnessAppend(&buffer, "<Nested level=\"%zu\">", i);
+            }
+            PNLiteVASTHarnessAppend(&buffer, "<Impression>https://deep.example.com/bottom</Impression>");
+            for (size_t i = 0; i < size; i++) {
+                PNLiteVASTHarnessAppend(&buffer, "</Nested>");
+            }
+            PNLiteVASTHarnessAppend(&buffer, "</InLine></Ad>");
+            break;
+        case PNLiteVASTHarnessShapeCDATAHeavy:
+            PNLiteVASTHarnessAppend(&buffer, "<Ad id=\"cdata\"><InLine><AdSystem>CDATA</AdSystem>");
+            for (size_t i = 0; i < 32; i++) {
+                PNLiteVASTHarnessAppend(&buffer, "<Impression>");
+                for (size_t j = 0; j < size; j++) {
+                    PNLiteVASTHarnessAppend(&buffer, "<![CDATA[%s%zu]]>", j == 0 ? "https://cdata.example.com/imp?p=" : "&x=", j);
+                }
+                PNLiteVASTHarnessAppend(&buffer, "</Impression>");
+            }
+            PNLiteVASTHarnessAppend(&buffer, "</InLine></Ad>");
+            break;
+        case PNLiteVASTHarnessShapeLongText:
+            PNLiteVASTHarnessAppend(&buffer, "<Ad id=\"long\"><InLine><AdSystem>Long</AdSystem><Impression>https://long.example.com/imp?q=");
+            for (size_t i = 0; i < size / 16; i++) {
+                PNLiteVASTHarnessAppend(&buffer, "abcdefghijklmnop");
+            }
+            PNLiteVASTHarnessAppend(&buffer, "</Impression><Impression>https://long.example.com/short</Impression></InLine></Ad>");
+            break;
+        case PNLiteVASTHarnessShapeBudgetSpent:
+            PNLiteVASTHarnessAppend(&buffer, "<Ad id=\"budget\"><Wrapper><AdSystem>Budget</AdSystem>");
+            for (size_t i = 0; i < size; i++) {
+                PNLiteVASTHarnessAppend(&buffer, "<Impression>https://budget.example.com/imp?n=%04zu&amp;p=%0960d</Impression>", i, 0);
+            }
+            // Longer than whatever room the impressions leave
+            PNLiteVASTHarnessAppend(&buffer, "<VASTAdTagURI>https://budget.example.com/vast?p=%02000d</VASTAdTagURI>", 0);
+            PNLiteVASTHarnessAppend(&buffer, "<Impression>https://budget.example.com/after</Impression></Wrapper></Ad>");
+            break;
+    }
+    PNLiteVASTHarnessAppend(&buffer, "</VAST>\n");
+    if (buffer.failed) {
+        free(buffer.bytes);
+        return NULL;
+    }
+    *length = buffer.length;
+    return buffer.bytes;
+}
+
+static const char *PNLiteVASTHarnessCheckString(const PNLiteVASTDocument *document, PNLiteVASTString string) {
+    if (string.length == 0) {
+        return NULL;
+    }
+    if (!document->text || (size_t)string.offset + string.length >= document->textLength + 1) {
+        return "string outside of the text buffer";
+    }
+    if (document->text[string.offset + string.length] != '\0') {
+        return "string not NUL terminated";
+    }
+    if (strlen(document->text + string.offset) != string.length) {
+        return "string length does not match its contents";
+    }
+    return NULL;
+}
+
+const char *PNLiteVASTHarnessCheckDocument(const PNLiteVASTDocument *document) {
+    if (document->urlCount > PNLITE_VAST_MAX_URLS) {
+        return "too many URLs";
+    }
+    if (document->mediaFileCount > PNLITE_VAST_MAX_MEDIA_FILES) {
+        return "too many media files";
+    }
+    if (document->textLength > PNLITE_VAST_MAX_TEXT_LENGTH || document->textLength > document->textCapacity) {
+        return "text buffer over its bounds";
+    }
+    const char *problem = NULL;
+    if ((problem = PNLiteVASTHarnessCheckString(document, document->version)) ||
+        (problem = PNLiteVASTHarnessCheckString(document, document->adTagURI))) {
+        return problem;
+    }
+    for (size_t i = 0; i < document->urlCount; i++) {
+        if (document->urls[i].url.length == 0) {
+            return "empty URL kept";
+        }
+        if ((problem = PNLiteVASTHarnessCheckString(document, document->urls[i].url)) ||
+            (problem = PNLiteVASTHarnessCheckString(document, document->urls[i].event))) {
+            return problem;
+        }
+    }
+    for (size_t i = 0; i < document->mediaFileCount; i++) {
+        const PNLiteVASTMediaFileRecord *record = &document->mediaFiles[i];
+        PNLiteVASTString strings[] = {record->identifier, record->delivery, record->type, record->bitrate, record->width,
+                                      record->height, record->scalable, record->maintainAspectRatio, record->apiFramework, record->url};
+        for (size_t j = 0; j < sizeof(strings) / sizeof(strings[0]); j++) {
+            if ((problem = PNLiteVASTHarnessCheckString(document, strings[j]))) {
+                return problem;
+            }
+        }
+    }
+    return NULL;
+}
+
+const char *PNLiteVASTHarnessResultName(PNLiteVASTParseResult result) {
+    switch (result) {
+        case PNLiteVASTParseResultOK:           return "ok";
+        case PNLiteVASTParseResultEmpty:        return "empty";
+        case PNLiteVASTParseResultXMLError:     return "xml-error";
+        case PNLiteVASTParseResultOutOfMemory:  return "out-of-memory";
+    }
+    return "unknown";
+}
+
+const char *PNLiteVASTHarnessBaseName(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+double PNLiteVASTHarnessNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
@@ -0,0 +1,61 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+// Shared by the headless VAST corpus check, fuzzer and benchmark, builds on Linux against libxml2 (see Makefile).
+
+#ifndef PNLiteVASTHarness_h
+#define PNLiteVASTHarness_h
+
+#include <stddef.h>
+#include "PNLiteVASTStreamParser.h"
+
+typedef enum {
+    PNLiteVASTHarnessShapeHuge,          // a long ad pod with thousands of tracking URLs and media files
+    PNLiteVASTHarnessShapeDeeplyNested,  // unknown elements nested far beyond anything a VAST server sends
+    PNLiteVASTHarnessShapeCDATAHeavy,    // every URL split over many CDATA sections
+    PNLiteVASTHarnessShapeLongText,      // a single URL larger than the document text limit
+    PNLiteVASTHarnessShapeBudgetSpent    // a wrapper whose impressions use up the text limit before its VASTAdTagURI
+} PNLiteVASTHarnessShape;
+
+typedef struct {
+    const char *name;
+    PNLiteVASTHarnessShape shape;
+    size_t size;
+} PNLiteVASTHarnessGeneratedDocument;
+
+extern const PNLiteVASTHarnessGeneratedDocument PNLiteVASTHarnessGeneratedDocuments[];
+extern const size_t PNLiteVASTHarnessGeneratedDocumentCount;
+
+// Whole file in a malloc'd buffer, NULL when it can't be read
+char *PNLiteVASTHarnessReadFile(const char *path, size_t *length);
+
+// Pathological document of the given shape in a malloc'd buffer, size is the repeat count of its main element
+char *PNLiteVASTHarnessGenerate(PNLiteVASTHarnessShape shape, size_t size, size_t *length);
+
+// Checks the invariants every parsed document must hold, returns NULL or a description of the first broken one
+const char *PNLiteVASTHarnessCheckDocument(const PNLiteVASTDocument *document);
+
+const char *PNLiteVASTHarnessResultName(PNLiteVASTParseResult result);
+const char *PNLiteVASTHarnessBaseName(const char *path);
+double PNLiteVASTHarnessNow(void);
+
+#endif /* PNLiteVASTHarness_h */
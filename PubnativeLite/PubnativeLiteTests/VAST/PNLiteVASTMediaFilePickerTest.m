@@ -0,0 +1,86 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+#import "PNLiteVASTMediaFilePicker.h"
+#import "PNLiteThroughputEstimator.h"
+
+@interface PNLiteVASTMediaFilePickerTest : XCTestCase
+
+@property (nonatomic, strong) NSArray<PNLiteVASTMediaFile *> *mediaFiles;
+
+@end
+
+@implementation PNLiteVASTMediaFilePickerTest
+
+- (void)setUp
+{
+    [super setUp];
+    self.mediaFiles = @[[self mediaFileWithType:@"video/webm" bitrate:@"300" width:@"640" height:@"360"],
+                        [self mediaFileWithType:@"video/mp4" bitrate:@"600" width:@"640" height:@"360"],
+                        [self mediaFileWithType:@"video/mp4" bitrate:@"1500" width:@"1280" height:@"720"],
+                        [self mediaFileWithType:@"video/mp4" bitrate:@"6000" width:@"1920" height:@"1080"]];
+}
+
+- (void)tearDown
+{
+    self.mediaFiles = nil;
+    [[PNLiteThroughputEstimator sharedInstance] reset];
+    [super tearDown];
+}
+
+- (PNLiteVASTMediaFile *)mediaFileWithType:(NSString *)type bitrate:(NSString *)bitrate width:(NSString *)width height:(NSString *)height
+{
+    NSString *url = [NSString stringWithFormat:@"https://cdn.example.com/%@x%@-%@.media", width, height, bitrate];
+    return [[PNLiteVASTMediaFile alloc] initWithId:nil delivery:@"progressive" type:type bitrate:bitrate width:width height:height scalable:nil maintainAspectRatio:nil apiFramework:nil url:url];
+}
+
+- (void)test_pick_withFastNetwork_shouldPickClosestToScreen
+{
+    PNLiteVASTMediaFile *mediaFile = [PNLiteVASTMediaFilePicker pick:self.mediaFiles forScreenSize:CGSizeMake(1920, 1080) throughput:20000];
+    XCTAssertEqual(mediaFile.bitrate, 6000);
+}
+
+- (void)test_pick_withSlowNetwork_shouldPickFileThatFitsThroughput
+{
+    PNLiteVASTMediaFile *mediaFile = [PNLiteVASTMediaFilePicker pick:self.mediaFiles forScreenSize:CGSizeMake(1920, 1080) throughput:800];
+    XCTAssertEqual(mediaFile.bitrate, 600);
+}
+
+- (void)test_pick_withUnsupportedTypeOnly_shouldReturnNil
+{
+    XCTAssertNil([PNLiteVASTMediaFilePicker pick:@[self.mediaFiles[0]] forScreenSize:CGSizeMake(640, 360) throughput:20000]);
+}
+
+- (void)test_addSample_shouldIgnoreSmallTransfersAndAverageTheRest
+{
+    PNLiteThroughputEstimator *estimator = [PNLiteThroughputEstimator sharedInstance];
+    [estimator reset];
+    [estimator addSampleWithBytes:1024 duration:0.001];
+    XCTAssertEqual(estimator.estimatedKbps, 0);
+    [estimator addSampleWithBytes:125000 duration:1];
+    XCTAssertEqualWithAccuracy(estimator.estimatedKbps, 1000, 0.001);
+    [estimator addSampleWithBytes:250000 duration:1];
+    XCTAssertEqualWithAccuracy(estimator.estimatedKbps, 1300, 0.001);
+}
+
+@end
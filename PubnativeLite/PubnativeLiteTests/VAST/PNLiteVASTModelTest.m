@@ -0,0 +1,210 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+#import "PNLiteVASTModel.h"
+#import "PNLiteVASTMediaFile.h"
+#import "PNLiteVASTXMLUtil.h"
+
+NSUInteger const kPNLiteVASTModelBenchmarkIterations = 50;
+
+static NSString *const kPNLiteVASTFirstWrapper =
+@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<VAST version=\"2.0\"><Ad id=\"wrapper-1\"><Wrapper>"
+"<AdSystem>Exchange</AdSystem>"
+"<VASTAdTagURI><![CDATA[ https://exchange.example.com/vast/second ]]></VASTAdTagURI>"
+"<Error><![CDATA[https://exchange.example.com/error?code=[ERRORCODE]]]></Error>"
+"<Impression><![CDATA[https://exchange.example.com/imp?id=1]]></Impression>"
+"<Impression><![CDATA[https://exchange.example.com/imp?id=2]]></Impression>"
+"<Creatives><Creative><Linear><TrackingEvents>"
+"<Tracking event=\"start\"><![CDATA[https://exchange.example.com/start]]></Tracking>"
+"<Tracking event=\"firstQuartile\"><![CDATA[https://exchange.example.com/q1]]></Tracking>"
+"<Tracking event=\"midpoint\"><![CDATA[https://exchange.example.com/mid]]></Tracking>"
+"<Tracking event=\"thirdQuartile\"><![CDATA[https://exchange.example.com/q3]]></Tracking>"
+"<Tracking event=\"complete\"><![CDATA[https://exchange.example.com/complete]]></Tracking>"
+"</TrackingEvents><VideoClicks><ClickTracking><![CDATA[https://exchange.example.com/click]]></ClickTracking></VideoClicks>"
+"</Linear></Creative></Creatives></Wrapper></Ad></VAST>";
+
+static NSString *const kPNLiteVASTSecondWrapper =
+@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<VAST version=\"2.0\"><Ad id=\"wrapper-2\"><Wrapper>"
+"<AdSystem>DSP</AdSystem>"
+"<VASTAdTagURI>https://dsp.example.com/vast/inline</VASTAdTagURI>"
+"<Impression><![CDATA[https://dsp.example.com/imp]]></Impression>"
+"<Creatives><Creative><Linear><TrackingEvents>"
+"<Tracking event=\"start\"><![CDATA[https://dsp.example.com/start]]></Tracking>"
+"<Tracking event=\"complete\"><![CDATA[https://dsp.example.com/complete]]></Tracking>"
+"</TrackingEvents></Linear></Creative></Creatives></Wrapper></Ad></VAST>";
+
+static NSString *const kPNLiteVASTInline =
+@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<VAST version=\"2.0\"><Ad id=\"inline\"><InLine>"
+"<AdSystem>Advertiser</AdSystem><AdTitle>Benchmark</AdTitle>"
+"<Impression><![CDATA[https://advertiser.example.com/imp]]></Impression>"
+"<Creatives><Creative><Linear><Duration>00:00:30</Duration><TrackingEvents>"
+"<Tracking event=\"creativeView\"><![CDATA[https://advertiser.example.com/view]]></Tracking>"
+"<Tracking event=\"start\"><![CDATA[https://advertiser.example.com/start]]></Tracking>"
+"<Tracking event=\"firstQuartile\"><![CDATA[https://advertiser.example.com/q1]]></Tracking>"
+"<Tracking event=\"midpoint\"><![CDATA[https://advertiser.example.com/mid]]></Tracking>"
+"<Tracking event=\"thirdQuartile\"><![CDATA[https://advertiser.example.com/q3]]></Tracking>"
+"<Tracking event=\"complete\"><![CDATA[https://advertiser.example.com/complete]]></Tracking>"
+"<Tracking event=\"mute\"><![CDATA[https://advertiser.example.com/mute]]></Tracking>"
+"<Tracking event=\"pause\"><![CDATA[https://advertiser.example.com/pause]]></Tracking>"
+"</TrackingEvents>"
+"<VideoClicks><ClickThrough><![CDATA[https://advertiser.example.com/landing]]></ClickThrough>"
+"<ClickTracking><![CDATA[https://advertiser.example.com/click]]></ClickTracking></VideoClicks>"
+"<MediaFiles>"
+"<MediaFile delivery=\"progressive\" type=\"video/mp4\" bitrate=\"400\" width=\"320\" height=\"180\"><![CDATA[https://cdn.example.com/320.mp4]]></MediaFile>"
+"<MediaFile delivery=\"progressive\" type=\"video/mp4\" bitrate=\"800\" width=\"640\" height=\"360\"><![CDATA[https://cdn.example.com/640.mp4]]></MediaFile>"
+"<MediaFile delivery=\"progressive\" type=\"video/mp4\" bitrate=\"1500\" width=\"1280\" height=\"720\"><![CDATA[https://cdn.example.com/1280.mp4]]></MediaFile>"
+"<MediaFile delivery=\"progressive\" type=\"video/webm\" bitrate=\"800\" width=\"640\" height=\"360\"><![CDATA[https://cdn.example.com/640.webm]]></MediaFile>"
+"</MediaFiles></Linear></Creative></Creatives></InLine></Ad></VAST>";
+
+@interface PNLiteVASTModel ()
+
+- (BOOL)addVASTDocument:(NSData *)vastDocument;
+- (NSString *)adTagURI;
+
+@end
+
+@interface PNLiteVASTModelTest : XCTestCase
+
+@property (nonatomic, strong) NSArray<NSData *> *wrapperChain;
+
+@end
+
+@implementation PNLiteVASTModelTest
+
+- (void)setUp
+{
+    [super setUp];
+    self.wrapperChain = @[[kPNLiteVASTFirstWrapper dataUsingEncoding:NSUTF8StringEncoding],
+                          [kPNLiteVASTSecondWrapper dataUsingEncoding:NSUTF8StringEncoding],
+                          [kPNLiteVASTInline dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+- (void)tearDown
+{
+    self.wrapperChain = nil;
+    [super tearDown];
+}
+
+- (PNLiteVASTModel *)modelForWrapperChain
+{
+    PNLiteVASTModel *model = [[PNLiteVASTModel alloc] init];
+    for (NSData *document in self.wrapperChain) {
+        [model addVASTDocument:document];
+    }
+    return model;
+}
+
+// What one ad load used to cost: a syntax check and a wrapper lookup per hop, then every accessor queried every document again
+- (void)loadWrapperChainQueryingEveryAccessor
+{
+    for (NSData *document in self.wrapperChain) {
+        validateXMLDocSyntax(document);
+        performXMLXPathQuery(document, @"//VASTAdTagURI");
+    }
+    performXMLXPathQuery(self.wrapperChain[0], @"/VAST/@version");
+    for (NSString *query in @[@"//Error", @"//Impression", @"//ClickThrough", @"//ClickTracking", @"//Linear//Tracking", @"//MediaFile"]) {
+        for (NSData *document in self.wrapperChain) {
+            performXMLXPathQuery(document, query);
+        }
+    }
+}
+
+- (void)loadWrapperChainParsingOnce
+{
+    PNLiteVASTModel *model = [self modelForWrapperChain];
+    [model vastVersion];
+    [model errors];
+    [model impressions];
+    [model clickThrough];
+    [model clickTracking];
+    [model trackingEvents];
+    [model mediaFiles];
+}
+
+- (void)test_addVASTDocument_withWrapperChain_shouldMergeEveryDocument
+{
+    PNLiteVASTModel *model = [self modelForWrapperChain];
+    XCTAssertEqualObjects([model vastVersion], @"2.0");
+    XCTAssertNil([model adTagURI]);
+    XCTAssertEqual([[model impressions] count], (NSUInteger)4);
+    XCTAssertEqual([[model errors] count], (NSUInteger)1);
+    XCTAssertEqual([[model clickTracking] count], (NSUInteger)2);
+    XCTAssertEqualObjects([model clickThrough], @"https://advertiser.example.com/landing");
+    XCTAssertEqual([[model trackingEvents][@"start"] count], (NSUInteger)3);
+    XCTAssertEqual([[model trackingEvents][@"complete"] count], (NSUInteger)3);
+    XCTAssertEqual([[model trackingEvents][@"mute"] count], (NSUInteger)1);
+    XCTAssertEqual([[model mediaFiles] count], (NSUInteger)4);
+    XCTAssertEqualObjects(((PNLiteVASTMediaFile *)[model mediaFiles][1]).url.absoluteString, @"https://cdn.example.com/640.mp4");
+}
+
+- (void)test_addVASTDocument_withWrapper_shouldExposeAdTagURI
+{
+    PNLiteVASTModel *model = [[PNLiteVASTModel alloc] init];
+    XCTAssertTrue([model addVASTDocument:self.wrapperChain[0]]);
+    XCTAssertEqualObjects([[model adTagURI] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]], @"https://exchange.example.com/vast/second");
+}
+
+- (void)test_addVASTDocument_withInvalidXML_shouldFail
+{
+    PNLiteVASTModel *model = [[PNLiteVASTModel alloc] init];
+    XCTAssertFalse([model addVASTDocument:[@"<VAST><Ad>" dataUsingEncoding:NSUTF8StringEncoding]]);
+    XCTAssertFalse([model addVASTDocument:nil]);
+}
+
+- (void)test_addVASTDocument_withCompanionsAndExtensions_shouldSkipThem
+{
+    NSString *vast = @"<VAST version=\"2.0\"><Ad><InLine>"
+    "<Impression>https://advertiser.example.com/imp</Impression>"
+    "<Creatives><Creative><Linear><TrackingEvents><Tracking event=\"start\">https://advertiser.example.com/start</Tracking></TrackingEvents></Linear></Creative>"
+    "<Creative><CompanionAds><Companion><TrackingEvents><Tracking event=\"creativeView\">https://advertiser.example.com/companion</Tracking></TrackingEvents></Companion></CompanionAds></Creative></Creatives>"
+    "<Extensions><Extension><Impression>https://vendor.example.com/imp</Impression></Extension></Extensions>"
+    "</InLine></Ad></VAST>";
+    PNLiteVASTModel *model = [[PNLiteVASTModel alloc] init];
+    XCTAssertTrue([model addVASTDocument:[vast dataUsingEncoding:NSUTF8StringEncoding]]);
+    XCTAssertEqualObjects([model impressions], @[@"https://advertiser.example.com/imp"]);
+    XCTAssertEqualObjects([[model trackingEvents] allKeys], @[@"start"]);
+}
+
+// Baseline of the old path, compare it with test_loadWrapperChain_parsingOnce_performance
+- (void)test_loadWrapperChain_queryingEveryAccessor_performance
+{
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kPNLiteVASTModelBenchmarkIterations; i++) {
+            [self loadWrapperChainQueryingEveryAccessor];
+        }
+    }];
+}
+
+- (void)test_loadWrapperChain_parsingOnce_performance
+{
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kPNLiteVASTModelBenchmarkIterations; i++) {
+            [self loadWrapperChainParsingOnce];
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,192 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+#import "PNLiteVASTWrapperCache.h"
+#import "PNLiteVASTModel.h"
+#import "PNLiteVASTMacros.h"
+
+static NSString *const kPNLiteVASTWrapperCacheWrapper =
+@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<VAST version=\"2.0\"><Ad id=\"wrapper\"><Wrapper>"
+"<AdSystem>Exchange</AdSystem>"
+"<VASTAdTagURI>https://dsp.example.com/vast/inline</VASTAdTagURI>"
+"</Wrapper></Ad></VAST>";
+
+static NSString *const kPNLiteVASTWrapperCacheTrackedWrapper =
+@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<VAST version=\"2.0\"><Ad id=\"wrapper\"><Wrapper>"
+"<AdSystem>Exchange</AdSystem>"
+"<VASTAdTagURI>https://dsp.example.com/vast/inline</VASTAdTagURI>"
+"<Impression><![CDATA[https://exchange.example.com/imp?cb=[CACHEBUSTING]]]></Impression>"
+"</Wrapper></Ad></VAST>";
+
+@interface PNLiteVASTModel (private)
+
+- (NSString *)adTagURI;
+- (void)addParsedDocument:(PNLiteVASTParsedDocument *)parsedDocument;
+
+@end
+
+@interface PNLiteVASTWrapperCacheTest : XCTestCase
+
+@property (nonatomic, strong) PNLiteVASTWrapperCache *cache;
+
+@end
+
+@implementation PNLiteVASTWrapperCacheTest
+
+- (void)setUp
+{
+    [super setUp];
+    self.cache = [[PNLiteVASTWrapperCache alloc] init];
+}
+
+- (void)tearDown
+{
+    self.cache = nil;
+    [super tearDown];
+}
+
+- (PNLiteVASTParsedDocument *)wrapperDocument
+{
+    NSData *data = [kPNLiteVASTWrapperCacheWrapper dataUsingEncoding:NSUTF8StringEncoding];
+    return [[PNLiteVASTParsedDocument alloc] initWithData:data adTagURIHandler:nil];
+}
+
+- (PNLiteVASTParsedDocument *)trackedWrapperDocument
+{
+    NSData *data = [kPNLiteVASTWrapperCacheTrackedWrapper dataUsingEncoding:NSUTF8StringEncoding];
+    return [[PNLiteVASTParsedDocument alloc] initWithData:data adTagURIHandler:nil];
+}
+
+- (NSHTTPURLResponse *)responseWithHeaders:(NSDictionary<NSString *, NSString *> *)headers
+{
+    return [[NSHTTPURLResponse alloc] initWithURL:[NSURL URLWithString:@"https://exchange.example.com/vast"] statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:headers];
+}
+
+- (void)test_keyForAdTagURI_withEquivalentURLs_shouldMatch
+{
+    NSString *key = [PNLiteVASTWrapperCache keyForAdTagURI:@"https://exchange.example.com/vast?b=2&a=1"];
+    XCTAssertEqualObjects([PNLiteVASTWrapperCache keyForAdTagURI:@"HTTPS://Exchange.Example.com:443/vast?a=1&b=2#top"], key);
+    XCTAssertNotEqualObjects([PNLiteVASTWrapperCache keyForAdTagURI:@"https://exchange.example.com/vast?a=1&b=3"], key);
+    XCTAssertNil([PNLiteVASTWrapperCache keyForAdTagURI:@"ftp://exchange.example.com/vast"]);
+}
+
+- (void)test_lifetimeForResponse_shouldHonourCacheHeaders
+{
+    XCTAssertEqual([PNLiteVASTWrapperCache lifetimeForResponse:[self responseWithHeaders:@{}]], 0);
+    XCTAssertEqual([PNLiteVASTWrapperCache lifetimeForResponse:[self responseWithHeaders:@{@"Cache-Control": @"public, max-age=60"}]], 60);
+    XCTAssertEqual([PNLiteVASTWrapperCache lifetimeForResponse:[self responseWithHeaders:@{@"Cache-Control": @"max-age=60, s-maxage=30"}]], 30);
+    XCTAssertEqual([PNLiteVASTWrapperCache lifetimeForResponse:[self responseWithHeaders:@{@"Cache-Control": @"public, max-age=60", @"Age": @"20"}]], 40);
+    XCTAssertEqual([PNLiteVASTWrapperCache lifetimeForResponse:[self responseWithHeaders:@{@"Cache-Control": @"public, max-age=86400"}]], PNLiteVASTWrapperCacheMaxLifetime);
+    XCTAssertEqual([PNLiteVASTWrapperCache lifetimeForResponse:[self responseWithHeaders:@{@"Cache-Control": @"private, max-age=60"}]], 0);
+    XCTAssertEqual([PNLiteVASTWrapperCache lifetimeForResponse:[self responseWithHeaders:@{@"Cache-Control": @"public, no-store"}]], 0);
+    XCTAssertEqual([PNLiteVASTWrapperCache lifetimeForResponse:[self responseWithHeaders:@{@"Cache-Control": @"public, max-age=60", @"Set-Cookie": @"uid=1"}]], 0);
+    XCTAssertEqual([PNLiteVASTWrapperCache lifetimeForResponse:[self responseWithHeaders:@{@"Cache-Control": @"public", @"Date": @"Sun, 18 Oct 2026 10:00:00 GMT", @"Expires": @"Sun, 18 Oct 2026 10:02:00 GMT"}]], 120);
+}
+
+- (void)test_lifetimeForResponse_withoutSharedCacheDirective_shouldNotCache
+{
+    XCTAssertEqual([PNLiteVASTWrapperCache lifetimeForResponse:[self responseWithHeaders:@{@"Cache-Control": @"max-age=60"}]], 0);
+    XCTAssertEqual([PNLiteVASTWrapperCache lifetimeForResponse:[self responseWithHeaders:@{@"Date": @"Sun, 18 Oct 2026 10:00:00 GMT", @"Expires": @"Sun, 18 Oct 2026 10:02:00 GMT"}]], 0);
+}
+
+- (void)test_documentForAdTagURI_shouldReturnCachedDocument
+{
+    PNLiteVASTParsedDocument *document = [self wrapperDocument];
+    [self.cache setDocument:document forAdTagURI:@"https://exchange.example.com/vast?b=2&a=1" lifetime:60];
+    XCTAssertEqual([self.cache documentForAdTagURI:@"https://exchange.example.com/vast?a=1&b=2"], document);
+    XCTAssertNil([self.cache documentForAdTagURI:@"https://exchange.example.com/other"]);
+    
+    [self.cache removeAllDocuments];
+    XCTAssertNil([self.cache documentForAdTagURI:@"https://exchange.example.com/vast?a=1&b=2"]);
+}
+
+- (void)test_setDocument_withoutLifetime_shouldNotCache
+{
+    [self.cache setDocument:[self wrapperDocument] forAdTagURI:@"https://exchange.example.com/vast" lifetime:0];
+    XCTAssertNil([self.cache documentForAdTagURI:@"https://exchange.example.com/vast"]);
+}
+
+- (void)test_setDocument_overCapacity_shouldEvictLeastRecentlyUsed
+{
+    PNLiteVASTParsedDocument *document = [self wrapperDocument];
+    for (NSUInteger i = 0; i <= PNLiteVASTWrapperCacheCapacity; i++) {
+        [self.cache setDocument:document forAdTagURI:[NSString stringWithFormat:@"https://exchange.example.com/vast/%lu", (unsigned long)i] lifetime:60];
+        if (i == 0) {
+            continue;
+        }
+        // keep the first entry in use
+        XCTAssertNotNil([self.cache documentForAdTagURI:@"https://exchange.example.com/vast/0"]);
+    }
+    XCTAssertNotNil([self.cache documentForAdTagURI:@"https://exchange.example.com/vast/0"]);
+    XCTAssertNil([self.cache documentForAdTagURI:@"https://exchange.example.com/vast/1"]);
+}
+
+- (void)test_setDocument_withTrackingURLs_shouldCache
+{
+    PNLiteVASTParsedDocument *document = [self trackedWrapperDocument];
+    [self.cache setDocument:document forAdTagURI:@"https://exchange.example.com/vast" lifetime:60];
+    XCTAssertEqual([self.cache documentForAdTagURI:@"https://exchange.example.com/vast"], document);
+}
+
+- (void)test_secondAd_withCachedDocument_shouldFireItsOwnCacheBuster
+{
+    PNLiteVASTModel *firstModel = [[PNLiteVASTModel alloc] init];
+    PNLiteVASTParsedDocument *document = [self trackedWrapperDocument];
+    [firstModel addParsedDocument:document];
+    [self.cache setDocument:document forAdTagURI:@"https://exchange.example.com/vast" lifetime:60];
+    PNLiteVASTModel *secondModel = [[PNLiteVASTModel alloc] init];
+    [secondModel addParsedDocument:[self.cache documentForAdTagURI:@"https://exchange.example.com/vast"]];
+    
+    NSDate *date = [NSDate date];
+    NSString *firstImpression = [PNLiteVASTMacros expandMacrosInURLString:[[firstModel impressions] firstObject] withDate:date cacheBuster:@"11111111"];
+    NSString *secondImpression = [PNLiteVASTMacros expandMacrosInURLString:[[secondModel impressions] firstObject] withDate:date cacheBuster:@"22222222"];
+    XCTAssertEqualObjects(firstImpression, @"https://exchange.example.com/imp?cb=11111111");
+    XCTAssertEqualObjects(secondImpression, @"https://exchange.example.com/imp?cb=22222222");
+    XCTAssertEqual([secondModel impressions].count, 1);
+}
+
+- (void)test_expandMacros_shouldReplaceRawAndEncodedMacros
+{
+    NSDate *date = [NSDate dateWithTimeIntervalSince1970:1453018530.5];
+    NSString *expanded = [PNLiteVASTMacros expandMacrosInURLString:@"https://t.example.com/e?cb=%5BCACHEBUSTING%5D&ts=[TIMESTAMP]&err=[ERRORCODE]" withDate:date cacheBuster:@"00001234"];
+    XCTAssertEqualObjects(expanded, @"https://t.example.com/e?cb=00001234&ts=2016-01-17T08%3A15%3A30.500Z&err=[ERRORCODE]");
+    XCTAssertEqualObjects([PNLiteVASTMacros expandMacrosInURLString:@"https://t.example.com/e" withDate:date cacheBuster:@"1"], @"https://t.example.com/e");
+    XCTAssertNotEqualObjects([PNLiteVASTMacros expandMacrosInURLString:@"cb=[CACHEBUSTING]"], @"cb=[CACHEBUSTING]");
+}
+
+- (void)test_addParsedDocument_withCachedDocument_shouldResolveTheSameAdTagURI
+{
+    PNLiteVASTParsedDocument *document = [self wrapperDocument];
+    PNLiteVASTModel *firstModel = [[PNLiteVASTModel alloc] init];
+    PNLiteVASTModel *secondModel = [[PNLiteVASTModel alloc] init];
+    [firstModel addParsedDocument:document];
+    [secondModel addParsedDocument:document];
+    
+    XCTAssertEqualObjects([firstModel adTagURI], @"https://dsp.example.com/vast/inline");
+    XCTAssertEqualObjects([secondModel adTagURI], @"https://dsp.example.com/vast/inline");
+    XCTAssertEqual([secondModel impressions].count, 0);
+}
+
+@end
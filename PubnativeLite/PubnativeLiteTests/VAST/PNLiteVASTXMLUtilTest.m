@@ -0,0 +1,105 @@
+//
+//  Copyright © 2019 PubNative. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <XCTest/XCTest.h>
+#import "PNLiteVASTXMLUtil.h"
+
+NSUInteger const kPNLiteVASTXMLUtilConcurrentParses = 64;
+
+static NSString *const kPNLiteVASTXMLUtilDocument =
+@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<VAST version=\"2.0\"><Ad id=\"inline\"><InLine>"
+"<AdSystem>DSP</AdSystem>"
+"<Impression><![CDATA[https://dsp.example.com/imp?id=1]]></Impression>"
+"<Impression><![CDATA[https://dsp.example.com/imp?id=2]]></Impression>"
+"</InLine></Ad></VAST>";
+
+static NSString *const kPNLiteVASTXMLUtilWrapper =
+@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<VAST version=\"2.0\"><Ad id=\"wrapper\"><Wrapper>"
+"<AdSystem>Exchange</AdSystem>"
+"<VASTAdTagURI>https://dsp.example.com/vast/inline</VASTAdTagURI>"
+"<Impression>https://exchange.example.com/imp</Impression>"
+"<Creatives/>"
+"</Wrapper></Ad></VAST>";
+
+@interface PNLiteVASTXMLUtilTest : XCTestCase
+
+@end
+
+@implementation PNLiteVASTXMLUtilTest
+
+- (void)test_performXMLXPathQuery_shouldReturnMatchingNodes
+{
+    NSData *document = [kPNLiteVASTXMLUtilDocument dataUsingEncoding:NSUTF8StringEncoding];
+    NSArray *result = performXMLXPathQuery(document, @"//Impression");
+    XCTAssertEqual([result count], (NSUInteger)2);
+    XCTAssertEqualObjects(result[0][@"nodeContent"], @"https://dsp.example.com/imp?id=1");
+    // the second run goes through the compiled query cache
+    XCTAssertEqual([performXMLXPathQuery(document, @"//Impression") count], (NSUInteger)2);
+}
+
+- (void)test_performXMLXPathQuery_withInvalidQuery_shouldReturnNil
+{
+    NSData *document = [kPNLiteVASTXMLUtilDocument dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertNil(performXMLXPathQuery(document, @"//Impression["));
+}
+
+- (void)test_validateXMLDocAgainstVASTSchema_withValidWrapper_shouldPass
+{
+    NSData *document = [kPNLiteVASTXMLUtilWrapper dataUsingEncoding:NSUTF8StringEncoding];
+    __block NSUInteger failures = 0;
+    // every validation shares the compiled schema and reuses pooled contexts
+    dispatch_apply(kPNLiteVASTXMLUtilConcurrentParses, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        if (!validateXMLDocAgainstVASTSchema(document)) {
+            @synchronized (self) {
+                failures++;
+            }
+        }
+    });
+    XCTAssertEqual(failures, (NSUInteger)0);
+}
+
+- (void)test_validateXMLDocAgainstVASTSchema_withUnknownElement_shouldFail
+{
+    NSString *invalidWrapper = [kPNLiteVASTXMLUtilWrapper stringByReplacingOccurrencesOfString:@"<Creatives/>" withString:@"<Unknown/>"];
+    XCTAssertFalse(validateXMLDocAgainstVASTSchema([invalidWrapper dataUsingEncoding:NSUTF8StringEncoding]));
+}
+
+- (void)test_validateXMLDocSyntax_fromManyThreads_shouldBeConsistent
+{
+    NSData *document = [kPNLiteVASTXMLUtilDocument dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *invalidDocument = [@"<VAST><Ad></VAST>" dataUsingEncoding:NSUTF8StringEncoding];
+    __block NSUInteger failures = 0;
+    dispatch_apply(kPNLiteVASTXMLUtilConcurrentParses, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        BOOL isValid = validateXMLDocSyntax(i % 2 ? invalidDocument : document) == (i % 2 == 0);
+        BOOL hasNodes = [performXMLXPathQuery(document, @"//Impression") count] == 2;
+        if (!isValid || !hasNodes) {
+            @synchronized (self) {
+                failures++;
+            }
+        }
+    });
+    XCTAssertEqual(failures, (NSUInteger)0);
+}
+
+@end